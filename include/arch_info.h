@@ -9,6 +9,7 @@
 #ifndef ARCH_INFO_H
 #define ARCH_INFO_H
 
+#include <stdbool.h>
 #include "mach-o/loader.h"
 
 struct arch_info {
@@ -26,4 +27,11 @@ arch_info_for_cputype(cpu_type_t cputype, cpu_subtype_t cpusubtype);
 
 const struct arch_info *arch_info_for_name(const char *name);
 
+/*
+ * Returns whether arch is one of archs, a bit-mask of arch-info list indexes,
+ * either by its index, or by the index of the first arch with its name.
+ */
+
+bool arch_info_is_in_archs(const struct arch_info *arch, uint64_t archs);
+
 #endif /* ARCH_INFO_H */
@@ -112,6 +112,16 @@ array_add_item_with_cached_index_info(struct array *array,
                                       struct array_cached_index_info *info,
                                       void **item_out);
 
+/*
+ * Ensure the array has enough capacity to add item_count more items without
+ * having to reallocate.
+ */
+
+enum array_result
+array_ensure_item_capacity(struct array *array,
+                           size_t item_size,
+                           uint64_t item_count);
+
 enum array_result
 array_sort_items_with_comparator(struct array *array,
                                  size_t item_size,
@@ -119,6 +129,13 @@ array_sort_items_with_comparator(struct array *array,
 
 enum array_result array_copy(struct array *array, struct array *array_out);
 
+/*
+ * Remove every item from the array, keeping its buffer to be reused, unless the
+ * buffer is larger than max_capacity bytes, in which case it's deallocated.
+ */
+
+enum array_result array_clear(struct array *array, uint64_t max_capacity);
+
 /*
  * Deallocate the array's buffer and reset the array's fields.
  */
@@ -22,6 +22,7 @@ enum dsc_image_parse_result {
     E_DSC_IMAGE_PARSE_READ_FAIL,
 
     E_DSC_IMAGE_PARSE_NO_CORRESPONDING_MAPPING,
+    E_DSC_IMAGE_PARSE_MMAP_FAIL,
     E_DSC_IMAGE_PARSE_SIZE_TOO_SMALL,
 
     E_DSC_IMAGE_PARSE_INVALID_RANGE,
@@ -39,6 +40,7 @@ enum dsc_image_parse_result {
     E_DSC_IMAGE_PARSE_INVALID_SECTION,
 
     E_DSC_IMAGE_PARSE_INVALID_CLIENT,
+    E_DSC_IMAGE_PARSE_INVALID_EXPORT_TRIE,
     E_DSC_IMAGE_PARSE_INVALID_INSTALL_NAME,
     E_DSC_IMAGE_PARSE_INVALID_PARENT_UMBRELLA,
     E_DSC_IMAGE_PARSE_INVALID_PLATFORM,
@@ -52,15 +54,43 @@ enum dsc_image_parse_result {
     E_DSC_IMAGE_PARSE_NO_SYMBOL_TABLE,
     E_DSC_IMAGE_PARSE_NO_UUID,
 
-    E_DSC_IMAGE_PARSE_NO_EXPORTS
+    E_DSC_IMAGE_PARSE_NO_EXPORTS,
+
+    /*
+     * Only returned when merging images from several dyld_shared_caches.
+     */
+
+    E_DSC_IMAGE_PARSE_CONFLICTING_INFO
+};
+
+enum dsc_image_parse_options {
+    /*
+     * Parse image into info_in alongside the images (of the same install-name,
+     * from dyld_shared_caches of other architectures) already parsed into it.
+     *
+     * info_in's archs are left untouched, and its exports are left unsorted,
+     * until dsc_image_finish_merge() is called.
+     */
+
+    O_DSC_IMAGE_PARSE_MERGE = 1 << 0
 };
 
 enum dsc_image_parse_result
 dsc_image_parse(struct tbd_create_info *info_in,
                 struct dyld_shared_cache_info *dsc_info,
-                struct dyld_cache_image_info *image,
+                const struct dyld_cache_image_info *image,
                 uint64_t macho_options,
                 uint64_t tbd_options,
                 uint64_t options);
 
+/*
+ * Finish parsing the images merged into info_in with O_DSC_IMAGE_PARSE_MERGE,
+ * with archs being the architectures of every image merged.
+ */
+
+enum dsc_image_parse_result
+dsc_image_finish_merge(struct tbd_create_info *info_in,
+                       uint64_t archs,
+                       uint64_t tbd_options);
+
 #endif /* DSC_IMAGE_H */
@@ -0,0 +1,78 @@
+//
+//  include/dsc_image_cond_index.h
+//  tbd
+//
+//  Created by inoahdev on 03/12/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#ifndef DSC_IMAGE_COND_INDEX_H
+#define DSC_IMAGE_COND_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "array.h"
+#include "tbd_for_main.h"
+
+/*
+ * A hash-table of a tbd's image-paths, and of its image-filters by the
+ * path-component they match, so that the conditions an image-path may match
+ * can be found in a single pass over the image-path, instead of comparing the
+ * image-path against every condition.
+ *
+ * Only candidates are found this way, which still have to be checked against
+ * the image-path, as before. Filters that can't be indexed (such as empty
+ * filters, or filters with a slash) are always candidates.
+ */
+
+struct dsc_image_cond_index_entry;
+
+struct dsc_image_cond_index {
+    struct tbd_for_main_dsc_image_filter *filters;
+    struct tbd_for_main_dsc_image_path *paths;
+
+    uint32_t filters_count;
+    uint32_t paths_count;
+
+    struct dsc_image_cond_index_entry *entries;
+
+    uint32_t *slots;
+    uint64_t capacity;
+
+    /*
+     * Indices of filters that are candidates for every image-path.
+     */
+
+    struct array unindexed_filters;
+
+    /*
+     * The indices of the filters and paths that are candidates for the
+     * image-path last passed to dsc_image_cond_index_find_candidates(), in
+     * ascending order.
+     */
+
+    struct array filter_candidates;
+    struct array path_candidates;
+};
+
+bool
+dsc_image_cond_index_create(struct dsc_image_cond_index *index_out,
+                            const struct array *filters,
+                            const struct array *paths);
+
+/*
+ * Find the filters and paths that path may match, storing their indices in
+ * filter_candidates and path_candidates respectively.
+ *
+ * Returns false if the candidate arrays could not be grown.
+ */
+
+bool
+dsc_image_cond_index_find_candidates(struct dsc_image_cond_index *index,
+                                     const char *path,
+                                     uint64_t path_length);
+
+void dsc_image_cond_index_destroy(struct dsc_image_cond_index *index);
+
+#endif /* DSC_IMAGE_COND_INDEX_H */
@@ -16,8 +16,27 @@
 #include "range.h"
 
 enum dyld_shared_cache_parse_options {
-    O_DYLD_SHARED_CACHE_PARSE_ZERO_IMAGE_PADS           = 1 << 0,
-    O_DYLD_SHARED_CACHE_PARSE_VERIFY_IMAGE_PATH_OFFSETS = 1 << 1
+    O_DYLD_SHARED_CACHE_PARSE_VERIFY_IMAGE_PATH_OFFSETS = 1 << 0,
+
+    /*
+     * Options for how the dyld_shared_cache file is mapped, and how its pages
+     * are to be read in. These don't change what is parsed, and are only
+     * hints, ignored where unsupported.
+     */
+
+    O_DYLD_SHARED_CACHE_PARSE_ACCESS_RANDOM     = 1 << 1,
+    O_DYLD_SHARED_CACHE_PARSE_ACCESS_SEQUENTIAL = 1 << 2,
+
+    O_DYLD_SHARED_CACHE_PARSE_POPULATE   = 1 << 3,
+    O_DYLD_SHARED_CACHE_PARSE_HUGE_PAGES = 1 << 4,
+
+    /*
+     * Read in the read-only mappings (which store every image's __LINKEDIT)
+     * ahead of time, and allow images' load-commands to be read in with
+     * dyld_shared_cache_prefetch_image().
+     */
+
+    O_DYLD_SHARED_CACHE_PARSE_PREFETCH = 1 << 5
 };
 
 enum dyld_shared_cache_flags {
@@ -40,11 +59,60 @@ enum dyld_shared_cache_parse_result {
 
     E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_RANGES,
     E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_IMAGES,
-    E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_MAPPINGS
+    E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_MAPPINGS,
+
+    E_DYLD_SHARED_CACHE_PARSE_OPEN_SUBCACHE_FAIL,
+    E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES
+};
+
+/*
+ * The address-range of a mapping, along with its file-offset, for finding the
+ * mapping containing an address with a binary search.
+ */
+
+struct dyld_shared_cache_mapping_range {
+    uint64_t begin;
+    uint64_t end;
+
+    uint64_t file_offset;
+
+    /*
+     * The index of the file (in the files of the dyld_shared_cache) storing
+     * the mapping.
+     */
+
+    uint32_t file_index;
+};
+
+/*
+ * A file storing the mappings of a dyld_shared_cache.
+ *
+ * Split dyld_shared_caches store their mappings in a main file, and in several
+ * subcaches, which are only mapped once an address within them is needed, as
+ * most images (and their __LINKEDIT) are stored in only a few of them.
+ *
+ * The first file is always the main file, which is mapped when parsed.
+ */
+
+struct dyld_shared_cache_file {
+    const uint8_t *map;
+    uint64_t size;
+
+    const struct dyld_cache_mapping_info *mappings;
+    uint32_t mappings_count;
+
+    struct range available_range;
+    int fd;
 };
 
+/*
+ * The dyld_shared_cache file is mapped read-only, so that its pages are shared
+ * with every other process mapping the same file. Any state kept per image has
+ * to be stored separately, indexed by the image's index in images.
+ */
+
 struct dyld_shared_cache_info {
-    struct dyld_cache_image_info *images;
+    const struct dyld_cache_image_info *images;
     uint32_t images_count;
 
     /*
@@ -54,7 +122,20 @@ struct dyld_shared_cache_info {
     const struct dyld_cache_mapping_info *mappings;
     uint32_t mappings_count;
 
-    uint8_t *map;
+    /*
+     * The address-ranges of the mappings, sorted by address, and the index of
+     * the range last found by an address, as most addresses looked up in a row
+     * are in the same mapping.
+     */
+
+    struct dyld_shared_cache_mapping_range *mapping_ranges;
+    uint32_t mapping_ranges_count;
+    uint32_t last_mapping_range;
+
+    struct dyld_shared_cache_file *files;
+    uint32_t files_count;
+
+    const uint8_t *map;
     uint64_t size;
 
     const struct arch_info *arch;
@@ -62,14 +143,36 @@ struct dyld_shared_cache_info {
 
     uint64_t arch_bit;
     uint64_t flags;
+
+    /*
+     * The options the dyld_shared_cache was parsed with.
+     */
+
+    uint64_t options;
 };
 
+/*
+ * Parse the dyld_shared_cache at fd, whose subcaches (if any) are found at path
+ * followed by their suffix.
+ */
+
 enum dyld_shared_cache_parse_result
 dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *info_in,
                                   int fd,
+                                  const char *path,
                                   const char magic[16],
                                   uint64_t options);
 
+/*
+ * Get the arch-info of the dyld_shared_cache with magic, without parsing the
+ * rest of the dyld_shared_cache.
+ *
+ * Returns NULL if magic is not that of a (supported) dyld_shared_cache.
+ */
+
+const struct arch_info *
+dyld_shared_cache_get_arch_info_from_magic(const char magic[16]);
+
 enum dyld_shared_cache_parse_result
 dyld_shared_cache_parse_from_range(struct dyld_shared_cache_info *info_in,
                                    int fd,
@@ -84,7 +187,7 @@ dyld_shared_cache_parse_from_range(struct dyld_shared_cache_info *info_in,
 
 typedef bool
 (*dyld_shared_cache_iterate_images_callback)(
-    struct dyld_cache_image_info *image,
+    const struct dyld_cache_image_info *image,
     const char *path,
     void *item);
 
@@ -94,10 +197,87 @@ dyld_shared_cache_iterate_images_with_callback(
     void *item,
     dyld_shared_cache_iterate_images_callback callback);
 
+/*
+ * Get the file-offset of address from the mappings of info, with the file
+ * storing the mapping returned in file_out, and the size of the mapping left
+ * after address returned in max_size_out.
+ *
+ * Returns 0 if no mapping contains address.
+ */
+
+uint64_t
+dyld_shared_cache_get_file_offset_from_address(
+    struct dyld_shared_cache_info *info,
+    uint64_t address,
+    struct dyld_shared_cache_file **file_out,
+    uint64_t *max_size_out);
+
+/*
+ * Get the map of file, mapping file to memory if it isn't already.
+ *
+ * Files may be mapped by several threads at once, of which only one map is
+ * kept.
+ *
+ * Returns NULL if file could not be mapped.
+ */
+
+const uint8_t *
+dyld_shared_cache_map_file(const struct dyld_shared_cache_info *info,
+                           struct dyld_shared_cache_file *file);
+
+/*
+ * Start reading in the mach-header and load-commands of image, if info was
+ * parsed with O_DYLD_SHARED_CACHE_PARSE_PREFETCH, so they're available once
+ * image is parsed.
+ */
+
+void
+dyld_shared_cache_prefetch_image(struct dyld_shared_cache_info *info,
+                                 const struct dyld_cache_image_info *image);
+
+/*
+ * The image-infos of a dyld_shared_cache, along with their paths, read without
+ * mapping (or validating the mappings of) the dyld_shared_cache.
+ */
+
+struct dyld_shared_cache_image_list {
+    struct dyld_cache_image_info *images;
+    uint32_t images_count;
+
+    /*
+     * The range of the file storing every image's path, beginning at
+     * paths_offset.
+     */
+
+    char *paths;
+    uint64_t paths_offset;
+    uint64_t paths_size;
+};
+
+/*
+ * Read the image-list of the dyld_shared_cache at fd with pread(), reading only
+ * the header, the image-infos, and the range of the file storing their paths.
+ */
+
+enum dyld_shared_cache_parse_result
+dyld_shared_cache_read_image_list(struct dyld_shared_cache_image_list *list_out,
+                                  int fd);
+
+/*
+ * Every image's path is verified to be terminated within the list's paths when
+ * the list is read.
+ */
+
+static inline const char *
+dyld_shared_cache_image_list_get_path(
+    const struct dyld_shared_cache_image_list *const list,
+    const struct dyld_cache_image_info *const image)
+{
+    return list->paths + (image->pathFileOffset - list->paths_offset);
+}
+
 void
-dyld_shared_cache_print_list_of_images(int fd,
-                                       uint64_t start,
-                                       uint64_t end);
+dyld_shared_cache_image_list_destroy(struct dyld_shared_cache_image_list *list);
 
 void dyld_shared_cache_info_destroy(struct dyld_shared_cache_info *info);
 
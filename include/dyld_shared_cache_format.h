@@ -15,13 +15,89 @@
  * From dyld/dyld3/shared-cache/dyld_cache_format.h in apple's dyld source.
  */
 
+/*
+ * The header has grown over time, and is only as large as the offset of the
+ * mapping-infos, with every field at or past mappingOffset not present.
+ */
+
 struct dyld_cache_header {
     char magic[16];
     uint32_t mappingOffset;
     uint32_t mappingCount;
+    uint32_t imagesOffsetOld;
+    uint32_t imagesCountOld;
+    uint64_t dyldBaseAddress;
+    uint64_t codeSignatureOffset;
+    uint64_t codeSignatureSize;
+    uint64_t slideInfoOffsetUnused;
+    uint64_t slideInfoSizeUnused;
+    uint64_t localSymbolsOffset;
+    uint64_t localSymbolsSize;
+    uint8_t uuid[16];
+    uint64_t cacheType;
+    uint32_t branchPoolsOffset;
+    uint32_t branchPoolsCount;
+    uint64_t dyldInCacheMH;
+    uint64_t dyldInCacheEntry;
+    uint64_t imagesTextOffset;
+    uint64_t imagesTextCount;
+    uint64_t patchInfoAddr;
+    uint64_t patchInfoSize;
+    uint64_t otherImageGroupAddrUnused;
+    uint64_t otherImageGroupSizeUnused;
+    uint64_t progClosuresAddr;
+    uint64_t progClosuresSize;
+    uint64_t progClosuresTrieAddr;
+    uint64_t progClosuresTrieSize;
+    uint32_t platform;
+    uint32_t formatVersionAndFlags;
+    uint64_t sharedRegionStart;
+    uint64_t sharedRegionSize;
+    uint64_t maxSlide;
+    uint64_t dylibsImageArrayAddr;
+    uint64_t dylibsImageArraySize;
+    uint64_t dylibsTrieAddr;
+    uint64_t dylibsTrieSize;
+    uint64_t otherImageArrayAddr;
+    uint64_t otherImageArraySize;
+    uint64_t otherTrieAddr;
+    uint64_t otherTrieSize;
+    uint32_t mappingWithSlideOffset;
+    uint32_t mappingWithSlideCount;
+    uint64_t dylibsPBLStateArrayAddrUnused;
+    uint64_t dylibsPBLSetAddr;
+    uint64_t programsPBLSetPoolAddr;
+    uint64_t programsPBLSetPoolSize;
+    uint64_t programTrieAddr;
+    uint32_t programTrieSize;
+    uint32_t osVersion;
+    uint32_t altPlatform;
+    uint32_t altOsVersion;
+    uint64_t swiftOptsOffset;
+    uint64_t swiftOptsSize;
+
+    /*
+     * Split shared-caches store their mappings in several files. The main file
+     * lists its subcaches, each found at the main file's path followed by a
+     * suffix.
+     */
+
+    uint32_t subCacheArrayOffset;
+    uint32_t subCacheArrayCount;
+    uint8_t symbolFileUUID[16];
+    uint64_t rosettaReadOnlyAddr;
+    uint64_t rosettaReadOnlySize;
+    uint64_t rosettaReadWriteAddr;
+    uint64_t rosettaReadWriteSize;
+
+    /*
+     * Newer shared-caches store their image-infos here, leaving imagesOffsetOld
+     * and imagesCountOld zero.
+     */
+
     uint32_t imagesOffset;
     uint32_t imagesCount;
-    uint64_t dyldBaseAddress;
+    uint32_t cacheSubType;
 };
 
 struct dyld_cache_mapping_info {
@@ -40,4 +116,20 @@ struct dyld_cache_image_info {
     uint32_t pad;
 };
 
+/*
+ * The subcache-entries of shared-caches whose mapping-infos start at or before
+ * cacheSubType, whose subcaches are found with the suffix ".<index + 1>".
+ */
+
+struct dyld_subcache_entry_v1 {
+    uint8_t uuid[16];
+    uint64_t cacheVMOffset;
+};
+
+struct dyld_subcache_entry {
+    uint8_t uuid[16];
+    uint64_t cacheVMOffset;
+    char fileSuffix[32];
+};
+
 #endif /* DYLD_SHARED_CACHE_FORMAT_H */
@@ -37,7 +37,14 @@ enum macho_file_options {
      * Treat a section's offset as absolute.
      */
 
-    O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE = 1 << 5
+    O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE = 1 << 5,
+
+    /*
+     * Parse the symbol-tables of a fat mach-o's slices concurrently, with up
+     * to the given number of jobs, merging their exports afterwards.
+     */
+
+    O_MACHO_FILE_PARSE_SLICES_IN_PARALLEL = 1 << 6
 };
 
 struct macho_arch_group_specific_info {
@@ -81,6 +88,7 @@ enum macho_file_parse_result {
     E_MACHO_FILE_PARSE_INVALID_SECTION,
 
     E_MACHO_FILE_PARSE_INVALID_CLIENT,
+    E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE,
     E_MACHO_FILE_PARSE_INVALID_INSTALL_NAME,
     E_MACHO_FILE_PARSE_INVALID_PARENT_UMBRELLA,
     E_MACHO_FILE_PARSE_INVALID_PLATFORM,
@@ -110,6 +118,8 @@ enum macho_file_parse_result
 macho_file_parse_from_file(struct tbd_create_info *info_in,
                            int fd,
                            uint32_t magic,
+                           uint64_t only_archs,
+                           uint32_t jobs,
                            uint64_t parse_options,
                            uint64_t options);
 
@@ -40,7 +40,18 @@ enum macho_file_parse_result
 macho_file_parse_load_commands_from_file(
     struct tbd_create_info *info_in,
     const struct mf_parse_load_commands_from_file_info *parse_info,
-    struct symtab_command *symtab_out);
+    struct symtab_command *symtab_out,
+    struct linkedit_data_command *export_trie_out);
+
+/*
+ * Return a pointer to the size bytes of section-data at address, or NULL if no
+ * such data exists.
+ */
+
+typedef const uint8_t *
+(*macho_file_get_section_data_callback)(void *item,
+                                        uint64_t address,
+                                        uint64_t size);
 
 struct mf_parse_load_commands_from_map_info {
     const uint8_t *map;
@@ -54,6 +65,15 @@ struct mf_parse_load_commands_from_map_info {
 
     struct range available_map_range;
 
+    /*
+     * Images of split dyld_shared_caches may have segments stored in files
+     * other than the one at map, and so have their sections found by address
+     * with get_section_data instead, if provided.
+     */
+
+    macho_file_get_section_data_callback get_section_data;
+    void *get_section_data_item;
+
     bool is_64;
     bool is_big_endian;
 
@@ -68,6 +88,7 @@ enum macho_file_parse_result
 macho_file_parse_load_commands_from_map(
     struct tbd_create_info *info_in,
     const struct mf_parse_load_commands_from_map_info *parse_info,
-    struct symtab_command *symtab_out);
+    struct symtab_command *symtab_out,
+    struct linkedit_data_command *export_trie_out);
 
 #endif /* MACHO_FILE_PARSE_LOAD_COMMANDS_H */
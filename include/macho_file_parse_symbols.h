@@ -9,8 +9,10 @@
 #ifndef MACHO_FILE_PARSE_SYMBOLS_H
 #define MACHO_FILE_PARSE_SYMBOLS_H
 
+#include <stdbool.h>
 #include <stdio.h>
 
+#include "mach-o/loader.h"
 #include "macho_file.h"
 #include "range.h"
 
@@ -40,6 +42,12 @@ macho_file_parse_symbols_64_from_file(struct tbd_create_info *info,
                                       uint32_t strsize,
                                       uint64_t tbd_options);
 
+/*
+ * Unless O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP is provided in options, export
+ * strings point into the map's string-table instead of being copied, and so
+ * the map must outlive info.
+ */
+
 enum macho_file_parse_result
 macho_file_parse_symbols_from_map(struct tbd_create_info *info,
                                   const uint8_t *map,
@@ -50,7 +58,8 @@ macho_file_parse_symbols_from_map(struct tbd_create_info *info,
                                   uint32_t nsyms,
                                   uint32_t stroff,
                                   uint32_t strsize,
-                                  uint64_t tbd_options);
+                                  uint64_t tbd_options,
+                                  uint64_t options);
 
 enum macho_file_parse_result
 macho_file_parse_symbols_64_from_map(struct tbd_create_info *info,
@@ -62,6 +71,79 @@ macho_file_parse_symbols_64_from_map(struct tbd_create_info *info,
                                      uint32_t nsyms,
                                      uint32_t stroff,
                                      uint32_t strsize,
-                                     uint64_t tbd_options);
+                                     uint64_t tbd_options,
+                                     uint64_t options);
+
+/*
+ * The export-trie (from LC_DYLD_INFO(_ONLY) or LC_DYLD_EXPORTS_TRIE) lists only
+ * the exported symbols, and so is far smaller than the symbol-table, but it
+ * can't be used when private symbols were requested.
+ */
+
+static inline
+bool macho_file_can_parse_export_trie(const uint64_t tbd_options) {
+    const uint64_t all_allow_symbols_flags =
+        O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_OBJC_CLASS_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_OBJC_IVAR_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_WEAK_DEF_SYMBOLS;
+
+    return !(tbd_options & all_allow_symbols_flags);
+}
+
+enum macho_file_parse_result
+macho_file_parse_export_trie_from_file(struct tbd_create_info *info,
+                                       int fd,
+                                       struct range full_range,
+                                       struct range available_range,
+                                       uint64_t arch_bit,
+                                       uint32_t export_off,
+                                       uint32_t export_size,
+                                       uint64_t tbd_options);
+
+/*
+ * Export strings are always copied, as they're built up from the trie's edges.
+ */
+
+enum macho_file_parse_result
+macho_file_parse_export_trie_from_map(struct tbd_create_info *info,
+                                      const uint8_t *map,
+                                      struct range available_range,
+                                      uint64_t arch_bit,
+                                      uint32_t export_off,
+                                      uint32_t export_size,
+                                      uint64_t tbd_options);
+
+struct mf_parse_exports_info {
+    /*
+     * The exports are read from map if it's not NULL, and otherwise from fd.
+     */
+
+    const uint8_t *map;
+    int fd;
+
+    struct range full_range;
+    struct range available_range;
+
+    uint64_t arch_bit;
+
+    bool is_64;
+    bool is_big_endian;
+
+    struct symtab_command symtab;
+    struct linkedit_data_command export_trie;
+
+    uint64_t tbd_options;
+    uint64_t options;
+};
+
+/*
+ * Parse the exports of a mach-o from its export-trie when possible, and
+ * otherwise from its symbol-table.
+ */
+
+enum macho_file_parse_result
+macho_file_parse_exports(struct tbd_create_info *info,
+                         const struct mf_parse_exports_info *parse_info);
 
 #endif /* MACHO_FILE_PARSE_SYMBOLS_H */
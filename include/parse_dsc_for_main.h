@@ -28,6 +28,6 @@ parse_shared_cache(void *magic_in,
                    bool ignore_non_cache,
                    bool print_paths);
 
-void print_list_of_dsc_images(int fd);
+void print_list_of_dsc_images(int fd, bool machine_readable);
 
 #endif /* PARSE_DSC_FOR_MAIN_H */
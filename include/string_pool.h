@@ -0,0 +1,55 @@
+//
+//  include/string_pool.h
+//  tbd
+//
+//  Created by inoahdev on 03/09/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <stdint.h>
+
+/*
+ * string_pool is a bump-allocator for strings, copying them into a list of
+ * large chunks instead of allocating each string separately.
+ *
+ * Strings in the pool can't be freed individually. Instead, the pool is reset
+ * (keeping its chunks around to be reused), or destroyed all at once.
+ */
+
+struct string_pool_chunk;
+
+struct string_pool {
+    struct string_pool_chunk *front;
+    struct string_pool_chunk *current;
+
+    char *iter;
+    char *end;
+};
+
+/*
+ * Copy length bytes of string into the pool, followed by a null-terminator.
+ * Returns NULL if allocating a new chunk failed.
+ */
+
+char *
+string_pool_copy_string(struct string_pool *pool,
+                        const char *string,
+                        uint64_t length);
+
+/*
+ * Rewind the pool to its first chunk, invalidating every string copied into
+ * the pool, while keeping up to max_kept_size bytes of its chunks to be reused.
+ */
+
+void string_pool_reset(struct string_pool *pool, uint64_t max_kept_size);
+
+/*
+ * Deallocate every chunk in the pool and reset the pool's fields.
+ */
+
+void string_pool_destroy(struct string_pool *pool);
+
+#endif /* STRING_POOL_H */
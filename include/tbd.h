@@ -13,6 +13,8 @@
 
 #include "arch_info.h"
 #include "array.h"
+#include "string_pool.h"
+#include "write_buffer.h"
 
 /*
  * Options to handle when parsing out information for tbd_create_info.
@@ -79,24 +81,56 @@ enum tbd_export_type {
 };
 
 enum tbd_export_info_flags {
-    F_TBD_EXPORT_INFO_STRING_NEEDS_QUOTES = 1 << 0
+    F_TBD_EXPORT_INFO_STRING_NEEDS_QUOTES = 1 << 0,
+
+    /*
+     * The string points into a mapped file (such as a dyld_shared_cache) that
+     * outlives the create-info, and is neither allocated nor in the
+     * export-strings pool.
+     */
+
+    F_TBD_EXPORT_INFO_STRING_IS_BORROWED = 1 << 1
 };
 
+/*
+ * Export-infos are packed into 24 bytes, as a create-info may hold hundreds of
+ * thousands of them, all of which are hashed, sorted and then written out.
+ *
+ * archs_count can never exceed 64, and type and flags are stored as a byte
+ * each (enum tbd_export_type and enum tbd_export_info_flags).
+ */
+
 struct tbd_export_info {
     uint64_t archs;
-    uint64_t archs_count;
-
-    enum tbd_export_type type;
     char *string;
 
     uint32_t length;
-    uint64_t flags;
+
+    uint8_t archs_count;
+    uint8_t type;
+    uint8_t flags;
 };
 
 int tbd_export_info_comparator(const void *array_item, const void *item);
 int
 tbd_export_info_no_archs_comparator(const void *array_item, const void *item);
 
+/*
+ * Open-addressing hash-set of the export-infos in a create-info's exports
+ * array, keyed on each export-info's type and string.
+ *
+ * Each slot stores the index of an export-info plus one, so that a slot of zero
+ * is empty. Exports are only looked up through the set while parsing, and the
+ * set is destroyed once the exports array is finally sorted.
+ */
+
+struct tbd_export_set {
+    uint64_t *slots;
+
+    uint64_t capacity;
+    uint64_t count;
+};
+
 struct tbd_uuid_info {
     const struct arch_info *arch;
     uint8_t uuid[16];
@@ -115,6 +149,12 @@ enum tbd_create_info_flags {
     F_TBD_CREATE_INFO_PARENT_UMBRELLA_NEEDS_QUOTES = 1 << 1,
 
     F_TBD_CREATE_INFO_STRINGS_WERE_COPIED = 1 << 2,
+
+    /*
+     * The exports array is already sorted, and no export has been added since.
+     */
+
+    F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED = 1 << 3
 };
 
 struct tbd_create_info {
@@ -139,9 +179,89 @@ struct tbd_create_info {
     struct array exports;
     struct array uuids;
 
+    struct tbd_export_set exports_set;
+
+    /*
+     * The strings of all export-infos in exports that aren't borrowed are
+     * copied into export_strings, rather than being allocated separately.
+     */
+
+    struct string_pool export_strings;
     uint64_t flags;
 };
 
+/*
+ * Find an export-info in info's exports with the same type and string as
+ * export_info, returning NULL if no such export-info exists.
+ *
+ * The hash of export_info is always returned in hash_out, for a later call to
+ * tbd_create_info_add_export().
+ */
+
+struct tbd_export_info *
+tbd_create_info_find_export(const struct tbd_create_info *info,
+                            const struct tbd_export_info *export_info,
+                            uint64_t *hash_out);
+
+/*
+ * Add an export-info not already in info's exports (as checked with
+ * tbd_create_info_find_export()), with hash as returned from
+ * tbd_create_info_find_export().
+ */
+
+enum array_result
+tbd_create_info_add_export(struct tbd_create_info *info,
+                           const struct tbd_export_info *export_info,
+                           uint64_t hash);
+
+/*
+ * Reserve space for a total of count exports, to avoid reallocating the exports
+ * array and export-set while parsing a symbol-table.
+ */
+
+enum array_result
+tbd_create_info_reserve_exports(struct tbd_create_info *info, uint64_t count);
+
+/*
+ * Remove the symbols added to info for arch_bit since info had exports_count
+ * exports, such as those of an export-trie that failed to parse partway
+ * through. Clients and re-exports are kept.
+ */
+
+enum array_result
+tbd_create_info_remove_symbols_since(struct tbd_create_info *info,
+                                     uint64_t exports_count,
+                                     uint64_t arch_bit);
+
+/*
+ * Sort the exports array with tbd_export_info_comparator, destroying the
+ * export-set, which is no longer valid afterwards.
+ *
+ * Exports already sorted (as marked by F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED)
+ * aren't sorted again.
+ */
+
+enum array_result tbd_create_info_sort_exports(struct tbd_create_info *info);
+
+/*
+ * Add the exports in each of the count export-arrays of exports_list to info's
+ * exports with a k-way merge, combining the archs of an export found in more
+ * than one array.
+ *
+ * Each array must be sorted by type and string (such as the exports of a single
+ * arch sorted with tbd_create_info_sort_exports()), and none of their exports
+ * may already be in info. Their strings are copied into info's export-strings
+ * pool.
+ *
+ * info's exports are left sorted (as with tbd_create_info_sort_exports()), and
+ * can no longer be looked up.
+ */
+
+enum array_result
+tbd_create_info_merge_exports(struct tbd_create_info *info,
+                              const struct array *const *exports_list,
+                              uint64_t count);
+
 enum tbd_create_result {
     E_TBD_CREATE_OK,
     E_TBD_CREATE_WRITE_FAIL
@@ -159,11 +279,39 @@ enum tbd_create_options {
     O_TBD_CREATE_IGNORE_UNNECESSARY_FIELDS    = 1 << 8
 };
 
+/*
+ * Format info as a tbd into buffer, to be written out all at once.
+ */
+
 enum tbd_create_result
 tbd_create_with_info(const struct tbd_create_info *info,
-                     FILE *file,
+                     struct write_buffer *buffer,
                      uint64_t options);
 
 void tbd_create_info_destroy(struct tbd_create_info *info);
 
+/*
+ * Deallocate only the storage of info: its exports and uuids arrays,
+ * export-set, and export-strings pool.
+ */
+
+void tbd_create_info_destroy_storage(struct tbd_create_info *info);
+
+/*
+ * Reset info's fields, while keeping the storage of its exports and uuids
+ * arrays, export-set, and export-strings pool to be reused for the next file or
+ * image parsed. Storage that has grown too large is deallocated instead.
+ */
+
+void tbd_create_info_clear(struct tbd_create_info *info);
+
+/*
+ * Move the storage kept by tbd_create_info_clear() in cleared into info, such
+ * as after info was reset to a copy of its original fields.
+ */
+
+void
+tbd_create_info_keep_storage(struct tbd_create_info *info,
+                             const struct tbd_create_info *cleared);
+
 #endif /* TBD_H */
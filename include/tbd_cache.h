@@ -0,0 +1,140 @@
+//
+//  include/tbd_cache.h
+//  tbd
+//
+//  Created by inoahdev on 03/11/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#ifndef TBD_CACHE_H
+#define TBD_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dyld_shared_cache.h"
+#include "tbd_for_main.h"
+
+/*
+ * The cache is a directory of entries, each named after the hash of its key,
+ * and storing the full key to guard against collisions.
+ *
+ * A key identifies an input-file by its device, inode, size and modification
+ * time, and its uuids, along with every option (and field provided by the user)
+ * that changes what parsing the file results in.
+ */
+
+enum tbd_cache_key_kind {
+    TBD_CACHE_KEY_KIND_MACHO = 1,
+    TBD_CACHE_KEY_KIND_DYLD_SHARED_CACHE
+};
+
+struct tbd_cache_key {
+    uint64_t kind;
+
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+
+    uint64_t mtime_sec;
+    uint64_t mtime_nsec;
+
+    /*
+     * For dyld_shared_cache files, the uuid found in the header, if any.
+     */
+
+    uint8_t uuid[16];
+
+    /*
+     * For mach-o files, a hash of the uuid of every architecture, so that a
+     * rebuilt mach-o with the same size and modification-time isn't matched.
+     */
+
+    uint64_t uuids_hash;
+
+    uint64_t macho_options;
+    uint64_t dsc_options;
+    uint64_t parse_options;
+    uint64_t write_options;
+    uint64_t flags;
+
+    uint64_t version;
+    uint64_t archs;
+    uint64_t only_archs;
+    uint64_t flags_field;
+    uint64_t platform;
+    uint64_t objc_constraint;
+    uint64_t current_version;
+    uint64_t compatibility_version;
+    uint64_t swift_version;
+
+    /*
+     * For dyld_shared_cache files, a hash of the write-path, and the image
+     * filters, numbers and paths.
+     */
+
+    uint64_t outputs_hash;
+};
+
+/*
+ * Remove the temporary entries left behind in cache_path by instances of tbd
+ * that exited before their entries were fully written.
+ */
+
+void tbd_cache_remove_stale_entries(const char *cache_path);
+
+/*
+ * Create a key for the mach-o file at fd, with the options of tbd.
+ * Returns false if fd is not a regular file.
+ */
+
+bool
+tbd_cache_key_for_macho(struct tbd_cache_key *key_out,
+                        const struct tbd_for_main *tbd,
+                        int fd);
+
+bool
+tbd_cache_key_for_dsc(struct tbd_cache_key *key_out,
+                      const struct tbd_for_main *tbd,
+                      int fd,
+                      const struct dyld_shared_cache_info *dsc_info,
+                      const char *write_path,
+                      uint64_t write_path_length);
+
+/*
+ * Load the create-info stored for key into info.
+ *
+ * Returns false if no (valid) entry exists for key. info may have been
+ * partially filled in, and should be cleared before being parsed into.
+ */
+
+bool
+tbd_cache_load_info(const char *cache_path,
+                    const struct tbd_cache_key *key,
+                    struct tbd_create_info *info);
+
+void
+tbd_cache_store_info(const char *cache_path,
+                     const struct tbd_cache_key *key,
+                     const struct tbd_create_info *info);
+
+/*
+ * dyld_shared_cache entries mark that the shared-cache was fully extracted with
+ * key, and store the paths of the files that were written out.
+ *
+ * An entry is only found if every one of its written-out files still exists.
+ */
+
+bool
+tbd_cache_has_entry(const char *cache_path, const struct tbd_cache_key *key);
+
+/*
+ * written_paths is an array of (null-terminated) char pointers.
+ */
+
+void
+tbd_cache_store_entry(const char *cache_path,
+                      const struct tbd_cache_key *key,
+                      const struct array *written_paths);
+
+#endif /* TBD_CACHE_H */
@@ -14,7 +14,14 @@
 
 enum tbd_for_main_dsc_image_flags {
     F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE         = 1 << 0,
-    F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING = 1 << 1
+    F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING = 1 << 1,
+
+    /*
+     * Set when an image has been selected to be parsed by a worker, but has not
+     * yet been parsed.
+     */
+
+    F_TBD_FOR_MAIN_DSC_IMAGE_SELECTED_ONE = 1 << 2
 };
 
 enum tbd_for_main_dsc_image_filter_type {
@@ -110,9 +117,47 @@ struct tbd_for_main {
     uint64_t archs_re;
     uint32_t flags_re;
 
+    /*
+     * Architectures to parse out of mach-o files and dyld_shared_caches. Every
+     * other architecture is skipped before it is read. Zero selects every
+     * architecture.
+     */
+
+    uint64_t only_archs;
+
+    /*
+     * Number of workers to parse files with when recursing directories.
+     * Zero and one both mean files are parsed serially.
+     */
+
+    uint32_t jobs;
+
+    /*
+     * Directory to cache parsed files in, to skip parsing files that haven't
+     * changed since the last run. Points into argv, and so isn't freed.
+     */
+
+    const char *cache_path;
+
     struct array dsc_image_filters;
     struct array dsc_image_numbers;
     struct array dsc_image_paths;
+
+    /*
+     * Paths of dyld_shared_caches (of other architectures) whose images are
+     * merged into the images of the same install-name from the
+     * dyld_shared_cache at parse_path. The paths point into argv, and so
+     * aren't freed.
+     */
+
+    struct array dsc_merge_paths;
+
+    /*
+     * Buffer each tbd is formatted into before being written out. Kept
+     * between files so its allocation is reused.
+     */
+
+    struct write_buffer write_buffer;
 };
 
 bool
@@ -149,13 +194,13 @@ enum tbd_for_main_write_to_path_result {
 };
 
 enum tbd_for_main_write_to_path_result
-tbd_for_main_write_to_path(const struct tbd_for_main *tbd,
+tbd_for_main_write_to_path(struct tbd_for_main *tbd,
                            char *write_path,
                            uint64_t write_path_length,
                            bool print_paths);
 
 void
-tbd_for_main_write_to_stdout(const struct tbd_for_main *tbd,
+tbd_for_main_write_to_stdout(struct tbd_for_main *tbd,
                              const char *input_path,
                              bool print_paths);
 
@@ -0,0 +1,46 @@
+//
+//  include/worker_pool.h
+//  tbd
+//
+//  Created by inoahdev on 03/02/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+
+/*
+ * Callback called once for every item-index in [0, items_count), with the
+ * index of the worker (in [0, workers_count)) that is handling the item.
+ *
+ * The worker-index can be used to look up state private to each worker.
+ */
+
+typedef void
+(*worker_pool_callback)(uint64_t index, uint32_t worker, void *info);
+
+/*
+ * Run callback on every item-index, with items handed out to workers_count
+ * workers as each one finishes its previous item.
+ *
+ * The calling thread is used as worker 0. If threads fail to be created, the
+ * remaining items are simply handled by the workers that do exist.
+ */
+
+void
+worker_pool_run(uint32_t workers_count,
+                uint64_t items_count,
+                void *info,
+                worker_pool_callback callback);
+
+/*
+ * Serialize output (and user-input requests) between workers, so messages for
+ * one file are never interleaved with another's.
+ */
+
+void worker_pool_lock_output(void);
+void worker_pool_unlock_output(void);
+
+#endif /* WORKER_POOL_H */
@@ -0,0 +1,70 @@
+//
+//  include/write_buffer.h
+//  tbd
+//
+//  Created by inoahdev on 03/10/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#ifndef WRITE_BUFFER_H
+#define WRITE_BUFFER_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * write_buffer is a growable byte-buffer that output is formatted into before
+ * being written out to a file-descriptor all at once.
+ *
+ * All append functions return 0 on success, and 1 if the buffer failed to
+ * grow.
+ */
+
+struct write_buffer {
+    char *data;
+    char *data_end;
+    char *alloc_end;
+};
+
+int
+write_buffer_append(struct write_buffer *buffer,
+                    const char *data,
+                    uint64_t length);
+
+static inline int
+write_buffer_append_c_str(struct write_buffer *const buffer,
+                          const char *const string)
+{
+    return write_buffer_append(buffer, string, strlen(string));
+}
+
+int write_buffer_append_char(struct write_buffer *buffer, char ch);
+int write_buffer_append_spaces(struct write_buffer *buffer, uint64_t count);
+
+/*
+ * Append the decimal representation of number.
+ */
+
+int write_buffer_append_uint32(struct write_buffer *buffer, uint32_t number);
+
+/*
+ * Append byte as two upper-case hexadecimal digits.
+ */
+
+int write_buffer_append_hex_byte(struct write_buffer *buffer, uint8_t byte);
+
+/*
+ * Write out the buffer's contents to fd, retrying on partial writes.
+ * Returns 0 on success, and 1 if write() failed.
+ */
+
+int write_buffer_write_to_fd(const struct write_buffer *buffer, int fd);
+
+/*
+ * Drop the buffer's contents, while keeping its allocation to be reused.
+ */
+
+void write_buffer_clear(struct write_buffer *buffer);
+void write_buffer_destroy(struct write_buffer *buffer);
+
+#endif /* WRITE_BUFFER_H */
@@ -9,9 +9,21 @@
 #ifndef YAML_H
 #define YAML_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
 bool yaml_check_c_str(const char *string, uint64_t length);
 
+/*
+ * Find the length of string (up to max_length), and whether string needs to be
+ * quoted in yaml, in a single pass.
+ *
+ * On x86_64, string is scanned in 16-byte (SSE2) or 32-byte (AVX2, if
+ * supported at runtime) blocks. Blocks are never read past max_length.
+ */
+
+uint64_t
+yaml_scan_c_str(const char *string, uint64_t max_length, bool *needs_quotes_out);
+
 #endif /* YAML_H */
@@ -295,3 +295,22 @@ const struct arch_info *arch_info_for_name(const char *const name) {
 
     return NULL;
 }
+
+bool
+arch_info_is_in_archs(const struct arch_info *const arch, const uint64_t archs)
+{
+    const uint64_t arch_index = (uint64_t)(arch - arch_info_list);
+    if (archs & (1ull << arch_index)) {
+        return true;
+    }
+
+    /*
+     * Archs given by name, like x86_64h, always use the first arch with that
+     * name, which may not be the arch found for a cputype.
+     */
+
+    const struct arch_info *const named = arch_info_for_name(arch->name);
+    const uint64_t named_index = (uint64_t)(named - arch_info_list);
+
+    return archs & (1ull << named_index);
+}
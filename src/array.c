@@ -494,6 +494,14 @@ array_add_item_with_cached_index_info(
     return array_add_item_to_index(array, item_size, item, index + 1, item_out);
 }
 
+enum array_result
+array_ensure_item_capacity(struct array *const array,
+                           const size_t item_size,
+                           const uint64_t item_count)
+{
+    return array_expand_if_necessary(array, item_size * item_count);
+}
+
 enum array_result
 array_sort_items_with_comparator(struct array *const array,
                                  const size_t item_size,
@@ -524,6 +532,17 @@ array_copy(struct array *const array, struct array *const array_out) {
     return E_ARRAY_OK;
 }
 
+enum array_result
+array_clear(struct array *const array, const uint64_t max_capacity) {
+    const uint64_t capacity = (uint64_t)(array->alloc_end - array->data);
+    if (capacity > max_capacity) {
+        return array_destroy(array);
+    }
+
+    array->data_end = array->data;
+    return E_ARRAY_OK;
+}
+
 /*
  * Deallocate the array's buffer and reset the array's fields.
  */
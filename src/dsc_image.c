@@ -6,6 +6,8 @@
 //  Copyright © 2018 - 2019 inoahdev. All rights reserved.
 //
 
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "mach-o/fat.h"
@@ -18,6 +20,7 @@
 #include "macho_file_parse_symbols.h"
 
 #include "range.h"
+#include "swap.h"
 
 /*
  * To avoid duplicating code, we pass on the mach-o verification to macho_file's
@@ -99,6 +102,9 @@ translate_macho_file_parse_result(const enum macho_file_parse_result result) {
         case E_MACHO_FILE_PARSE_INVALID_CLIENT:
             return E_DSC_IMAGE_PARSE_INVALID_CLIENT;
 
+        case E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE:
+            return E_DSC_IMAGE_PARSE_INVALID_EXPORT_TRIE;
+
         case E_MACHO_FILE_PARSE_INVALID_INSTALL_NAME:
             return E_DSC_IMAGE_PARSE_INVALID_INSTALL_NAME;
 
@@ -121,7 +127,8 @@ translate_macho_file_parse_result(const enum macho_file_parse_result result) {
             return E_DSC_IMAGE_PARSE_INVALID_UUID;
 
         /*
-         * Conflicting error-codes are only returned for fat-files.
+         * Conflicting error-codes are only returned for fat-files, or for
+         * images merged from several dyld_shared_caches.
          */
 
         case E_MACHO_FILE_PARSE_CONFLICTING_ARCH_INFO:
@@ -132,7 +139,7 @@ translate_macho_file_parse_result(const enum macho_file_parse_result result) {
         case E_MACHO_FILE_PARSE_CONFLICTING_PLATFORM:
         case E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION:
         case E_MACHO_FILE_PARSE_CONFLICTING_UUID:
-            return E_DSC_IMAGE_PARSE_FAT_NOT_SUPPORTED;
+            return E_DSC_IMAGE_PARSE_CONFLICTING_INFO;
 
         case E_MACHO_FILE_PARSE_NO_IDENTIFICATION:
             return E_DSC_IMAGE_PARSE_NO_IDENTIFICATION;
@@ -153,43 +160,222 @@ translate_macho_file_parse_result(const enum macho_file_parse_result result) {
     return E_DSC_IMAGE_PARSE_OK;
 }
 
-static uint64_t
-get_image_file_offset_from_address(struct dyld_shared_cache_info *const info,
-                                   const uint64_t address,
-                                   uint64_t *const max_size_out)
+/*
+ * Get the size bytes at address, from whichever file of the dyld_shared_cache
+ * stores them.
+ */
+
+static const uint8_t *
+get_data_at_address(void *const item,
+                    const uint64_t address,
+                    const uint64_t size)
 {
-    const struct dyld_cache_mapping_info *const mappings = info->mappings;
-    const uint64_t count = info->mappings_count;
+    struct dyld_shared_cache_info *const dsc_info =
+        (struct dyld_shared_cache_info *)item;
+
+    struct dyld_shared_cache_file *file = NULL;
+    uint64_t max_size = 0;
+
+    const uint64_t file_offset =
+        dyld_shared_cache_get_file_offset_from_address(dsc_info,
+                                                       address,
+                                                       &file,
+                                                       &max_size);
+
+    if (file_offset == 0 || max_size < size) {
+        return NULL;
+    }
+
+    const uint8_t *const map = dyld_shared_cache_map_file(dsc_info, file);
+    if (map == NULL) {
+        return NULL;
+    }
+
+    return map + file_offset;
+}
+
+/*
+ * Find the __LINKEDIT segment of the image with header, whose load-commands
+ * have already been validated.
+ */
+
+static bool
+find_linkedit_segment(const struct mach_header *const header,
+                      const bool is_64,
+                      const bool is_big_endian,
+                      uint64_t *const vmaddr_out,
+                      uint64_t *const fileoff_out)
+{
+    const uint8_t *load_cmd_iter = (const uint8_t *)header;
+    if (is_64) {
+        load_cmd_iter += sizeof(struct mach_header_64);
+    } else {
+        load_cmd_iter += sizeof(struct mach_header);
+    }
+
+    const uint32_t ncmds = header->ncmds;
+    uint32_t size_left = header->sizeofcmds;
+
+    for (uint32_t i = 0; i != ncmds; i++) {
+        struct load_command load_cmd =
+            *(const struct load_command *)load_cmd_iter;
+
+        if (is_big_endian) {
+            load_cmd.cmd = swap_uint32(load_cmd.cmd);
+            load_cmd.cmdsize = swap_uint32(load_cmd.cmdsize);
+        }
+
+        if (load_cmd.cmdsize < sizeof(struct load_command)) {
+            return false;
+        }
+
+        if (load_cmd.cmdsize > size_left) {
+            return false;
+        }
+
+        if (is_64 && load_cmd.cmd == LC_SEGMENT_64) {
+            const struct segment_command_64 *const segment =
+                (const struct segment_command_64 *)load_cmd_iter;
+
+            if (load_cmd.cmdsize < sizeof(*segment)) {
+                return false;
+            }
+
+            if (strncmp(segment->segname, "__LINKEDIT", 16) == 0) {
+                uint64_t vmaddr = segment->vmaddr;
+                uint64_t fileoff = segment->fileoff;
 
-    for (uint64_t i = 0; i < count; i++) {
-        const struct dyld_cache_mapping_info *const mapping = mappings + i;
+                if (is_big_endian) {
+                    vmaddr = swap_uint64(vmaddr);
+                    fileoff = swap_uint64(fileoff);
+                }
 
-        const uint64_t mapping_begin = mapping->address;
-        const uint64_t mapping_end = mapping_begin + mapping->size;
+                *vmaddr_out = vmaddr;
+                *fileoff_out = fileoff;
 
-        const struct range mapping_range = {
-            .begin = mapping_begin,
-            .end = mapping_end
-        };
+                return true;
+            }
+        } else if (!is_64 && load_cmd.cmd == LC_SEGMENT) {
+            const struct segment_command *const segment =
+                (const struct segment_command *)load_cmd_iter;
 
-        if (!range_contains_location(mapping_range, address)) {
-            continue;
+            if (load_cmd.cmdsize < sizeof(*segment)) {
+                return false;
+            }
+
+            if (strncmp(segment->segname, "__LINKEDIT", 16) == 0) {
+                uint32_t vmaddr = segment->vmaddr;
+                uint32_t fileoff = segment->fileoff;
+
+                if (is_big_endian) {
+                    vmaddr = swap_uint32(vmaddr);
+                    fileoff = swap_uint32(fileoff);
+                }
+
+                *vmaddr_out = vmaddr;
+                *fileoff_out = fileoff;
+
+                return true;
+            }
         }
 
-        const uint64_t delta = address - mapping_begin;
-        const uint64_t file_offset = mapping->fileOffset + delta;
+        load_cmd_iter += load_cmd.cmdsize;
+        size_left -= load_cmd.cmdsize;
+    }
+
+    return false;
+}
+
+/*
+ * The __LINKEDIT of an image, and the file of the dyld_shared_cache storing it.
+ */
+
+struct dsc_image_linkedit {
+    const uint8_t *map;
+    struct range available_range;
+
+    uint64_t fileoff;
+    uint64_t file_offset;
+};
+
+/*
+ * The symbol-table, string-table and export-trie offsets of an image are
+ * relative to the file storing the image's __LINKEDIT, at the segment's
+ * fileoff, which for split dyld_shared_caches is not always the file storing
+ * the image itself.
+ */
+
+static bool
+relocate_linkedit_offset(const struct dsc_image_linkedit *const linkedit,
+                         uint32_t *const offset_in)
+{
+    const uint64_t offset = *offset_in;
+    if (offset < linkedit->fileoff) {
+        return false;
+    }
+
+    const uint64_t relocated =
+        offset - linkedit->fileoff + linkedit->file_offset;
+    if (relocated > UINT32_MAX) {
+        return false;
+    }
+
+    *offset_in = (uint32_t)relocated;
+    return true;
+}
+
+static enum dsc_image_parse_result
+find_linkedit(struct dyld_shared_cache_info *const dsc_info,
+              const struct mach_header *const header,
+              const bool is_64,
+              const bool is_big_endian,
+              struct dsc_image_linkedit *const linkedit_in)
+{
+    uint64_t vmaddr = 0;
+    uint64_t fileoff = 0;
+
+    /*
+     * Without a __LINKEDIT segment, the offsets are left relative to the file
+     * storing the image.
+     */
+
+    const bool found_linkedit =
+        find_linkedit_segment(header, is_64, is_big_endian, &vmaddr, &fileoff);
+
+    if (!found_linkedit) {
+        return E_DSC_IMAGE_PARSE_OK;
+    }
+
+    struct dyld_shared_cache_file *file = NULL;
+    uint64_t max_size = 0;
 
-        *max_size_out = mapping->size - delta;
-        return file_offset;
+    const uint64_t file_offset =
+        dyld_shared_cache_get_file_offset_from_address(dsc_info,
+                                                       vmaddr,
+                                                       &file,
+                                                       &max_size);
+
+    if (file_offset == 0) {
+        return E_DSC_IMAGE_PARSE_NO_CORRESPONDING_MAPPING;
     }
 
-    return 0;
+    const uint8_t *const map = dyld_shared_cache_map_file(dsc_info, file);
+    if (map == NULL) {
+        return E_DSC_IMAGE_PARSE_MMAP_FAIL;
+    }
+
+    linkedit_in->map = map;
+    linkedit_in->available_range = file->available_range;
+    linkedit_in->fileoff = fileoff;
+    linkedit_in->file_offset = file_offset;
+
+    return E_DSC_IMAGE_PARSE_OK;
 }
 
 enum dsc_image_parse_result
 dsc_image_parse(struct tbd_create_info *const info_in,
                 struct dyld_shared_cache_info *const dsc_info,
-                struct dyld_cache_image_info *const image,
+                const struct dyld_cache_image_info *const image,
                 const uint64_t macho_options,
                 const uint64_t tbd_options,
                 const uint64_t options)
@@ -198,15 +384,18 @@ dsc_image_parse(struct tbd_create_info *const info_in,
      * The mappings store the data-structures that make up a mach-o file for all
      * dyld_shared_cache images.
      *
-     * To find out image's data, we have to recurse the mappings, to find the
-     * one containing our file.
+     * To find out image's data, we have to find the mapping containing our
+     * file, which also bounds the size of our file.
      */
 
+    struct dyld_shared_cache_file *file = NULL;
     uint64_t max_image_size = 0;
+
     const uint64_t file_offset =
-        get_image_file_offset_from_address(dsc_info,
-                                           image->address,
-                                           &max_image_size);
+        dyld_shared_cache_get_file_offset_from_address(dsc_info,
+                                                       image->address,
+                                                       &file,
+                                                       &max_image_size);
 
     if (file_offset == 0) {
         return E_DSC_IMAGE_PARSE_NO_CORRESPONDING_MAPPING;
@@ -216,7 +405,16 @@ dsc_image_parse(struct tbd_create_info *const info_in,
         return E_DSC_IMAGE_PARSE_SIZE_TOO_SMALL;
     }
 
-    const uint8_t *const map = dsc_info->map;
+    /*
+     * The subcaches of split dyld_shared_caches are only mapped once an image
+     * stored in them is parsed.
+     */
+
+    const uint8_t *const map = dyld_shared_cache_map_file(dsc_info, file);
+    if (map == NULL) {
+        return E_DSC_IMAGE_PARSE_MMAP_FAIL;
+    }
+
     const struct mach_header *const header =
         (const struct mach_header *)(map + file_offset);
 
@@ -253,6 +451,7 @@ dsc_image_parse(struct tbd_create_info *const info_in,
     }
 
     struct symtab_command symtab = {};
+    struct linkedit_data_command export_trie = {};
 
     /*
      * The symbol-table and string-table offsets are absolute, not relative from
@@ -271,9 +470,10 @@ dsc_image_parse(struct tbd_create_info *const info_in,
         O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE |
         macho_options;
 
+    const bool is_split = dsc_info->files_count > 1;
     struct mf_parse_load_commands_from_map_info info = {
         .map = map,
-        .map_size = dsc_info->size,
+        .map_size = file->size,
 
         .macho = (const uint8_t *)header,
         .macho_size = max_image_size,
@@ -281,7 +481,7 @@ dsc_image_parse(struct tbd_create_info *const info_in,
         .arch = dsc_info->arch,
         .arch_bit = arch_bit,
 
-        .available_map_range = dsc_info->available_range,
+        .available_map_range = file->available_range,
 
         .is_64 = is_64,
         .is_big_endian = is_big_endian,
@@ -293,8 +493,16 @@ dsc_image_parse(struct tbd_create_info *const info_in,
         .options = lc_options
     };
 
+    if (is_split) {
+        info.get_section_data = get_data_at_address;
+        info.get_section_data_item = dsc_info;
+    }
+
     const enum macho_file_parse_result parse_load_commands_result =
-        macho_file_parse_load_commands_from_map(info_in, &info, &symtab);
+        macho_file_parse_load_commands_from_map(info_in,
+                                                &info,
+                                                &symtab,
+                                                &export_trie);
 
     if (parse_load_commands_result != E_MACHO_FILE_PARSE_OK) {
         return translate_macho_file_parse_result(parse_load_commands_result);
@@ -310,49 +518,114 @@ dsc_image_parse(struct tbd_create_info *const info_in,
         return E_DSC_IMAGE_PARSE_OK;
     }
 
+    struct dsc_image_linkedit linkedit = {
+        .map = map,
+        .available_range = file->available_range
+    };
+
+    if (is_split) {
+        const enum dsc_image_parse_result find_linkedit_result =
+            find_linkedit(dsc_info, header, is_64, is_big_endian, &linkedit);
+
+        if (find_linkedit_result != E_DSC_IMAGE_PARSE_OK) {
+            return find_linkedit_result;
+        }
+
+        if (!relocate_linkedit_offset(&linkedit, &symtab.symoff)) {
+            return E_DSC_IMAGE_PARSE_INVALID_SYMBOL_TABLE;
+        }
+
+        if (!relocate_linkedit_offset(&linkedit, &symtab.stroff)) {
+            return E_DSC_IMAGE_PARSE_INVALID_STRING_TABLE;
+        }
+
+        if (export_trie.cmd != 0) {
+            if (!relocate_linkedit_offset(&linkedit, &export_trie.dataoff)) {
+                return E_DSC_IMAGE_PARSE_INVALID_EXPORT_TRIE;
+            }
+        }
+    }
+
     /*
      * For parsing the symbol-tables, we provide the full dyld_shared_cache map
      * as the symbol-table and string-table offsets are relative to the full
-     * map, not relative to the mach-o header.
+     * map, not relative to the mach-o header. The same goes for the
+     * export-trie, which we prefer when present.
      */
 
-    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
-    if (is_64) {
-        ret =
-            macho_file_parse_symbols_64_from_map(info_in,
-                                                 map,
-                                                 dsc_info->available_range,
-                                                 arch_bit,
-                                                 is_big_endian,
-                                                 symtab.symoff,
-                                                 symtab.nsyms,
-                                                 symtab.stroff,
-                                                 symtab.strsize,
-                                                 tbd_options);
-    } else {
-        ret =
-            macho_file_parse_symbols_from_map(info_in,
-                                              map,
-                                              dsc_info->available_range,
-                                              arch_bit,
-                                              is_big_endian,
-                                              symtab.symoff,
-                                              symtab.nsyms,
-                                              symtab.stroff,
-                                              symtab.strsize,
-                                              tbd_options);
-    }
+    const struct mf_parse_exports_info exports_info = {
+        .map = linkedit.map,
+
+        .available_range = linkedit.available_range,
+        .arch_bit = arch_bit,
+
+        .is_64 = is_64,
+        .is_big_endian = is_big_endian,
+
+        .symtab = symtab,
+        .export_trie = export_trie,
+
+        .tbd_options = tbd_options,
+        .options = macho_options
+    };
+
+    const enum macho_file_parse_result ret =
+        macho_file_parse_exports(info_in, &exports_info);
 
     if (ret != E_MACHO_FILE_PARSE_OK) {
         return translate_macho_file_parse_result(ret);
     }
 
-    if (!(options & O_TBD_PARSE_IGNORE_MISSING_EXPORTS)) {
+    /*
+     * When merging, the exports of the images still to be parsed into info_in
+     * are only found with the export-set, which sorting destroys.
+     */
+
+    if (options & O_DSC_IMAGE_PARSE_MERGE) {
+        return E_DSC_IMAGE_PARSE_OK;
+    }
+
+    return dsc_image_finish_merge(info_in, arch_bit, tbd_options);
+}
+
+enum dsc_image_parse_result
+dsc_image_finish_merge(struct tbd_create_info *const info_in,
+                       const uint64_t archs,
+                       const uint64_t tbd_options)
+{
+    if (!(tbd_options & O_TBD_PARSE_IGNORE_MISSING_EXPORTS)) {
         if (array_is_empty(&info_in->exports)) {
             return E_DSC_IMAGE_PARSE_NO_EXPORTS;
         }
     }
 
-    info_in->archs = arch_bit;
+    /*
+     * Finally sort the exports array.
+     */
+
+    const enum array_result sort_exports_result =
+        tbd_create_info_sort_exports(info_in);
+
+    if (sort_exports_result != E_ARRAY_OK) {
+        return E_DSC_IMAGE_PARSE_ARRAY_FAIL;
+    }
+
+    /*
+     * Images may have been merged in any order, so order their uuids by
+     * architecture, as their architectures are written out.
+     */
+
+    struct array *const uuids = &info_in->uuids;
+    const uint64_t uuids_count =
+        array_get_item_count(uuids, sizeof(struct tbd_uuid_info));
+
+    if (uuids_count > 1) {
+        qsort(uuids->data,
+              uuids_count,
+              sizeof(struct tbd_uuid_info),
+              tbd_uuid_info_comparator);
+    }
+
+    info_in->archs = archs;
     return E_DSC_IMAGE_PARSE_OK;
 }
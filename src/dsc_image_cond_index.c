@@ -0,0 +1,443 @@
+//
+//  src/dsc_image_cond_index.c
+//  tbd
+//
+//  Created by inoahdev on 03/12/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsc_image_cond_index.h"
+
+enum dsc_image_cond_kind {
+    DSC_IMAGE_COND_KIND_FILENAME = 1,
+    DSC_IMAGE_COND_KIND_DIRECTORY,
+    DSC_IMAGE_COND_KIND_PATH
+};
+
+struct dsc_image_cond_index_entry {
+    const char *string;
+
+    uint64_t length;
+    uint64_t hash;
+
+    uint32_t kind;
+    uint32_t cond_index;
+
+    /*
+     * The entry-index (plus one) of the next condition with the same kind and
+     * string, or zero.
+     */
+
+    uint32_t next;
+};
+
+static uint64_t
+hash_cond(const enum dsc_image_cond_kind kind,
+          const char *const string,
+          const uint64_t length)
+{
+    /*
+     * Use a simple FNV-1a hash over the string, seeded with the kind.
+     */
+
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)kind;
+
+    const uint8_t *iter = (const uint8_t *)string;
+    const uint8_t *const end = iter + length;
+
+    for (; iter != end; iter++) {
+        hash ^= *iter;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static inline bool
+entry_matches(const struct dsc_image_cond_index_entry *const entry,
+              const enum dsc_image_cond_kind kind,
+              const uint64_t hash,
+              const char *const string,
+              const uint64_t length)
+{
+    if (entry->hash != hash || entry->kind != kind) {
+        return false;
+    }
+
+    if (entry->length != length) {
+        return false;
+    }
+
+    return memcmp(entry->string, string, length) == 0;
+}
+
+/*
+ * Return the index (plus one) of the first entry with kind and string, or zero
+ * if no such entry exists.
+ */
+
+static uint32_t
+find_entry(const struct dsc_image_cond_index *const index,
+           const enum dsc_image_cond_kind kind,
+           const char *const string,
+           const uint64_t length)
+{
+    const uint64_t capacity = index->capacity;
+    if (capacity == 0) {
+        return 0;
+    }
+
+    const uint64_t hash = hash_cond(kind, string, length);
+    const uint64_t mask = capacity - 1;
+
+    const struct dsc_image_cond_index_entry *const entries = index->entries;
+    const uint32_t *const slots = index->slots;
+
+    for (uint64_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask) {
+        const uint32_t entry_index = slots[i] - 1;
+        if (entry_matches(entries + entry_index, kind, hash, string, length)) {
+            return slots[i];
+        }
+    }
+
+    return 0;
+}
+
+static void
+insert_entry(struct dsc_image_cond_index *const index,
+             const uint32_t entry_index)
+{
+    struct dsc_image_cond_index_entry *const entries = index->entries;
+    struct dsc_image_cond_index_entry *const entry = entries + entry_index;
+
+    const uint64_t mask = index->capacity - 1;
+    uint32_t *const slots = index->slots;
+
+    uint64_t i = entry->hash & mask;
+    for (; slots[i] != 0; i = (i + 1) & mask) {
+        struct dsc_image_cond_index_entry *existing = entries + (slots[i] - 1);
+        if (!entry_matches(existing,
+                           entry->kind,
+                           entry->hash,
+                           entry->string,
+                           entry->length))
+        {
+            continue;
+        }
+
+        /*
+         * Append to the end of the existing chain, so conditions are always
+         * found in the order they were provided.
+         */
+
+        while (existing->next != 0) {
+            existing = entries + (existing->next - 1);
+        }
+
+        existing->next = entry_index + 1;
+        return;
+    }
+
+    slots[i] = entry_index + 1;
+}
+
+static void
+add_entry(struct dsc_image_cond_index *const index,
+          uint32_t *const count_in,
+          const enum dsc_image_cond_kind kind,
+          const char *const string,
+          const uint64_t length,
+          const uint32_t cond_index)
+{
+    const uint32_t entry_index = *count_in;
+    index->entries[entry_index] = (struct dsc_image_cond_index_entry){
+        .string = string,
+        .length = length,
+        .hash = hash_cond(kind, string, length),
+        .kind = kind,
+        .cond_index = cond_index
+    };
+
+    insert_entry(index, entry_index);
+    *count_in = entry_index + 1;
+}
+
+static bool
+add_index(struct array *const array, const uint32_t index) {
+    const enum array_result add_index_result =
+        array_add_item(array, sizeof(index), &index, NULL);
+
+    return add_index_result == E_ARRAY_OK;
+}
+
+bool
+dsc_image_cond_index_create(struct dsc_image_cond_index *const index_out,
+                            const struct array *const filters,
+                            const struct array *const paths)
+{
+    const uint64_t filters_count =
+        array_get_item_count(filters,
+                             sizeof(struct tbd_for_main_dsc_image_filter));
+
+    const uint64_t paths_count =
+        array_get_item_count(paths, sizeof(struct tbd_for_main_dsc_image_path));
+
+    struct dsc_image_cond_index index = {
+        .filters = filters->data,
+        .paths = paths->data,
+        .filters_count = (uint32_t)filters_count,
+        .paths_count = (uint32_t)paths_count
+    };
+
+    const uint64_t conds_count = filters_count + paths_count;
+    if (conds_count == 0) {
+        *index_out = index;
+        return true;
+    }
+
+    uint64_t capacity = 64;
+    while (capacity < conds_count * 2) {
+        capacity *= 2;
+    }
+
+    index.entries = calloc(conds_count, sizeof(*index.entries));
+    index.slots = calloc(capacity, sizeof(*index.slots));
+    index.capacity = capacity;
+
+    if (index.entries == NULL || index.slots == NULL) {
+        dsc_image_cond_index_destroy(&index);
+        return false;
+    }
+
+    uint32_t entries_count = 0;
+    for (uint32_t i = 0; i != filters_count; i++) {
+        const struct tbd_for_main_dsc_image_filter *const filter =
+            index.filters + i;
+
+        /*
+         * Filters that are empty, or that have a slash, can't be found by a
+         * single path-component, and so have to be checked for every path.
+         */
+
+        const char *const string = filter->string;
+        const uint64_t length = filter->length;
+
+        if (length == 0 || memchr(string, '/', length) != NULL) {
+            if (!add_index(&index.unindexed_filters, i)) {
+                dsc_image_cond_index_destroy(&index);
+                return false;
+            }
+
+            continue;
+        }
+
+        enum dsc_image_cond_kind kind = DSC_IMAGE_COND_KIND_FILENAME;
+        if (filter->type == TBD_FOR_MAIN_DSC_IMAGE_FILTER_TYPE_DIRECTORY) {
+            kind = DSC_IMAGE_COND_KIND_DIRECTORY;
+        }
+
+        add_entry(&index, &entries_count, kind, string, length, i);
+    }
+
+    for (uint32_t i = 0; i != paths_count; i++) {
+        const struct tbd_for_main_dsc_image_path *const path = index.paths + i;
+        add_entry(&index,
+                  &entries_count,
+                  DSC_IMAGE_COND_KIND_PATH,
+                  path->string,
+                  path->length,
+                  i);
+    }
+
+    *index_out = index;
+    return true;
+}
+
+static bool
+add_chain(struct dsc_image_cond_index *const index,
+          struct array *const candidates,
+          const enum dsc_image_cond_kind kind,
+          const char *const string,
+          const uint64_t length)
+{
+    const struct dsc_image_cond_index_entry *const entries = index->entries;
+    uint32_t entry = find_entry(index, kind, string, length);
+
+    while (entry != 0) {
+        const struct dsc_image_cond_index_entry *const info =
+            entries + (entry - 1);
+
+        if (!add_index(candidates, info->cond_index)) {
+            return false;
+        }
+
+        entry = info->next;
+    }
+
+    return true;
+}
+
+static int compare_indices(const void *const left, const void *const right) {
+    const uint32_t left_index = *(const uint32_t *)left;
+    const uint32_t right_index = *(const uint32_t *)right;
+
+    if (left_index > right_index) {
+        return 1;
+    } else if (left_index < right_index) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Sort the filter-candidates, and remove any filter found more than once (such
+ * as a directory-filter whose directory appears twice in a path).
+ */
+
+static void sort_and_unique_indices(struct array *const candidates) {
+    uint32_t *const indices = candidates->data;
+    const uint64_t count = array_get_item_count(candidates, sizeof(uint32_t));
+
+    if (count < 2) {
+        return;
+    }
+
+    qsort(indices, count, sizeof(uint32_t), compare_indices);
+
+    uint64_t unique_count = 1;
+    for (uint64_t i = 1; i != count; i++) {
+        if (indices[i] == indices[unique_count - 1]) {
+            continue;
+        }
+
+        indices[unique_count] = indices[i];
+        unique_count++;
+    }
+
+    candidates->data_end = indices + unique_count;
+}
+
+static bool add_all_filters(struct dsc_image_cond_index *const index) {
+    struct array *const candidates = &index->filter_candidates;
+    candidates->data_end = candidates->data;
+
+    const uint32_t filters_count = index->filters_count;
+    for (uint32_t i = 0; i != filters_count; i++) {
+        if (!add_index(candidates, i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+dsc_image_cond_index_find_candidates(struct dsc_image_cond_index *const index,
+                                     const char *const path,
+                                     const uint64_t path_length)
+{
+    struct array *const filter_candidates = &index->filter_candidates;
+    struct array *const path_candidates = &index->path_candidates;
+
+    filter_candidates->data_end = filter_candidates->data;
+    path_candidates->data_end = path_candidates->data;
+
+    if (index->capacity == 0) {
+        return true;
+    }
+
+    if (!add_chain(index,
+                   path_candidates,
+                   DSC_IMAGE_COND_KIND_PATH,
+                   path,
+                   path_length))
+    {
+        return false;
+    }
+
+    /*
+     * Look up every path-component as a directory, and the last
+     * path-component as a filename.
+     */
+
+    const char *iter = path;
+    const char *const end = path + path_length;
+
+    const char *last_begin = NULL;
+    const char *last_end = NULL;
+
+    while (iter != end) {
+        if (*iter == '/') {
+            iter++;
+            continue;
+        }
+
+        const char *component_end = memchr(iter, '/', (size_t)(end - iter));
+        if (component_end == NULL) {
+            component_end = end;
+        }
+
+        if (!add_chain(index,
+                       filter_candidates,
+                       DSC_IMAGE_COND_KIND_DIRECTORY,
+                       iter,
+                       (uint64_t)(component_end - iter)))
+        {
+            return false;
+        }
+
+        last_begin = iter;
+        last_end = component_end;
+
+        iter = component_end;
+    }
+
+    /*
+     * path_has_filename() also matches a filename that is only a suffix of the
+     * path's first path-component, so all filters are checked for the rare
+     * path without a slash before its last path-component, or without any
+     * path-components at all.
+     */
+
+    if (last_begin == NULL || last_begin == path) {
+        return add_all_filters(index);
+    }
+
+    if (!add_chain(index,
+                   filter_candidates,
+                   DSC_IMAGE_COND_KIND_FILENAME,
+                   last_begin,
+                   (uint64_t)(last_end - last_begin)))
+    {
+        return false;
+    }
+
+    const uint32_t *unindexed = index->unindexed_filters.data;
+    const uint32_t *const unindexed_end = index->unindexed_filters.data_end;
+
+    for (; unindexed != unindexed_end; unindexed++) {
+        if (!add_index(filter_candidates, *unindexed)) {
+            return false;
+        }
+    }
+
+    sort_and_unique_indices(filter_candidates);
+    return true;
+}
+
+void dsc_image_cond_index_destroy(struct dsc_image_cond_index *const index) {
+    free(index->entries);
+    free(index->slots);
+
+    index->entries = NULL;
+    index->slots = NULL;
+    index->capacity = 0;
+
+    array_destroy(&index->unindexed_filters);
+    array_destroy(&index->filter_candidates);
+    array_destroy(&index->path_candidates);
+}
@@ -10,7 +10,11 @@
 #include <sys/stat.h>
 
 #include <errno.h>
+#include <fcntl.h>
 
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -32,6 +36,182 @@
 static const uint64_t dsc_magic_64 = 2319765435151317348;
 static const uint64_t dsc_magic_64_other = 7003509047616633188;
 
+static int
+mapping_range_comparator(const void *const array_item, const void *const item)
+{
+    const struct dyld_shared_cache_mapping_range *const array_range =
+        (const struct dyld_shared_cache_mapping_range *)array_item;
+
+    const struct dyld_shared_cache_mapping_range *const range =
+        (const struct dyld_shared_cache_mapping_range *)item;
+
+    if (array_range->begin > range->begin) {
+        return 1;
+    } else if (array_range->begin < range->begin) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Create the address-ranges of the mappings of every file, sorted by address,
+ * so addresses can be found with a binary search rather than by scanning every
+ * mapping.
+ *
+ * Mappings whose address-ranges are empty or overflow are left out, as they
+ * can't contain any address.
+ */
+
+static struct dyld_shared_cache_mapping_range *
+create_mapping_ranges(const struct dyld_shared_cache_file *const files,
+                      const uint32_t files_count,
+                      uint32_t *const count_out)
+{
+    uint64_t mappings_count = 0;
+    for (uint32_t i = 0; i != files_count; i++) {
+        mappings_count += files[i].mappings_count;
+    }
+
+    if (mappings_count > UINT32_MAX) {
+        return NULL;
+    }
+
+    /*
+     * calloc() may return NULL for a count of zero, so allocate at least one
+     * range.
+     */
+
+    const uint64_t alloc_count = (mappings_count != 0) ? mappings_count : 1;
+    struct dyld_shared_cache_mapping_range *const ranges =
+        calloc(alloc_count, sizeof(*ranges));
+
+    if (ranges == NULL) {
+        return NULL;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i != files_count; i++) {
+        const struct dyld_shared_cache_file *const file = files + i;
+        const struct dyld_cache_mapping_info *const mappings = file->mappings;
+
+        for (uint32_t j = 0; j != file->mappings_count; j++) {
+            const struct dyld_cache_mapping_info *const mapping = mappings + j;
+
+            const uint64_t begin = mapping->address;
+            uint64_t end = begin;
+
+            if (guard_overflow_add(&end, mapping->size)) {
+                continue;
+            }
+
+            if (begin == end) {
+                continue;
+            }
+
+            ranges[count] = (struct dyld_shared_cache_mapping_range){
+                .begin = begin,
+                .end = end,
+                .file_offset = mapping->fileOffset,
+                .file_index = i
+            };
+
+            count++;
+        }
+    }
+
+    qsort(ranges, count, sizeof(*ranges), mapping_range_comparator);
+
+    *count_out = count;
+    return ranges;
+}
+
+/*
+ * The read-only mappings of a dyld_shared_cache store the __LINKEDIT of every
+ * image, where their symbol-tables, string-tables and export-tries are found.
+ */
+
+static const uint32_t dsc_mapping_prot_read = 1;
+
+/*
+ * The size of the mach-header and load-commands read in for an image by
+ * dyld_shared_cache_prefetch_image(), which is enough for almost all images.
+ */
+
+static const uint64_t dsc_image_prefetch_size = 16384;
+
+static inline uint64_t get_page_size(void) {
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        return 4096;
+    }
+
+    return (uint64_t)page_size;
+}
+
+/*
+ * Advise the kernel on how the range [begin, end) of map is to be accessed,
+ * after aligning the range to pages.
+ *
+ * Advice is only a hint, and so any failure is ignored.
+ */
+
+static void
+advise_map_range(const uint8_t *const map,
+                 const uint64_t begin,
+                 const uint64_t end,
+                 const int advice)
+{
+    const uint64_t page_size = get_page_size();
+    const uint64_t aligned_begin = begin & ~(page_size - 1);
+
+    if (aligned_begin >= end) {
+        return;
+    }
+
+    madvise((void *)(map + aligned_begin), end - aligned_begin, advice);
+}
+
+static void
+advise_map(const uint8_t *const map,
+           const uint64_t size,
+           const struct dyld_cache_mapping_info *const mappings,
+           const uint32_t mappings_count,
+           const uint64_t options)
+{
+    if (options & O_DYLD_SHARED_CACHE_PARSE_ACCESS_RANDOM) {
+        advise_map_range(map, 0, size, MADV_RANDOM);
+    } else if (options & O_DYLD_SHARED_CACHE_PARSE_ACCESS_SEQUENTIAL) {
+        advise_map_range(map, 0, size, MADV_SEQUENTIAL);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if (options & O_DYLD_SHARED_CACHE_PARSE_HUGE_PAGES) {
+        advise_map_range(map, 0, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    if (!(options & O_DYLD_SHARED_CACHE_PARSE_PREFETCH)) {
+        return;
+    }
+
+    /*
+     * The mappings have already been verified to be within the file.
+     */
+
+    for (uint32_t i = 0; i != mappings_count; i++) {
+        const struct dyld_cache_mapping_info *const mapping = mappings + i;
+        if (mapping->initProt != dsc_mapping_prot_read) {
+            continue;
+        }
+
+        const uint64_t begin = mapping->fileOffset;
+        const uint64_t end = begin + mapping->size;
+
+        advise_map_range(map, begin, end, MADV_WILLNEED);
+    }
+}
+
 static int
 get_arch_info_from_magic(const char magic[16],
                          const struct arch_info **const arch_info_out,
@@ -189,158 +369,136 @@ get_arch_info_from_magic(const char magic[16],
     return 0;
 }
 
-enum dyld_shared_cache_parse_result
-dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *const info_in,
-                                  const int fd,
-                                  const char magic[16],
-                                  const uint64_t options)
-{
-    /*
-     * For performance, check magic and verify header first before mapping file
-     * to memory.
-     */
-
+const struct arch_info *
+dyld_shared_cache_get_arch_info_from_magic(const char magic[16]) {
     const struct arch_info *arch = NULL;
     uint64_t arch_bit = 0;
 
     if (get_arch_info_from_magic(magic, &arch, &arch_bit)) {
-        return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
+        return NULL;
     }
 
-    struct dyld_cache_header header = {};
-    if (read(fd, &header.mappingOffset, sizeof(header) - 16) < 0) {
-        if (errno == EOVERFLOW) {
-            return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
-        }
+    return arch;
+}
 
-        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
-    }
+/*
+ * The size of the headers of the oldest shared-caches, which end at
+ * dyldBaseAddress.
+ */
 
-    struct stat sbuf = {};
-    if (fstat(fd, &sbuf) < 0) {
-        return E_DYLD_SHARED_CACHE_PARSE_FSTAT_FAIL;
-    }
+static const uint64_t dsc_header_min_size =
+    offsetof(struct dyld_cache_header, codeSignatureOffset);
 
-    const uint64_t dsc_size = (uint64_t)sbuf.st_size;
-    const struct range no_main_header_range = {
-        .begin = sizeof(struct dyld_cache_header),
-        .end = dsc_size
-    };
+static bool
+pread_all(const int fd, void *const buffer, uint64_t size, uint64_t offset) {
+    uint8_t *iter = (uint8_t *)buffer;
+    while (size != 0) {
+        const ssize_t read_size = pread(fd, iter, size, (off_t)offset);
+        if (read_size <= 0) {
+            if (read_size < 0 && errno == EINTR) {
+                continue;
+            }
 
-    /*
-     * Perform basic validation of the image-array and mapping-infos array
-     * offsets.
-     *
-     * Note: Due to the ubiquity of shared-cache headers, and any lack of
-     * versioning, more stringent validation is not performed.
-     */
+            return false;
+        }
 
-    if (!range_contains_location(no_main_header_range, header.mappingOffset)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
+        iter += read_size;
+        size -= (uint64_t)read_size;
+        offset += (uint64_t)read_size;
     }
 
-    if (!range_contains_location(no_main_header_range, header.imagesOffset)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
-    }
+    return true;
+}
 
-    /*
-     * Validate that the mapping-infos array and images-array have no overflows.
-     */
+/*
+ * Clear the fields of header at or past its mapping-infos, which aren't part of
+ * the header, so that fields only newer shared-caches have are otherwise zero.
+ *
+ * The header's mapping-offset must have already been verified to be past the
+ * minimum header-size.
+ */
 
-    uint64_t mappings_size = sizeof(struct dyld_cache_mapping_info);
-    if (guard_overflow_mul(&mappings_size, header.mappingCount)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
+static void clear_absent_header_fields(struct dyld_cache_header *const header) {
+    const uint64_t mapping_offset = header->mappingOffset;
+    if (mapping_offset >= sizeof(*header)) {
+        return;
     }
 
-    uint64_t mapping_end = header.mappingOffset;
-    if (guard_overflow_add(&mapping_end, mappings_size)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
-    }
+    uint8_t *const absent_fields = (uint8_t *)header + mapping_offset;
+    memset(absent_fields, 0, sizeof(*header) - mapping_offset);
+}
 
+static void
+get_images_location(const struct dyld_cache_header *const header,
+                    uint32_t *const offset_out,
+                    uint32_t *const count_out)
+{
     /*
-     * Get the size of the image-infos table by multipying the images-count
-     * and the size of a image-info.
+     * Newer shared-caches store the location of their image-infos further in
+     * the header, leaving the older fields zero.
      */
 
-    uint64_t images_size = sizeof(struct dyld_cache_image_info);
-    if (guard_overflow_mul(&images_size, header.imagesCount)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    if (header->imagesOffsetOld != 0) {
+        *offset_out = header->imagesOffsetOld;
+        *count_out = header->imagesCountOld;
+    } else {
+        *offset_out = header->imagesOffset;
+        *count_out = header->imagesCount;
     }
+}
 
-    /*
-     * Verify that both the mapping-infos array and the images-array are
-     * completely within the cache-file.
-     */
-
-    uint64_t images_end = header.imagesOffset;
-    if (guard_overflow_add(&images_end, images_size)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
-    }
+/*
+ * Validate that the mapping-infos array of header is within no_header_range,
+ * returning the end of the mapping-infos array in mapping_end_out.
+ */
 
-    if (!range_contains_end(no_main_header_range, mapping_end)) {
+static enum dyld_shared_cache_parse_result
+validate_mappings_location(const struct dyld_cache_header *const header,
+                           const struct range no_header_range,
+                           uint64_t *const mapping_end_out)
+{
+    if (!range_contains_location(no_header_range, header->mappingOffset)) {
         return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
     }
 
-    if (!range_contains_end(no_main_header_range, images_end)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    uint64_t mappings_size = sizeof(struct dyld_cache_mapping_info);
+    if (guard_overflow_mul(&mappings_size, header->mappingCount)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
     }
 
-    /*
-     * Ensure that the total-size of the mappings and images can be quantified.
-     */
-
-    uint64_t total_infos_size = mappings_size;
-    if (guard_overflow_add(&total_infos_size, images_size)) {
-        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    uint64_t mapping_end = header->mappingOffset;
+    if (guard_overflow_add(&mapping_end, mappings_size)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
     }
 
-    /*
-     * Ensure that the mapping-infos array and images-array do not overlap.
-     */
-
-    const struct range mappings_range = {
-        .begin = header.mappingOffset,
-        .end = mapping_end
-    };
-
-    const struct range images_range = {
-        .begin = header.imagesOffset,
-        .end = images_end
-    };
-
-    if (ranges_overlap(mappings_range, images_range)) {
-        return E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_RANGES;
+    if (!range_contains_end(no_header_range, mapping_end)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
     }
 
-    /*
-     * After validating all our fields, we then finally map the
-     * dyld_shared_cache file to memory.
-     */
-
-    uint8_t *const map =
-        mmap(0, dsc_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
-
-    if (map == MAP_FAILED) {
-        return E_DYLD_SHARED_CACHE_PARSE_MMAP_FAIL;
-    }
+    *mapping_end_out = mapping_end;
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
 
-    const struct dyld_cache_mapping_info *const mappings =
-        (const struct dyld_cache_mapping_info *)(map + header.mappingOffset);
+/*
+ * Verify that every mapping is within a file of file_size, and that no mappings
+ * overlap.
+ */
 
+static enum dyld_shared_cache_parse_result
+validate_mappings(const struct dyld_cache_mapping_info *const mappings,
+                  const uint32_t mappings_count,
+                  const uint64_t file_size)
+{
     /*
      * Mappings are like mach-o segments, covering entire swaths of the file.
      */
 
-    const struct range full_cache_range = {
+    const struct range full_file_range = {
         .begin = 0,
-        .end = dsc_size
+        .end = file_size
     };
 
-    /*
-     * Verify we don't have any overlapping mappings.
-     */
-
-    for (uint32_t i = 0; i < header.mappingCount; i++) {
+    for (uint32_t i = 0; i < mappings_count; i++) {
         const struct dyld_cache_mapping_info *const mapping = mappings + i;
 
         /*
@@ -352,7 +510,6 @@ dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *const info_in,
         uint64_t mapping_file_end = mapping_file_begin;
 
         if (guard_overflow_add(&mapping_file_end, mapping->size)) {
-            munmap(map, dsc_size);
             return E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_MAPPINGS;
         }
 
@@ -361,8 +518,7 @@ dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *const info_in,
             .end = mapping_file_end
         };
 
-        if (!range_contains_range(full_cache_range, mapping_file_range)) {
-            munmap(map, dsc_size);
+        if (!range_contains_range(full_file_range, mapping_file_range)) {
             return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
         }
 
@@ -385,84 +541,536 @@ dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *const info_in,
                 .end = inner_file_end
             };
 
-            if (!ranges_overlap(mapping_file_range, inner_file_range)) {
-                continue;
+            if (ranges_overlap(mapping_file_range, inner_file_range)) {
+                return E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_MAPPINGS;
             }
-
-            munmap(map, dsc_size);
-            return E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_MAPPINGS;
         }
     }
 
-    /*
-     * Create an "available range" where other data structures may lie without
-     * overlapping with dyld_shared_cache file structures.
-     */
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
 
-    uint64_t available_range_start = images_end;
-    if (available_range_start < mapping_end) {
-        available_range_start = mapping_end;
-    }
+static inline int get_map_flags(const uint64_t options) {
+    int map_flags = MAP_PRIVATE;
 
-    const struct range available_range = {
-        .begin = available_range_start,
-        .end = dsc_size
-    };
+#if defined(MAP_POPULATE)
+    if (options & O_DYLD_SHARED_CACHE_PARSE_POPULATE) {
+        map_flags |= MAP_POPULATE;
+    }
+#else
+    (void)options;
+#endif
 
-    struct dyld_cache_image_info *const images =
-        (struct dyld_cache_image_info *)(map + header.imagesOffset);
+    return map_flags;
+}
 
-    /*
-     * Perform the image operations if need be.
-     *
-     * Since the images array is quite large (Usually >1000 images), we aim to
-     * do everything in only one loop.
-     */
+/*
+ * Open the subcache at path, reading in (but not mapping) its mapping-infos.
+ *
+ * A subcache must have the same magic as its main file, and the uuid listed
+ * for it by the main file.
+ */
 
-    if (options & O_DYLD_SHARED_CACHE_PARSE_ZERO_IMAGE_PADS) {
-        for (uint32_t i = 0; i < header.imagesCount; i++) {
-            struct dyld_cache_image_info *const image = images + i;
+static enum dyld_shared_cache_parse_result
+open_subcache(struct dyld_shared_cache_file *const file_out,
+              const char *const path,
+              const char magic[16],
+              const uint8_t uuid[16])
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return E_DYLD_SHARED_CACHE_PARSE_OPEN_SUBCACHE_FAIL;
+    }
 
-            if (options & O_DYLD_SHARED_CACHE_PARSE_VERIFY_IMAGE_PATH_OFFSETS) {
-                const uint32_t location = image->pathFileOffset;
-                if (range_contains_location(available_range, location)) {
-                    continue;
-                }
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_FSTAT_FAIL;
+    }
 
-                munmap(map, dsc_size);
-                return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
-            }
+    const uint64_t size = (uint64_t)sbuf.st_size;
+    if (size < dsc_header_min_size) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+    }
 
-            image->pad = 0;
-        }
-    } else if (options & O_DYLD_SHARED_CACHE_PARSE_VERIFY_IMAGE_PATH_OFFSETS) {
-        for (uint32_t i = 0; i < header.imagesCount; i++) {
-            struct dyld_cache_image_info *const image = images + i;
-            const uint32_t location = image->pathFileOffset;
+    struct dyld_cache_header header = {};
+    const uint64_t header_size =
+        (size < sizeof(header)) ? size : sizeof(header);
 
-            if (range_contains_location(available_range, location)) {
-                continue;
-            }
+    if (!pread_all(fd, &header, header_size, 0)) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
 
-            munmap(map, dsc_size);
-            return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
-        }
+    if (memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
     }
 
-    info_in->images = images;
-    info_in->images_count = header.imagesCount;
+    const struct range no_header_range = {
+        .begin = dsc_header_min_size,
+        .end = size
+    };
 
-    info_in->mappings = mappings;
-    info_in->mappings_count = header.mappingCount;
+    uint64_t mapping_end = 0;
+    const enum dyld_shared_cache_parse_result validate_location_result =
+        validate_mappings_location(&header, no_header_range, &mapping_end);
 
-    info_in->arch = arch;
-    info_in->arch_bit = arch_bit;
+    if (validate_location_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        close(fd);
+        return validate_location_result;
+    }
 
-    info_in->map = map;
-    info_in->size = dsc_size;
+    clear_absent_header_fields(&header);
+    if (memcmp(header.uuid, uuid, sizeof(header.uuid)) != 0) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+    }
 
-    info_in->available_range = available_range;
+    /*
+     * malloc() may return NULL for a size of zero, so allocate at least one
+     * mapping-info.
+     */
+
+    const uint64_t mappings_size = mapping_end - header.mappingOffset;
+    struct dyld_cache_mapping_info *const mappings =
+        malloc(mappings_size != 0 ? mappings_size : 1);
+
+    if (mappings == NULL) {
+        close(fd);
+        return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+    }
+
+    if (!pread_all(fd, mappings, mappings_size, header.mappingOffset)) {
+        free(mappings);
+        close(fd);
+
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
+
+    const enum dyld_shared_cache_parse_result validate_mappings_result =
+        validate_mappings(mappings, header.mappingCount, size);
+
+    if (validate_mappings_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        free(mappings);
+        close(fd);
+
+        return validate_mappings_result;
+    }
+
+    *file_out = (struct dyld_shared_cache_file){
+        .size = size,
+        .mappings = mappings,
+        .mappings_count = header.mappingCount,
+        .available_range = {
+            .begin = mapping_end,
+            .end = size
+        },
+        .fd = fd
+    };
+
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
+
+static void
+close_subcaches(struct dyld_shared_cache_file *const subcaches,
+                const uint32_t count)
+{
+    for (uint32_t i = 0; i != count; i++) {
+        struct dyld_shared_cache_file *const subcache = subcaches + i;
+        if (subcache->map != NULL) {
+            munmap((void *)subcache->map, subcache->size);
+        }
+
+        close(subcache->fd);
+        free((void *)subcache->mappings);
+    }
+}
+
+/*
+ * Verify that the subcache-entries array of header is within available_range,
+ * returning the size of each subcache-entry in entry_size_out.
+ *
+ * Shared-caches whose header ends at or before cacheSubType have
+ * subcache-entries without a file-suffix.
+ */
+
+static enum dyld_shared_cache_parse_result
+validate_subcache_entries(const struct dyld_cache_header *const header,
+                          const struct range available_range,
+                          uint64_t *const entry_size_out)
+{
+    const uint64_t sub_type_offset =
+        offsetof(struct dyld_cache_header, cacheSubType);
+
+    const bool has_suffixes = header->mappingOffset > sub_type_offset;
+    const uint64_t entry_size =
+        has_suffixes ?
+            sizeof(struct dyld_subcache_entry) :
+            sizeof(struct dyld_subcache_entry_v1);
+
+    uint64_t entries_size = entry_size;
+    if (guard_overflow_mul(&entries_size, header->subCacheArrayCount)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+    }
+
+    const uint64_t entries_begin = header->subCacheArrayOffset;
+    uint64_t entries_end = entries_begin;
+
+    if (guard_overflow_add(&entries_end, entries_size)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+    }
+
+    const struct range entries_range = {
+        .begin = entries_begin,
+        .end = entries_end
+    };
+
+    if (!range_contains_range(available_range, entries_range)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+    }
+
+    *entry_size_out = entry_size;
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
+
+/*
+ * Open every subcache of a split dyld_shared_cache, whose main file (at path)
+ * is mapped at map, storing them in subcaches_out.
+ *
+ * The subcache-entries must have already been verified with
+ * validate_subcache_entries().
+ *
+ * The subcache storing local symbols (with the suffix ".symbols") is not
+ * opened, as only exported symbols are ever parsed.
+ */
+
+static enum dyld_shared_cache_parse_result
+open_subcaches(struct dyld_shared_cache_file *const subcaches_out,
+               const uint8_t *const map,
+               const struct dyld_cache_header *const header,
+               const uint64_t entry_size,
+               const char *const path)
+{
+    const uint32_t count = header->subCacheArrayCount;
+    if (path == NULL) {
+        return E_DYLD_SHARED_CACHE_PARSE_OPEN_SUBCACHE_FAIL;
+    }
+
+    const bool has_suffixes = entry_size == sizeof(struct dyld_subcache_entry);
+
+    const uint64_t path_length = strlen(path);
+    const uint8_t *entry_iter = map + header->subCacheArrayOffset;
+
+    for (uint32_t i = 0; i != count; i++, entry_iter += entry_size) {
+        struct dyld_subcache_entry entry = {};
+        memcpy(&entry, entry_iter, entry_size);
+
+        char suffix[sizeof(entry.fileSuffix) + 1] = {};
+        if (has_suffixes) {
+            memcpy(suffix, entry.fileSuffix, sizeof(entry.fileSuffix));
+        } else {
+            snprintf(suffix, sizeof(suffix), ".%" PRIu32, i + 1);
+        }
+
+        /*
+         * Don't allow a suffix to lead to a file outside the main file's
+         * directory.
+         */
+
+        const uint64_t suffix_length = strlen(suffix);
+        if (suffix_length == 0 || memchr(suffix, '/', suffix_length) != NULL) {
+            close_subcaches(subcaches_out, i);
+            return E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES;
+        }
+
+        char *const subcache_path = malloc(path_length + suffix_length + 1);
+        if (subcache_path == NULL) {
+            close_subcaches(subcaches_out, i);
+            return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+        }
+
+        memcpy(subcache_path, path, path_length);
+        memcpy(subcache_path + path_length, suffix, suffix_length + 1);
+
+        const enum dyld_shared_cache_parse_result open_subcache_result =
+            open_subcache(subcaches_out + i,
+                          subcache_path,
+                          header->magic,
+                          entry.uuid);
+
+        free(subcache_path);
+
+        if (open_subcache_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+            close_subcaches(subcaches_out, i);
+            return open_subcache_result;
+        }
+    }
+
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
+
+enum dyld_shared_cache_parse_result
+dyld_shared_cache_parse_from_file(struct dyld_shared_cache_info *const info_in,
+                                  const int fd,
+                                  const char *const path,
+                                  const char magic[16],
+                                  const uint64_t options)
+{
+    /*
+     * For performance, check magic and verify header first before mapping file
+     * to memory.
+     */
+
+    const struct arch_info *arch = NULL;
+    uint64_t arch_bit = 0;
+
+    if (get_arch_info_from_magic(magic, &arch, &arch_bit)) {
+        return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
+    }
+
+    struct dyld_cache_header header = {};
+    if (read(fd, &header.mappingOffset, sizeof(header) - 16) < 0) {
+        if (errno == EOVERFLOW) {
+            return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
+        }
+
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
+
+    memcpy(header.magic, magic, sizeof(header.magic));
+
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        return E_DYLD_SHARED_CACHE_PARSE_FSTAT_FAIL;
+    }
+
+    const uint64_t dsc_size = (uint64_t)sbuf.st_size;
+    const struct range no_main_header_range = {
+        .begin = dsc_header_min_size,
+        .end = dsc_size
+    };
+
+    /*
+     * Perform basic validation of the image-array and mapping-infos array
+     * offsets.
+     *
+     * Note: Due to the ubiquity of shared-cache headers, and any lack of
+     * versioning, more stringent validation is not performed.
+     */
+
+    uint64_t mapping_end = 0;
+    const enum dyld_shared_cache_parse_result validate_location_result =
+        validate_mappings_location(&header, no_main_header_range, &mapping_end);
+
+    if (validate_location_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        return validate_location_result;
+    }
+
+    clear_absent_header_fields(&header);
+
+    uint32_t images_offset = 0;
+    uint32_t images_count = 0;
+
+    get_images_location(&header, &images_offset, &images_count);
+    if (!range_contains_location(no_main_header_range, images_offset)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    /*
+     * Get the size of the image-infos table by multipying the images-count
+     * and the size of a image-info.
+     */
+
+    uint64_t images_size = sizeof(struct dyld_cache_image_info);
+    if (guard_overflow_mul(&images_size, images_count)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    /*
+     * Verify that the images-array is completely within the cache-file.
+     */
+
+    uint64_t images_end = images_offset;
+    if (guard_overflow_add(&images_end, images_size)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    if (!range_contains_end(no_main_header_range, images_end)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    /*
+     * Ensure that the mapping-infos array and images-array do not overlap.
+     */
+
+    const struct range mappings_range = {
+        .begin = header.mappingOffset,
+        .end = mapping_end
+    };
+
+    const struct range images_range = {
+        .begin = images_offset,
+        .end = images_end
+    };
+
+    if (ranges_overlap(mappings_range, images_range)) {
+        return E_DYLD_SHARED_CACHE_PARSE_OVERLAPPING_RANGES;
+    }
+
+    /*
+     * After validating all our fields, we then finally map the
+     * dyld_shared_cache file to memory.
+     */
+
+    const int map_flags = get_map_flags(options);
+    uint8_t *const map = mmap(0, dsc_size, PROT_READ, map_flags, fd, 0);
+
+    if (map == MAP_FAILED) {
+        return E_DYLD_SHARED_CACHE_PARSE_MMAP_FAIL;
+    }
+
+    const struct dyld_cache_mapping_info *const mappings =
+        (const struct dyld_cache_mapping_info *)(map + header.mappingOffset);
+
+    const enum dyld_shared_cache_parse_result validate_mappings_result =
+        validate_mappings(mappings, header.mappingCount, dsc_size);
+
+    if (validate_mappings_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        munmap(map, dsc_size);
+        return validate_mappings_result;
+    }
+
+    /*
+     * Create an "available range" where other data structures may lie without
+     * overlapping with dyld_shared_cache file structures.
+     */
+
+    uint64_t available_range_start = images_end;
+    if (available_range_start < mapping_end) {
+        available_range_start = mapping_end;
+    }
+
+    const struct range available_range = {
+        .begin = available_range_start,
+        .end = dsc_size
+    };
+
+    const struct dyld_cache_image_info *const images =
+        (const struct dyld_cache_image_info *)(map + images_offset);
+
+    if (options & O_DYLD_SHARED_CACHE_PARSE_VERIFY_IMAGE_PATH_OFFSETS) {
+        for (uint32_t i = 0; i < images_count; i++) {
+            const struct dyld_cache_image_info *const image = images + i;
+            const uint32_t location = image->pathFileOffset;
+
+            if (range_contains_location(available_range, location)) {
+                continue;
+            }
+
+            munmap(map, dsc_size);
+            return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+        }
+    }
+
+    /*
+     * Validate the subcache-entries before allocating a file for each of them,
+     * as the count of subcaches is otherwise untrusted.
+     */
+
+    const uint32_t subcaches_count = header.subCacheArrayCount;
+    uint64_t subcache_entry_size = 0;
+
+    if (subcaches_count != 0) {
+        const enum dyld_shared_cache_parse_result validate_subcaches_result =
+            validate_subcache_entries(&header,
+                                      available_range,
+                                      &subcache_entry_size);
+
+        if (validate_subcaches_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+            munmap(map, dsc_size);
+            return validate_subcaches_result;
+        }
+    }
+
+    /*
+     * The main file is always the first file, followed by every subcache.
+     */
+
+    const uint64_t files_count = (uint64_t)subcaches_count + 1;
+
+    struct dyld_shared_cache_file *const files =
+        calloc(files_count, sizeof(struct dyld_shared_cache_file));
+
+    if (files == NULL) {
+        munmap(map, dsc_size);
+        return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+    }
+
+    files[0] = (struct dyld_shared_cache_file){
+        .map = map,
+        .size = dsc_size,
+        .mappings = mappings,
+        .mappings_count = header.mappingCount,
+        .available_range = available_range,
+        .fd = -1
+    };
+
+    if (subcaches_count != 0) {
+        const enum dyld_shared_cache_parse_result open_subcaches_result =
+            open_subcaches(files + 1,
+                           map,
+                           &header,
+                           subcache_entry_size,
+                           path);
+
+        if (open_subcaches_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+            free(files);
+            munmap(map, dsc_size);
+
+            return open_subcaches_result;
+        }
+    }
+
+    uint32_t mapping_ranges_count = 0;
+    struct dyld_shared_cache_mapping_range *const mapping_ranges =
+        create_mapping_ranges(files,
+                              (uint32_t)files_count,
+                              &mapping_ranges_count);
+
+    if (mapping_ranges == NULL) {
+        close_subcaches(files + 1, subcaches_count);
+        free(files);
+        munmap(map, dsc_size);
+
+        return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+    }
+
+    advise_map(map, dsc_size, mappings, header.mappingCount, options);
+
+    info_in->images = images;
+    info_in->images_count = images_count;
+
+    info_in->mappings = mappings;
+    info_in->mappings_count = header.mappingCount;
+
+    info_in->mapping_ranges = mapping_ranges;
+    info_in->mapping_ranges_count = mapping_ranges_count;
+    info_in->last_mapping_range = 0;
+
+    info_in->files = files;
+    info_in->files_count = (uint32_t)files_count;
+
+    info_in->arch = arch;
+    info_in->arch_bit = arch_bit;
+
+    info_in->map = map;
+    info_in->size = dsc_size;
+
+    info_in->available_range = available_range;
     info_in->flags |= F_DYLD_SHARED_CACHE_UNMAP_MAP;
+    info_in->options = options;
 
     return E_DYLD_SHARED_CACHE_PARSE_OK;
 }
@@ -477,7 +1085,7 @@ dyld_shared_cache_iterate_images_with_callback(
     const uint32_t images_count = info_in->images_count;
 
     for (uint32_t i = 0; i < images_count; i++) {
-        struct dyld_cache_image_info *const image = info_in->images + i;
+        const struct dyld_cache_image_info *const image = info_in->images + i;
 
         const uint32_t path_file_offset = image->pathFileOffset;
         const char *const path = (const char *)(map + path_file_offset);
@@ -490,11 +1098,387 @@ dyld_shared_cache_iterate_images_with_callback(
     }
 }
 
+static inline uint64_t
+get_file_offset_in_range(
+    struct dyld_shared_cache_info *const info,
+    const struct dyld_shared_cache_mapping_range *const range,
+    const uint64_t address,
+    struct dyld_shared_cache_file **const file_out,
+    uint64_t *const max_size_out)
+{
+    const uint64_t delta = address - range->begin;
+
+    *file_out = info->files + range->file_index;
+    *max_size_out = range->end - address;
+
+    return range->file_offset + delta;
+}
+
+uint64_t
+dyld_shared_cache_get_file_offset_from_address(
+    struct dyld_shared_cache_info *const info,
+    const uint64_t address,
+    struct dyld_shared_cache_file **const file_out,
+    uint64_t *const max_size_out)
+{
+    const struct dyld_shared_cache_mapping_range *const ranges =
+        info->mapping_ranges;
+
+    const uint32_t count = info->mapping_ranges_count;
+    if (count == 0) {
+        return 0;
+    }
+
+    /*
+     * Images are parsed in parallel, so last_mapping_range is only ever a hint,
+     * read and written without ordering.
+     */
+
+    const uint32_t last =
+        __atomic_load_n(&info->last_mapping_range, __ATOMIC_RELAXED);
+
+    if (last < count) {
+        const struct dyld_shared_cache_mapping_range *const range =
+            ranges + last;
+
+        if (address >= range->begin && address < range->end) {
+            return get_file_offset_in_range(info,
+                                            range,
+                                            address,
+                                            file_out,
+                                            max_size_out);
+        }
+    }
+
+    /*
+     * Find the last range beginning at or before address.
+     */
+
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (ranges[mid].begin <= address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == 0) {
+        return 0;
+    }
+
+    const uint32_t index = low - 1;
+    const struct dyld_shared_cache_mapping_range *const range = ranges + index;
+
+    if (address >= range->end) {
+        return 0;
+    }
+
+    __atomic_store_n(&info->last_mapping_range, index, __ATOMIC_RELAXED);
+    return get_file_offset_in_range(info,
+                                    range,
+                                    address,
+                                    file_out,
+                                    max_size_out);
+}
+
+const uint8_t *
+dyld_shared_cache_map_file(const struct dyld_shared_cache_info *const info,
+                           struct dyld_shared_cache_file *const file)
+{
+    const uint8_t *const map = __atomic_load_n(&file->map, __ATOMIC_ACQUIRE);
+    if (map != NULL) {
+        return map;
+    }
+
+    const uint64_t options = info->options;
+    const int map_flags = get_map_flags(options);
+
+    uint8_t *const new_map =
+        mmap(0, file->size, PROT_READ, map_flags, file->fd, 0);
+
+    if (new_map == MAP_FAILED) {
+        return NULL;
+    }
+
+    advise_map(new_map,
+               file->size,
+               file->mappings,
+               file->mappings_count,
+               options);
+
+    /*
+     * If another thread mapped file first, use its map instead.
+     */
+
+    const uint8_t *existing_map = NULL;
+    const bool stored_map =
+        __atomic_compare_exchange_n(&file->map,
+                                    &existing_map,
+                                    new_map,
+                                    false,
+                                    __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE);
+
+    if (!stored_map) {
+        munmap(new_map, file->size);
+        return existing_map;
+    }
+
+    return new_map;
+}
+
+void
+dyld_shared_cache_prefetch_image(
+    struct dyld_shared_cache_info *const info,
+    const struct dyld_cache_image_info *const image)
+{
+    if (!(info->options & O_DYLD_SHARED_CACHE_PARSE_PREFETCH)) {
+        return;
+    }
+
+    struct dyld_shared_cache_file *file = NULL;
+    uint64_t max_size = 0;
+
+    const uint64_t file_offset =
+        dyld_shared_cache_get_file_offset_from_address(info,
+                                                       image->address,
+                                                       &file,
+                                                       &max_size);
+
+    if (file_offset == 0) {
+        return;
+    }
+
+    /*
+     * The image is about to be parsed, so its subcache is mapped now if it
+     * hasn't been already.
+     */
+
+    const uint8_t *const map = dyld_shared_cache_map_file(info, file);
+    if (map == NULL) {
+        return;
+    }
+
+    uint64_t size = dsc_image_prefetch_size;
+    if (size > max_size) {
+        size = max_size;
+    }
+
+    advise_map_range(map, file_offset, file_offset + size, MADV_WILLNEED);
+}
+
+/*
+ * The largest range of the file read to find every image's path. Image-paths
+ * are normally stored together right after the image-infos.
+ */
+
+static const uint64_t dsc_image_list_max_paths_size = 64 * 1024 * 1024;
+
+/*
+ * The maximum length of an image's path (including its terminator), as read
+ * past the last image-path's offset.
+ */
+
+static const uint64_t dsc_image_list_max_path_size = 4096;
+
+enum dyld_shared_cache_parse_result
+dyld_shared_cache_read_image_list(
+    struct dyld_shared_cache_image_list *const list_out,
+    const int fd)
+{
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        return E_DYLD_SHARED_CACHE_PARSE_FSTAT_FAIL;
+    }
+
+    const uint64_t dsc_size = (uint64_t)sbuf.st_size;
+    if (dsc_size < dsc_header_min_size) {
+        return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
+    }
+
+    struct dyld_cache_header header = {};
+    const uint64_t header_size =
+        (dsc_size < sizeof(header)) ? dsc_size : sizeof(header);
+
+    if (!pread_all(fd, &header, header_size, 0)) {
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
+
+    const struct arch_info *arch = NULL;
+    uint64_t arch_bit = 0;
+
+    if (get_arch_info_from_magic(header.magic, &arch, &arch_bit)) {
+        return E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE;
+    }
+
+    /*
+     * Perform the same validation of the images-array as
+     * dyld_shared_cache_parse_from_file().
+     */
+
+    const struct range no_main_header_range = {
+        .begin = dsc_header_min_size,
+        .end = dsc_size
+    };
+
+    if (!range_contains_location(no_main_header_range, header.mappingOffset)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_MAPPINGS;
+    }
+
+    clear_absent_header_fields(&header);
+
+    uint32_t images_offset = 0;
+    uint32_t images_count = 0;
+
+    get_images_location(&header, &images_offset, &images_count);
+    if (!range_contains_location(no_main_header_range, images_offset)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    uint64_t images_size = sizeof(struct dyld_cache_image_info);
+    if (guard_overflow_mul(&images_size, images_count)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    uint64_t images_end = images_offset;
+    if (guard_overflow_add(&images_end, images_size)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    if (!range_contains_end(no_main_header_range, images_end)) {
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    struct dyld_shared_cache_image_list list = {
+        .images_count = images_count
+    };
+
+    /*
+     * malloc() may return NULL for a size of zero, so allocate at least one
+     * image-info.
+     */
+
+    list.images = malloc(images_size != 0 ? images_size : 1);
+    if (list.images == NULL) {
+        return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+    }
+
+    if (!pread_all(fd, list.images, images_size, images_offset)) {
+        free(list.images);
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
+
+    /*
+     * Read every image's path with a single read of the range of the file from
+     * the first path to (at most) the maximum path-size past the last path.
+     */
+
+    uint64_t paths_begin = dsc_size;
+    uint64_t paths_last = 0;
+
+    for (uint32_t i = 0; i != list.images_count; i++) {
+        const uint64_t location = list.images[i].pathFileOffset;
+        if (!range_contains_location(no_main_header_range, location)) {
+            free(list.images);
+            return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+        }
+
+        if (location < paths_begin) {
+            paths_begin = location;
+        }
+
+        if (location > paths_last) {
+            paths_last = location;
+        }
+    }
+
+    if (list.images_count == 0) {
+        *list_out = list;
+        return E_DYLD_SHARED_CACHE_PARSE_OK;
+    }
+
+    uint64_t paths_end = dsc_size;
+    if (dsc_size - paths_last > dsc_image_list_max_path_size) {
+        paths_end = paths_last + dsc_image_list_max_path_size;
+    }
+
+    const uint64_t paths_size = paths_end - paths_begin;
+    if (paths_size > dsc_image_list_max_paths_size) {
+        free(list.images);
+        return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+    }
+
+    list.paths = malloc(paths_size);
+    list.paths_offset = paths_begin;
+    list.paths_size = paths_size;
+
+    if (list.paths == NULL) {
+        free(list.images);
+        return E_DYLD_SHARED_CACHE_PARSE_ALLOC_FAIL;
+    }
+
+    if (!pread_all(fd, list.paths, paths_size, paths_begin)) {
+        dyld_shared_cache_image_list_destroy(&list);
+        return E_DYLD_SHARED_CACHE_PARSE_READ_FAIL;
+    }
+
+    /*
+     * Verify every path is terminated within the range read.
+     */
+
+    for (uint32_t i = 0; i != list.images_count; i++) {
+        const uint64_t path_offset =
+            list.images[i].pathFileOffset - paths_begin;
+
+        const char *const path = list.paths + path_offset;
+        if (memchr(path, '\0', paths_size - path_offset) == NULL) {
+            dyld_shared_cache_image_list_destroy(&list);
+            return E_DYLD_SHARED_CACHE_PARSE_INVALID_IMAGES;
+        }
+    }
+
+    *list_out = list;
+    return E_DYLD_SHARED_CACHE_PARSE_OK;
+}
+
+void
+dyld_shared_cache_image_list_destroy(
+    struct dyld_shared_cache_image_list *const list)
+{
+    free(list->images);
+    free(list->paths);
+
+    list->images = NULL;
+    list->images_count = 0;
+
+    list->paths = NULL;
+    list->paths_offset = 0;
+    list->paths_size = 0;
+}
+
 void dyld_shared_cache_info_destroy(struct dyld_shared_cache_info *const info) {
     if (info->flags & F_DYLD_SHARED_CACHE_UNMAP_MAP) {
-        munmap(info->map, info->size);
+        munmap((void *)info->map, info->size);
+    }
+
+    if (info->files != NULL) {
+        close_subcaches(info->files + 1, info->files_count - 1);
+        free(info->files);
     }
 
+    free(info->mapping_ranges);
+
+    info->files = NULL;
+    info->files_count = 0;
+
+    info->mapping_ranges = NULL;
+    info->mapping_ranges_count = 0;
+    info->last_mapping_range = 0;
+
     info->map = NULL;
     info->size = 0;
 
@@ -503,4 +1487,5 @@ void dyld_shared_cache_info_destroy(struct dyld_shared_cache_info *const info) {
 
     info->arch = NULL;
     info->arch_bit = 0;
+    info->options = 0;
 }
@@ -173,6 +173,38 @@ handle_dsc_file_parse_result(
 
             break;
         }
+
+        case E_DYLD_SHARED_CACHE_PARSE_OPEN_SUBCACHE_FAIL: {
+            if (print_paths) {
+                fprintf(stderr,
+                        "Failed to open a subcache of dyld_shared_cache file "
+                        "(at path %s), error: %s\n",
+                        path,
+                        strerror(errno));
+            } else {
+                fprintf(stderr,
+                        "Failed to open a subcache of the provided "
+                        "dyld_shared_cache file, error: %s\n",
+                        strerror(errno));
+            }
+
+            break;
+        }
+
+        case E_DYLD_SHARED_CACHE_PARSE_INVALID_SUBCACHES: {
+            if (print_paths) {
+                fprintf(stderr,
+                        "dyld_shared_cache file (at path %s) has invalid "
+                        "subcaches\n",
+                        path);
+            } else {
+                fputs("dyld_shared_cache file at the provided path has invalid "
+                      "subcaches\n",
+                      stderr);
+            }
+
+            break;
+        }
     }
 }
 
@@ -456,6 +488,14 @@ print_dsc_image_parse_error(const struct tbd_for_main *const tbd,
 
             break;
 
+        case E_DSC_IMAGE_PARSE_MMAP_FAIL:
+            fprintf(stderr,
+                    "Image (with path %s) could not be parsed as the subcache "
+                    "storing it could not be mapped\n",
+                    image_path);
+
+            break;
+
         case E_DSC_IMAGE_PARSE_FAT_NOT_SUPPORTED:
             fprintf(stderr,
                     "Image (with path %s) is an unsupported mach-o fat image\n",
@@ -547,6 +587,13 @@ print_dsc_image_parse_error(const struct tbd_for_main *const tbd,
 
             break;
 
+        case E_DSC_IMAGE_PARSE_INVALID_EXPORT_TRIE:
+            fprintf(stderr,
+                    "Image (with path %s) has an invalid export-trie\n",
+                    image_path);
+
+            break;
+
         case E_DSC_IMAGE_PARSE_INVALID_REEXPORT:
             fprintf(stderr,
                     "Image (with path %s) has an invalid re-export\n",
@@ -613,6 +660,14 @@ print_dsc_image_parse_error(const struct tbd_for_main *const tbd,
             break;
         }
 
+        case E_DSC_IMAGE_PARSE_CONFLICTING_INFO:
+            fprintf(stderr,
+                    "Image (with path %s) has information conflicting with the "
+                    "same image in another dyld_shared_cache\n",
+                    image_path);
+
+            break;
+
         default:
             break;
     }
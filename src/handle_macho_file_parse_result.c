@@ -457,6 +457,20 @@ handle_macho_file_parse_result(uint64_t *const info_in,
 
             return false;
 
+        case E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE:
+            if (print_paths) {
+                fprintf(stderr,
+                        "Mach-o file (at path %s), or one of its "
+                        "architectures, has an invalid export-trie\n",
+                        path);
+            } else {
+                fputs("The provided mach-o file, or one of its architectures, "
+                      "has an invalid export-trie\n",
+                      stderr);
+            }
+
+            return false;
+
         case E_MACHO_FILE_PARSE_INVALID_SYMBOL_TABLE:
             if (print_paths) {
                 fprintf(stderr,
@@ -6,6 +6,7 @@
 //  Copyright © 2018 - 2019 inoahdev. All rights reserved.
 //
 
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -17,24 +18,229 @@
 #include <unistd.h>
 
 #include "mach-o/fat.h"
+#include "mach-o/nlist.h"
 
 #include "guard_overflow.h"
 #include "range.h"
 
 #include "macho_file.h"
 #include "macho_file_parse_load_commands.h"
+#include "macho_file_parse_symbols.h"
 
 #include "swap.h"
+#include "unused.h"
+#include "worker_pool.h"
+
+/*
+ * The symbol-table of a slice of a mapped fat mach-o, stored to be compared
+ * against the symbol-tables of later slices.
+ *
+ * When slices are parsed in parallel, the symbol-table is parsed on a separate
+ * worker, into the slice's own create-info, after the load-commands of every
+ * slice have been parsed.
+ */
+
+struct fat_slice {
+    const uint8_t *macho;
+    struct range available_range;
+
+    uint64_t arch_bit;
+
+    bool is_64;
+    bool is_big_endian;
+
+    struct symtab_command symtab;
+    struct linkedit_data_command export_trie;
+
+    uint64_t tbd_options;
+    uint64_t options;
+
+    /*
+     * The index (plus one) of an earlier slice with an identical symbol-table,
+     * whose exports are shared with this slice, or zero.
+     */
+
+    uint32_t same_as;
+
+    struct tbd_create_info info;
+    enum macho_file_parse_result result;
+};
+
+static enum macho_file_parse_result
+parse_thin_map_symbols(struct tbd_create_info *const info_in,
+                       const uint8_t *const macho,
+                       const struct range available_range,
+                       const uint64_t arch_bit,
+                       const bool is_64,
+                       const bool is_big_endian,
+                       const struct symtab_command symtab,
+                       const struct linkedit_data_command export_trie,
+                       const uint64_t tbd_options,
+                       const uint64_t options)
+{
+    const struct mf_parse_exports_info exports_info = {
+        .map = macho,
+
+        .available_range = available_range,
+        .arch_bit = arch_bit,
+
+        .is_64 = is_64,
+        .is_big_endian = is_big_endian,
+
+        .symtab = symtab,
+        .export_trie = export_trie,
+
+        .tbd_options = tbd_options,
+        .options = options
+    };
+
+    return macho_file_parse_exports(info_in, &exports_info);
+}
+
+/*
+ * Parse the load-commands and symbol-table of a mach-o in a mapped file, with
+ * the same checks performed by macho_file_parse_load_commands_from_file().
+ *
+ * The symbol-table, string-table, and section offsets of a mach-o are relative
+ * to the mach-o's header, so the mach-o itself is provided as the map.
+ *
+ * If slice is not NULL, the symbol-table is instead stored in slice to be
+ * parsed later.
+ */
+
+static enum macho_file_parse_result
+parse_thin_map(struct tbd_create_info *const info_in,
+               const uint8_t *const macho,
+               const uint64_t size,
+               const struct arch_info *const arch,
+               const uint64_t arch_bit,
+               const bool is_64,
+               const bool is_big_endian,
+               const struct mach_header header,
+               const uint64_t tbd_options,
+               const uint64_t options,
+               struct fat_slice *const slice)
+{
+    uint32_t headers_size = sizeof(struct mach_header);
+    if (is_64) {
+        headers_size += sizeof(uint32_t);
+    }
+
+    const struct range available_range = {
+        .begin = headers_size,
+        .end = size
+    };
+
+    /*
+     * Strings in the map have to be copied, as the map is unmapped after
+     * parsing.
+     */
+
+    const uint64_t lc_options =
+        O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP |
+        O_MACHO_FILE_PARSE_DONT_PARSE_SYMBOL_TABLE |
+        options;
+
+    const struct mf_parse_load_commands_from_map_info info = {
+        .map = macho,
+        .map_size = size,
+
+        .macho = macho,
+        .macho_size = size,
+
+        .arch = arch,
+        .arch_bit = arch_bit,
+
+        .available_map_range = available_range,
+
+        .is_64 = is_64,
+        .is_big_endian = is_big_endian,
+
+        .ncmds = header.ncmds,
+        .sizeofcmds = header.sizeofcmds,
+
+        .tbd_options = tbd_options,
+        .options = lc_options
+    };
+
+    struct symtab_command symtab = {};
+    struct linkedit_data_command export_trie = {};
+
+    const enum macho_file_parse_result parse_load_commands_result =
+        macho_file_parse_load_commands_from_map(info_in,
+                                                &info,
+                                                &symtab,
+                                                &export_trie);
+
+    if (parse_load_commands_result != E_MACHO_FILE_PARSE_OK) {
+        return parse_load_commands_result;
+    }
+
+    if (!(tbd_options & O_TBD_PARSE_IGNORE_PLATFORM)) {
+        if (info_in->platform == 0) {
+            return E_MACHO_FILE_PARSE_NO_PLATFORM;
+        }
+    }
+
+    if (symtab.cmd != LC_SYMTAB) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    if (options & O_MACHO_FILE_PARSE_DONT_PARSE_SYMBOL_TABLE) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    /*
+     * A slice's symbols are borrowed from the map when parsed in parallel, as
+     * they are copied into info_in once every slice is merged.
+     */
+
+    if (slice != NULL) {
+        slice->macho = macho;
+        slice->available_range = available_range;
+        slice->arch_bit = arch_bit;
+        slice->is_64 = is_64;
+        slice->is_big_endian = is_big_endian;
+        slice->symtab = symtab;
+        slice->export_trie = export_trie;
+        slice->tbd_options = tbd_options;
+        slice->options =
+            lc_options & ~(uint64_t)O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
+
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    return parse_thin_map_symbols(info_in,
+                                  macho,
+                                  available_range,
+                                  arch_bit,
+                                  is_64,
+                                  is_big_endian,
+                                  symtab,
+                                  export_trie,
+                                  tbd_options,
+                                  lc_options);
+}
+
+/*
+ * map is the full file mapped to memory, or NULL if the file could not be
+ * mapped, in which case the mach-o is read from fd.
+ *
+ * slice is only provided with a map, for the slice's symbol-table to be parsed
+ * later.
+ */
 
 static enum macho_file_parse_result
 parse_thin_file(struct tbd_create_info *const info_in,
                 const int fd,
+                const uint8_t *const map,
                 const struct mach_header header,
                 const bool is_big_endian,
                 const uint64_t start,
                 const uint64_t size,
                 const uint64_t tbd_options,
-                const uint64_t options)
+                const uint64_t options,
+                struct fat_slice *const slice)
 {
     const bool is_64 =
         header.magic == MH_MAGIC_64 || header.magic == MH_CIGAM_64;
@@ -49,8 +255,10 @@ parse_thin_file(struct tbd_create_info *const info_in,
          * which only differs by having an extra uint32_t field at the end.
          */
 
-        if (lseek(fd, sizeof(uint32_t), SEEK_CUR) < 0) {
-            return E_MACHO_FILE_PARSE_SEEK_FAIL;
+        if (map == NULL) {
+            if (lseek(fd, sizeof(uint32_t), SEEK_CUR) < 0) {
+                return E_MACHO_FILE_PARSE_SEEK_FAIL;
+            }
         }
     } else {
         if (!is_big_endian && header.magic != MH_MAGIC) {
@@ -98,6 +306,20 @@ parse_thin_file(struct tbd_create_info *const info_in,
 
     info_in->archs |= arch_bit;
 
+    if (map != NULL) {
+        return parse_thin_map(info_in,
+                              map + start,
+                              size,
+                              arch,
+                              arch_bit,
+                              is_64,
+                              is_big_endian,
+                              header,
+                              tbd_options,
+                              options,
+                              slice);
+    }
+
     struct mf_parse_load_commands_from_file_info info = {
         .fd = fd,
 
@@ -126,7 +348,7 @@ parse_thin_file(struct tbd_create_info *const info_in,
     info.available_range.end = info.full_range.end;
 
     const enum macho_file_parse_result parse_load_commands_result =
-        macho_file_parse_load_commands_from_file(info_in, &info, NULL);
+        macho_file_parse_load_commands_from_file(info_in, &info, NULL, NULL);
 
     if (parse_load_commands_result != E_MACHO_FILE_PARSE_OK) {
         return parse_load_commands_result;
@@ -139,13 +361,416 @@ static inline bool thin_magic_is_valid(const uint32_t magic) {
     return magic == MH_MAGIC || magic == MH_MAGIC_64;
 }
 
+static void
+parse_fat_slice_job(const uint64_t index,
+                    __unused const uint32_t worker,
+                    void *const item)
+{
+    struct fat_slice *const slice = (struct fat_slice *)item + index;
+    if (slice->symtab.cmd != LC_SYMTAB || slice->same_as != 0) {
+        return;
+    }
+
+    struct tbd_create_info *const info = &slice->info;
+    const enum macho_file_parse_result parse_symbols_result =
+        parse_thin_map_symbols(info,
+                               slice->macho,
+                               slice->available_range,
+                               slice->arch_bit,
+                               slice->is_64,
+                               slice->is_big_endian,
+                               slice->symtab,
+                               slice->export_trie,
+                               slice->tbd_options,
+                               slice->options);
+
+    if (parse_symbols_result != E_MACHO_FILE_PARSE_OK) {
+        slice->result = parse_symbols_result;
+        return;
+    }
+
+    /*
+     * Every export of a slice has the same arch, so the exports are sorted by
+     * only their type and string, as needed to be merged.
+     */
+
+    if (tbd_create_info_sort_exports(info) != E_ARRAY_OK) {
+        slice->result = E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
+}
+
+/*
+ * Add arch_bit to every export parsed from a symbol-table (rather than from a
+ * load-command) that has the arch of identical_bit.
+ */
+
+static void
+add_arch_to_symbol_exports(struct tbd_create_info *const info,
+                           const uint64_t identical_bit,
+                           const uint64_t arch_bit)
+{
+    struct tbd_export_info *export_info = info->exports.data;
+    const struct tbd_export_info *const end = info->exports.data_end;
+
+    for (; export_info != end; export_info++) {
+        const uint64_t archs = export_info->archs;
+        if (!(archs & identical_bit) || (archs & arch_bit)) {
+            continue;
+        }
+
+        const enum tbd_export_type type = export_info->type;
+        if (type == TBD_EXPORT_TYPE_CLIENT ||
+            type == TBD_EXPORT_TYPE_REEXPORT)
+        {
+            continue;
+        }
+
+        export_info->archs = archs | arch_bit;
+        export_info->archs_count += 1;
+    }
+}
+
+static enum macho_file_parse_result
+merge_fat_slices(struct tbd_create_info *const info_in,
+                 struct fat_slice *const slices,
+                 const uint32_t count)
+{
+    const struct array **const exports_list =
+        calloc(count, sizeof(struct array *));
+
+    if (exports_list == NULL) {
+        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    }
+
+    uint32_t exports_count = 0;
+    for (uint32_t i = 0; i != count; i++) {
+        const struct fat_slice *const slice = slices + i;
+        if (slice->same_as == 0) {
+            exports_list[exports_count] = &slice->info.exports;
+            exports_count++;
+
+            continue;
+        }
+
+        struct fat_slice *const identical = slices + (slice->same_as - 1);
+        add_arch_to_symbol_exports(&identical->info,
+                                   identical->arch_bit,
+                                   slice->arch_bit);
+    }
+
+    const enum array_result merge_exports_result =
+        tbd_create_info_merge_exports(info_in, exports_list, exports_count);
+
+    free(exports_list);
+
+    if (merge_exports_result != E_ARRAY_OK) {
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
+
+    return E_MACHO_FILE_PARSE_OK;
+}
+
+/*
+ * Parse the symbol-tables of slices with up to jobs workers, and merge the
+ * exports of every slice into info_in, before freeing slices.
+ *
+ * The first error of a slice, in the order of the slices, is returned, as if
+ * the slices were parsed one after another.
+ */
+
+static enum macho_file_parse_result
+parse_fat_slices(struct tbd_create_info *const info_in,
+                 struct fat_slice *const slices,
+                 const uint32_t count,
+                 const uint32_t jobs)
+{
+    const uint32_t workers_count = (jobs < count) ? jobs : count;
+    worker_pool_run(workers_count, count, slices, parse_fat_slice_job);
+
+    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
+    for (uint32_t i = 0; i != count; i++) {
+        ret = slices[i].result;
+        if (ret != E_MACHO_FILE_PARSE_OK) {
+            break;
+        }
+    }
+
+    if (ret == E_MACHO_FILE_PARSE_OK && count != 0) {
+        ret = merge_fat_slices(info_in, slices, count);
+    }
+
+    for (uint32_t i = 0; i != count; i++) {
+        tbd_create_info_destroy_storage(&slices[i].info);
+    }
+
+    free(slices);
+    return ret;
+}
+
+/*
+ * The symbol-tables of the slices of a mapped fat mach-o are kept to find
+ * slices with identical symbol-tables, as long as there's more than one slice.
+ *
+ * If the slices can't be allocated, every slice is simply parsed separately.
+ */
+
+static struct fat_slice *
+create_fat_slices(const uint8_t *const map, const uint32_t nfat_arch) {
+    if (map == NULL || nfat_arch < 2) {
+        return NULL;
+    }
+
+    return calloc(nfat_arch, sizeof(struct fat_slice));
+}
+
+static bool
+slice_has_range(const struct fat_slice *const slice,
+                const uint64_t offset,
+                const uint64_t size)
+{
+    const struct range range = {
+        .begin = offset,
+        .end = offset + size
+    };
+
+    return range_contains_range(slice->available_range, range);
+}
+
+/*
+ * Compare size bytes at offset in both slices, if both slices contain them.
+ */
+
+static bool
+slice_ranges_are_identical(const struct fat_slice *const slice,
+                           const struct fat_slice *const other,
+                           const uint64_t offset,
+                           const uint64_t other_offset,
+                           const uint64_t size)
+{
+    if (!slice_has_range(slice, offset, size)) {
+        return false;
+    }
+
+    if (!slice_has_range(other, other_offset, size)) {
+        return false;
+    }
+
+    const uint8_t *const data = slice->macho + offset;
+    const uint8_t *const other_data = other->macho + other_offset;
+
+    return memcmp(data, other_data, size) == 0;
+}
+
+/*
+ * Whether the exports parsed from slice's symbol-table (or export-trie) would
+ * be identical to those parsed from other's.
+ */
+
+static bool
+slice_symbols_are_identical(const struct fat_slice *const slice,
+                            const struct fat_slice *const other)
+{
+    if (slice->is_64 != other->is_64) {
+        return false;
+    }
+
+    if (slice->is_big_endian != other->is_big_endian) {
+        return false;
+    }
+
+    const bool use_export_trie =
+        slice->export_trie.cmd != 0 &&
+        macho_file_can_parse_export_trie(slice->tbd_options);
+
+    const bool other_uses_export_trie =
+        other->export_trie.cmd != 0 &&
+        macho_file_can_parse_export_trie(other->tbd_options);
+
+    if (use_export_trie != other_uses_export_trie) {
+        return false;
+    }
+
+    if (use_export_trie) {
+        const struct linkedit_data_command trie = slice->export_trie;
+        const struct linkedit_data_command other_trie = other->export_trie;
+
+        if (trie.datasize != other_trie.datasize) {
+            return false;
+        }
+
+        return slice_ranges_are_identical(slice,
+                                          other,
+                                          trie.dataoff,
+                                          other_trie.dataoff,
+                                          trie.datasize);
+    }
+
+    const struct symtab_command symtab = slice->symtab;
+    const struct symtab_command other_symtab = other->symtab;
+
+    if (symtab.nsyms != other_symtab.nsyms) {
+        return false;
+    }
+
+    if (symtab.strsize != other_symtab.strsize) {
+        return false;
+    }
+
+    uint64_t symbol_table_size = sizeof(struct nlist);
+    if (slice->is_64) {
+        symbol_table_size = sizeof(struct nlist_64);
+    }
+
+    symbol_table_size *= symtab.nsyms;
+    if (!slice_ranges_are_identical(slice,
+                                    other,
+                                    symtab.symoff,
+                                    other_symtab.symoff,
+                                    symbol_table_size))
+    {
+        return false;
+    }
+
+    return slice_ranges_are_identical(slice,
+                                      other,
+                                      symtab.stroff,
+                                      other_symtab.stroff,
+                                      symtab.strsize);
+}
+
+/*
+ * Find an earlier slice with a symbol-table identical to that of the slice at
+ * index, returning its index plus one, or zero if there's none.
+ */
+
+static uint32_t
+find_identical_slice(const struct fat_slice *const slices,
+                     const uint32_t index)
+{
+    const struct fat_slice *const slice = slices + index;
+    if (slice->symtab.cmd != LC_SYMTAB) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i != index; i++) {
+        const struct fat_slice *const other = slices + i;
+        if (other->symtab.cmd != LC_SYMTAB || other->same_as != 0) {
+            continue;
+        }
+
+        if (slice_symbols_are_identical(slice, other)) {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Handle the symbol-table of the slice at index, which was just stored by
+ * parse_thin_file().
+ *
+ * A slice with a symbol-table identical to an earlier slice's isn't parsed,
+ * and instead shares the earlier slice's exports. Otherwise, unless slices are
+ * parsed in parallel, the symbol-table is parsed right away.
+ */
+
+static enum macho_file_parse_result
+handle_fat_slice(struct tbd_create_info *const info_in,
+                 struct fat_slice *const slices,
+                 const uint32_t index,
+                 const uint64_t options)
+{
+    struct fat_slice *const slice = slices + index;
+    if (slice->symtab.cmd != LC_SYMTAB) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    const uint32_t same_as = find_identical_slice(slices, index);
+    slice->same_as = same_as;
+
+    if (options & O_MACHO_FILE_PARSE_SLICES_IN_PARALLEL) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    if (same_as != 0) {
+        const struct fat_slice *const identical = slices + (same_as - 1);
+        add_arch_to_symbol_exports(info_in,
+                                   identical->arch_bit,
+                                   slice->arch_bit);
+
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    const uint64_t symbols_options =
+        slice->options | O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
+
+    return parse_thin_map_symbols(info_in,
+                                  slice->macho,
+                                  slice->available_range,
+                                  slice->arch_bit,
+                                  slice->is_64,
+                                  slice->is_big_endian,
+                                  slice->symtab,
+                                  slice->export_trie,
+                                  slice->tbd_options,
+                                  symbols_options);
+}
+
+/*
+ * Finish parsing slices, parsing their symbol-tables if parsed in parallel,
+ * before freeing slices.
+ */
+
+static enum macho_file_parse_result
+finish_fat_slices(struct tbd_create_info *const info_in,
+                  struct fat_slice *const slices,
+                  const uint32_t count,
+                  const uint32_t jobs,
+                  const uint64_t options)
+{
+    if (options & O_MACHO_FILE_PARSE_SLICES_IN_PARALLEL) {
+        return parse_fat_slices(info_in, slices, count, jobs);
+    }
+
+    free(slices);
+    return E_MACHO_FILE_PARSE_OK;
+}
+
+/*
+ * Returns whether the architecture of cputype and cpusubtype is one of archs,
+ * where no archs selects every architecture.
+ */
+
+static bool
+arch_is_selected(const uint64_t archs,
+                 const cpu_type_t cputype,
+                 const cpu_subtype_t cpusubtype)
+{
+    if (archs == 0) {
+        return true;
+    }
+
+    const struct arch_info *const arch =
+        arch_info_for_cputype(cputype, cpusubtype);
+
+    if (arch == NULL) {
+        return false;
+    }
+
+    return arch_info_is_in_archs(arch, archs);
+}
+
 static enum macho_file_parse_result
 handle_fat_32_file(struct tbd_create_info *const info_in,
                    const int fd,
+                   const uint8_t *const map,
                    const bool is_big_endian,
                    const uint32_t nfat_arch,
                    const uint64_t start,
                    const uint64_t size,
+                   const uint64_t only_archs,
+                   const uint32_t jobs,
                    const uint64_t tbd_options,
                    const uint64_t options)
 {
@@ -172,7 +797,14 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_ALLOC_FAIL;
     }
 
-    if (read(fd, archs, archs_size) < 0) {
+    /*
+     * The arch-headers are still copied out of the map, as they're swapped in
+     * place.
+     */
+
+    if (map != NULL) {
+        memcpy(archs, map + start + sizeof(struct fat_header), archs_size);
+    } else if (read(fd, archs, archs_size) < 0) {
         free(archs);
         return E_MACHO_FILE_PARSE_READ_FAIL;
     }
@@ -350,20 +982,33 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
         }
     }
 
+    struct fat_slice *const slices = create_fat_slices(map, nfat_arch);
+
+    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
+    uint32_t slices_count = 0;
+
     bool parsed_one_arch = false;
     for (uint32_t i = 0; i < nfat_arch; i++) {
         const struct fat_arch arch = archs[i];
-        const off_t arch_offset = (off_t)(start + arch.offset);
-
-        if (lseek(fd, arch_offset, SEEK_SET) < 0) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_SEEK_FAIL;
+        if (!arch_is_selected(only_archs, arch.cputype, arch.cpusubtype)) {
+            continue;
         }
 
+        const off_t arch_offset = (off_t)(start + arch.offset);
+
         struct mach_header header = {};
-        if (read(fd, &header, sizeof(header)) < 0) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_READ_FAIL;
+        if (map != NULL) {
+            memcpy(&header, map + arch_offset, sizeof(header));
+        } else {
+            if (lseek(fd, arch_offset, SEEK_SET) < 0) {
+                ret = E_MACHO_FILE_PARSE_SEEK_FAIL;
+                break;
+            }
+
+            if (read(fd, &header, sizeof(header)) < 0) {
+                ret = E_MACHO_FILE_PARSE_READ_FAIL;
+                break;
+            }
         }
 
         /*
@@ -386,8 +1031,8 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
                 continue;
             }
 
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
         }
 
         /*
@@ -395,28 +1040,46 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
          */
 
         if (header.cputype != arch.cputype) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
         }
 
         if (header.cpusubtype != arch.cpusubtype) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
+        }
+
+        struct fat_slice *slice = NULL;
+        if (slices != NULL) {
+            slice = slices + slices_count;
         }
 
         const enum macho_file_parse_result handle_arch_result =
             parse_thin_file(info_in,
                             fd,
+                            map,
                             header,
                             arch_is_big_endian,
                             start + arch.offset,
                             arch.size,
                             tbd_options,
-                            options);
+                            options,
+                            slice);
 
         if (handle_arch_result != E_MACHO_FILE_PARSE_OK) {
-            free(archs);
-            return handle_arch_result;
+            ret = handle_arch_result;
+            break;
+        }
+
+        if (slices != NULL) {
+            const enum macho_file_parse_result handle_slice_result =
+                handle_fat_slice(info_in, slices, slices_count, options);
+
+            slices_count++;
+            if (handle_slice_result != E_MACHO_FILE_PARSE_OK) {
+                ret = handle_slice_result;
+                break;
+            }
         }
 
         parsed_one_arch = true;
@@ -424,6 +1087,28 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
 
     free(archs);
 
+    /*
+     * The symbol-tables of the slices before a failing slice are still parsed,
+     * as their errors would otherwise have been returned first.
+     */
+
+    if (slices != NULL) {
+        const enum macho_file_parse_result finish_slices_result =
+            finish_fat_slices(info_in,
+                              slices,
+                              slices_count,
+                              jobs,
+                              options);
+
+        if (finish_slices_result != E_MACHO_FILE_PARSE_OK) {
+            return finish_slices_result;
+        }
+    }
+
+    if (ret != E_MACHO_FILE_PARSE_OK) {
+        return ret;
+    }
+
     if (!parsed_one_arch) {
         return E_MACHO_FILE_PARSE_NO_VALID_ARCHITECTURES;
     }
@@ -434,10 +1119,13 @@ handle_fat_32_file(struct tbd_create_info *const info_in,
 static enum macho_file_parse_result
 handle_fat_64_file(struct tbd_create_info *const info_in,
                    const int fd,
+                   const uint8_t *const map,
                    const bool is_big_endian,
                    const uint32_t nfat_arch,
                    const uint64_t start,
                    const uint64_t size,
+                   const uint64_t only_archs,
+                   const uint32_t jobs,
                    const uint64_t tbd_options,
                    const uint64_t options)
 {
@@ -464,7 +1152,14 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_ALLOC_FAIL;
     }
 
-    if (read(fd, archs, archs_size) < 0) {
+    /*
+     * The arch-headers are still copied out of the map, as they're swapped in
+     * place.
+     */
+
+    if (map != NULL) {
+        memcpy(archs, map + start + sizeof(struct fat_header), archs_size);
+    } else if (read(fd, archs, archs_size) < 0) {
         free(archs);
         return E_MACHO_FILE_PARSE_READ_FAIL;
     }
@@ -660,20 +1355,33 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
         }
     }
 
+    struct fat_slice *const slices = create_fat_slices(map, nfat_arch);
+
+    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
+    uint32_t slices_count = 0;
+
     bool parsed_one_arch = false;
     for (uint32_t i = 0; i < nfat_arch; i++) {
         const struct fat_arch_64 arch = archs[i];
-        const off_t arch_offset = (off_t)(start + arch.offset);
-
-        if (lseek(fd, arch_offset, SEEK_SET) < 0) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_SEEK_FAIL;
+        if (!arch_is_selected(only_archs, arch.cputype, arch.cpusubtype)) {
+            continue;
         }
 
+        const off_t arch_offset = (off_t)(start + arch.offset);
+
         struct mach_header header = {};
-        if (read(fd, &header, sizeof(header)) < 0) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_READ_FAIL;
+        if (map != NULL) {
+            memcpy(&header, map + arch_offset, sizeof(header));
+        } else {
+            if (lseek(fd, arch_offset, SEEK_SET) < 0) {
+                ret = E_MACHO_FILE_PARSE_SEEK_FAIL;
+                break;
+            }
+
+            if (read(fd, &header, sizeof(header)) < 0) {
+                ret = E_MACHO_FILE_PARSE_READ_FAIL;
+                break;
+            }
         }
 
         /*
@@ -697,8 +1405,8 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
                 continue;
             }
 
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
         }
 
         /*
@@ -706,28 +1414,46 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
          */
 
         if (header.cputype != arch.cputype) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
         }
 
         if (header.cpusubtype != arch.cpusubtype) {
-            free(archs);
-            return E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            ret = E_MACHO_FILE_PARSE_INVALID_ARCHITECTURE;
+            break;
+        }
+
+        struct fat_slice *slice = NULL;
+        if (slices != NULL) {
+            slice = slices + slices_count;
         }
 
         const enum macho_file_parse_result handle_arch_result =
             parse_thin_file(info_in,
                             fd,
+                            map,
                             header,
                             arch_is_big_endian,
                             start + arch.offset,
                             arch.size,
                             tbd_options,
-                            options);
+                            options,
+                            slice);
 
         if (handle_arch_result != E_MACHO_FILE_PARSE_OK) {
-            free(archs);
-            return handle_arch_result;
+            ret = handle_arch_result;
+            break;
+        }
+
+        if (slices != NULL) {
+            const enum macho_file_parse_result handle_slice_result =
+                handle_fat_slice(info_in, slices, slices_count, options);
+
+            slices_count++;
+            if (handle_slice_result != E_MACHO_FILE_PARSE_OK) {
+                ret = handle_slice_result;
+                break;
+            }
         }
 
         parsed_one_arch = true;
@@ -735,6 +1461,28 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
 
     free(archs);
 
+    /*
+     * The symbol-tables of the slices before a failing slice are still parsed,
+     * as their errors would otherwise have been returned first.
+     */
+
+    if (slices != NULL) {
+        const enum macho_file_parse_result finish_slices_result =
+            finish_fat_slices(info_in,
+                              slices,
+                              slices_count,
+                              jobs,
+                              options);
+
+        if (finish_slices_result != E_MACHO_FILE_PARSE_OK) {
+            return finish_slices_result;
+        }
+    }
+
+    if (ret != E_MACHO_FILE_PARSE_OK) {
+        return ret;
+    }
+
     if (!parsed_one_arch) {
         return E_MACHO_FILE_PARSE_NO_VALID_ARCHITECTURES;
     }
@@ -742,10 +1490,40 @@ handle_fat_64_file(struct tbd_create_info *const info_in,
     return E_MACHO_FILE_PARSE_OK;
 }
 
+/*
+ * Map the file at fd to memory for parsing if possible.
+ *
+ * Files that aren't regular files (such as pipes, or stdin), or that are too
+ * small to hold a mach-o header, aren't mapped, and are instead read.
+ */
+
+static const uint8_t *
+map_file_if_possible(const int fd,
+                     const struct stat *const sbuf)
+{
+    if (!S_ISREG(sbuf->st_mode)) {
+        return NULL;
+    }
+
+    const uint64_t file_size = (uint64_t)sbuf->st_size;
+    if (file_size < sizeof(struct mach_header)) {
+        return NULL;
+    }
+
+    const uint8_t *const map = mmap(0, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    return map;
+}
+
 enum macho_file_parse_result
 macho_file_parse_from_file(struct tbd_create_info *const info_in,
                            const int fd,
                            const uint32_t magic,
+                           const uint64_t only_archs,
+                           const uint32_t jobs,
                            const uint64_t tbd_options,
                            const uint64_t options)
 {
@@ -753,10 +1531,28 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
         magic == FAT_MAGIC    || magic == FAT_CIGAM ||
         magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
 
+    const bool is_thin =
+        magic == MH_MAGIC    || magic == MH_CIGAM ||
+        magic == MH_MAGIC_64 || magic == MH_CIGAM_64;
+
+    if (!is_fat && !is_thin) {
+        return E_MACHO_FILE_PARSE_NOT_A_MACHO;
+    }
+
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        return E_MACHO_FILE_PARSE_FSTAT_FAIL;
+    }
+
+    const uint64_t file_size = (uint64_t)sbuf.st_size;
+    const uint8_t *const map = map_file_if_possible(fd, &sbuf);
+
     enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
     if (is_fat) {
         uint32_t nfat_arch = 0;
-        if (read(fd, &nfat_arch, sizeof(nfat_arch)) < 0) {
+        if (map != NULL) {
+            nfat_arch = ((const struct fat_header *)map)->nfat_arch;
+        } else if (read(fd, &nfat_arch, sizeof(nfat_arch)) < 0) {
             if (errno == EOVERFLOW) {
                 return E_MACHO_FILE_PARSE_NOT_A_MACHO;
             }
@@ -765,6 +1561,10 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
         }
 
         if (nfat_arch == 0) {
+            if (map != NULL) {
+                munmap((void *)map, file_size);
+            }
+
             return E_MACHO_FILE_PARSE_NO_ARCHITECTURES;
         }
 
@@ -773,46 +1573,42 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
             nfat_arch = swap_uint32(nfat_arch);
         }
 
-        struct stat sbuf = {};
-        if (fstat(fd, &sbuf) < 0) {
-            return E_MACHO_FILE_PARSE_FSTAT_FAIL;
-        }
-
         const bool is_64 = magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
-        const uint64_t file_size = (uint64_t)sbuf.st_size;
-
         if (is_64) {
             ret =
                 handle_fat_64_file(info_in,
                                    fd,
+                                   map,
                                    is_big_endian,
                                    nfat_arch,
                                    0,
                                    file_size,
+                                   only_archs,
+                                   jobs,
                                    tbd_options,
                                    options);
         } else {
             ret =
                 handle_fat_32_file(info_in,
                                    fd,
+                                   map,
                                    is_big_endian,
                                    nfat_arch,
                                    0,
                                    file_size,
+                                   only_archs,
+                                   jobs,
                                    tbd_options,
                                    options);
         }
     } else {
-        const bool is_thin =
-            magic == MH_MAGIC    || magic == MH_CIGAM ||
-            magic == MH_MAGIC_64 || magic == MH_CIGAM_64;
-
-        if (!is_thin) {
-            return E_MACHO_FILE_PARSE_NOT_A_MACHO;
-        }
-
         struct mach_header header = { .magic = magic };
-        if (read(fd, &header.cputype, sizeof(header) - sizeof(magic)) < 0) {
+        if (map != NULL) {
+            memcpy(&header, map, sizeof(header));
+        } else if (read(fd,
+                        &header.cputype,
+                        sizeof(header) - sizeof(magic)) < 0)
+        {
             if (errno == EOVERFLOW) {
                 return E_MACHO_FILE_PARSE_NOT_A_MACHO;
             }
@@ -820,13 +1616,8 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
             return E_MACHO_FILE_PARSE_READ_FAIL;
         }
 
-        struct stat sbuf = {};
-        if (fstat(fd, &sbuf) < 0) {
-            return E_MACHO_FILE_PARSE_FSTAT_FAIL;
-        }
-
-        const uint64_t file_size = (uint64_t)sbuf.st_size;
         const bool is_big_endian = magic == MH_CIGAM || magic == MH_CIGAM_64;
+
         /*
          * Swap the mach_header's fields if big-endian.
          */
@@ -841,15 +1632,25 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
             header.flags = swap_uint32(header.flags);
         }
 
-        ret =
-            parse_thin_file(info_in,
-                            fd,
-                            header,
-                            is_big_endian,
-                            0,
-                            file_size,
-                            tbd_options,
-                            options);
+        if (arch_is_selected(only_archs, header.cputype, header.cpusubtype)) {
+            ret =
+                parse_thin_file(info_in,
+                                fd,
+                                map,
+                                header,
+                                is_big_endian,
+                                0,
+                                file_size,
+                                tbd_options,
+                                options,
+                                NULL);
+        } else {
+            ret = E_MACHO_FILE_PARSE_NO_VALID_ARCHITECTURES;
+        }
+    }
+
+    if (map != NULL) {
+        munmap((void *)map, file_size);
     }
 
     if (ret != E_MACHO_FILE_PARSE_OK) {
@@ -867,9 +1668,7 @@ macho_file_parse_from_file(struct tbd_create_info *const info_in,
      */
 
     const enum array_result sort_exports_result =
-        array_sort_items_with_comparator(&info_in->exports,
-                                         sizeof(struct tbd_export_info),
-                                         tbd_export_info_comparator);
+        tbd_create_info_sort_exports(info_in);
 
     if (sort_exports_result != E_ARRAY_OK) {
         return E_MACHO_FILE_PARSE_ARRAY_FAIL;
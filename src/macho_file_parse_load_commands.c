@@ -135,19 +135,77 @@ static inline bool is_image_info_section(const char name[16]) {
     return false;
 }
 
+/*
+ * Fields of big-endian mach-o files are swapped when read. As is_big_endian is
+ * always a constant in the instantiated decoders below, the check is resolved
+ * at compile time.
+ */
+
+static inline __attribute__((always_inline)) uint32_t
+get_uint32(const uint32_t value, const bool is_big_endian) {
+    if (is_big_endian) {
+        return swap_uint32(value);
+    }
+
+    return value;
+}
+
+static inline __attribute__((always_inline)) uint64_t
+get_uint64(const uint64_t value, const bool is_big_endian) {
+    if (is_big_endian) {
+        return swap_uint64(value);
+    }
+
+    return value;
+}
+
+/*
+ * The load-commands of a mach-o, either read from a file or found in a map.
+ *
+ * Only one of file_info and map_info is set, which decides how the data of a
+ * section is retrieved.
+ */
+
+struct load_commands {
+    const uint8_t *buffer;
+
+    uint32_t ncmds;
+    uint32_t sizeofcmds;
+
+    uint64_t arch_bit;
+
+    uint64_t tbd_options;
+    uint64_t options;
+
+    bool is_64;
+    bool copy_strings;
+
+    const struct mf_parse_load_commands_from_file_info *file_info;
+    const struct mf_parse_load_commands_from_map_info *map_info;
+};
+
+struct load_commands_state {
+    struct tbd_uuid_info uuid_info;
+
+    struct symtab_command symtab;
+    struct linkedit_data_command export_trie;
+
+    bool found_identification;
+    bool found_uuid;
+};
+
 static enum macho_file_parse_result
-parse_section_from_file(struct tbd_create_info *const info_in,
-                        uint32_t *const existing_swift_version_in,
-                        const int fd,
-                        const struct range full_range,
-                        const struct range macho_range,
-                        uint32_t sect_offset,
-                        uint64_t sect_size,
-                        const uint64_t options)
+read_image_info_from_file(
+    const struct mf_parse_load_commands_from_file_info *const parse_info,
+    const uint32_t sect_offset,
+    const uint64_t sect_size,
+    struct objc_image_info *const image_info_out)
 {
-    if (sect_size != sizeof(struct objc_image_info)) {
-        return E_MACHO_FILE_PARSE_INVALID_SECTION;
-    }
+    const struct range full_range = parse_info->full_range;
+    const struct range macho_range = {
+        .begin = parse_info->available_range.begin - full_range.begin,
+        .end = full_range.end - full_range.begin
+    };
 
     const struct range sect_range = {
         .begin = sect_offset,
@@ -163,8 +221,10 @@ parse_section_from_file(struct tbd_create_info *const info_in,
      * so we can return safetly back to the for loop.
      */
 
+    const int fd = parse_info->fd;
     const off_t original_pos = lseek(fd, 0, SEEK_CUR);
-    if (options & O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE) {
+
+    if (parse_info->options & O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE) {
         if (lseek(fd, sect_offset, SEEK_SET) < 0) {
             return E_MACHO_FILE_PARSE_SEEK_FAIL;
         }
@@ -175,8 +235,7 @@ parse_section_from_file(struct tbd_create_info *const info_in,
         }
     }
 
-    struct objc_image_info image_info = {};
-    if (read(fd, &image_info, sizeof(image_info)) < 0) {
+    if (read(fd, image_info_out, sizeof(*image_info_out)) < 0) {
         return E_MACHO_FILE_PARSE_READ_FAIL;
     }
 
@@ -189,19 +248,109 @@ parse_section_from_file(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_SEEK_FAIL;
     }
 
+    return E_MACHO_FILE_PARSE_OK;
+}
+
+static enum macho_file_parse_result
+read_image_info_from_map(
+    const struct mf_parse_load_commands_from_map_info *const parse_info,
+    const uint64_t sect_addr,
+    const uint32_t sect_offset,
+    const uint64_t sect_size,
+    struct objc_image_info *const image_info_out)
+{
+    const uint8_t *data = NULL;
+    const struct range sect_range = {
+        .begin = sect_offset,
+        .end = sect_offset + sect_size
+    };
+
+    const macho_file_get_section_data_callback get_section_data =
+        parse_info->get_section_data;
+
+    if (get_section_data != NULL) {
+        data =
+            get_section_data(parse_info->get_section_data_item,
+                             sect_addr,
+                             sect_size);
+
+        if (data == NULL) {
+            return E_MACHO_FILE_PARSE_INVALID_SECTION;
+        }
+    } else if (parse_info->options & O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE) {
+        if (!range_contains_range(parse_info->available_map_range,
+                                  sect_range))
+        {
+            return E_MACHO_FILE_PARSE_INVALID_SECTION;
+        }
+
+        data = parse_info->map + sect_offset;
+    } else {
+        const struct range macho_range = {
+            .begin = 0,
+            .end = parse_info->macho_size
+        };
+
+        if (!range_contains_range(macho_range, sect_range)) {
+            return E_MACHO_FILE_PARSE_INVALID_SECTION;
+        }
+
+        data = parse_info->macho + sect_offset;
+    }
+
+    memcpy(image_info_out, data, sizeof(*image_info_out));
+    return E_MACHO_FILE_PARSE_OK;
+}
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
+parse_section(struct tbd_create_info *const info_in,
+              const struct load_commands *const load_cmds,
+              uint32_t *const existing_swift_version_in,
+              const uint64_t sect_addr,
+              const uint32_t sect_offset,
+              const uint64_t sect_size,
+              const bool is_big_endian)
+{
+    if (sect_size != sizeof(struct objc_image_info)) {
+        return E_MACHO_FILE_PARSE_INVALID_SECTION;
+    }
+
+    struct objc_image_info image_info = {};
+    enum macho_file_parse_result read_result = E_MACHO_FILE_PARSE_OK;
+
+    if (load_cmds->file_info != NULL) {
+        read_result =
+            read_image_info_from_file(load_cmds->file_info,
+                                      sect_offset,
+                                      sect_size,
+                                      &image_info);
+    } else {
+        read_result =
+            read_image_info_from_map(load_cmds->map_info,
+                                     sect_addr,
+                                     sect_offset,
+                                     sect_size,
+                                     &image_info);
+    }
+
+    if (read_result != E_MACHO_FILE_PARSE_OK) {
+        return read_result;
+    }
+
     /*
      * Parse the objc-constraint and ensure it's the same as the one discovered
      * for another containers.
      */
 
+    const uint32_t flags = get_uint32(image_info.flags, is_big_endian);
     enum tbd_objc_constraint objc_constraint =
         TBD_OBJC_CONSTRAINT_RETAIN_RELEASE;
 
-    if (image_info.flags & F_OBJC_IMAGE_INFO_REQUIRES_GC) {
+    if (flags & F_OBJC_IMAGE_INFO_REQUIRES_GC) {
         objc_constraint = TBD_OBJC_CONSTRAINT_GC;
-    } else if (image_info.flags & F_OBJC_IMAGE_INFO_SUPPORTS_GC) {
+    } else if (flags & F_OBJC_IMAGE_INFO_SUPPORTS_GC) {
         objc_constraint = TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_OR_GC;
-    } else if (image_info.flags & F_OBJC_IMAGE_INFO_IS_FOR_SIMULATOR) {
+    } else if (flags & F_OBJC_IMAGE_INFO_IS_FOR_SIMULATOR) {
         objc_constraint = TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_FOR_SIMULATOR;
     }
 
@@ -219,7 +368,7 @@ parse_section_from_file(struct tbd_create_info *const info_in,
     const uint32_t mask = objc_image_info_swift_version_mask;
 
     const uint32_t existing_swift_version = *existing_swift_version_in;
-    const uint32_t image_swift_version = (image_info.flags & mask) >> 8;
+    const uint32_t image_swift_version = (flags & mask) >> 8;
 
     if (existing_swift_version != 0) {
         if (existing_swift_version != image_swift_version) {
@@ -232,12 +381,162 @@ parse_section_from_file(struct tbd_create_info *const info_in,
     return E_MACHO_FILE_PARSE_OK;
 }
 
+/*
+ * Parse a segment for its objc image-info section, with is_64 selecting
+ * between the 32-bit and 64-bit segment and section structures.
+ */
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
+parse_segment(struct tbd_create_info *const info_in,
+              const struct load_commands *const load_cmds,
+              const struct load_command load_cmd,
+              const uint8_t *const load_cmd_iter,
+              const bool is_64,
+              const bool is_big_endian)
+{
+    /*
+     * If no information from a segment is needed, skip the unnecessary
+     * parsing.
+     */
+
+    const uint64_t tbd_options = load_cmds->tbd_options;
+    if ((tbd_options & O_TBD_PARSE_IGNORE_OBJC_CONSTRAINT) &&
+        (tbd_options & O_TBD_PARSE_IGNORE_SWIFT_VERSION))
+    {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    /*
+     * Verify we have the right segment for the right word-size (32-bit vs
+     * 64-bit).
+     *
+     * We just ignore this as having the wrong segment-type doesn't matter for
+     * us.
+     */
+
+    if (load_cmds->is_64 != is_64) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    uint32_t segment_size = sizeof(struct segment_command);
+    uint32_t section_size = sizeof(struct section);
+
+    if (is_64) {
+        segment_size = sizeof(struct segment_command_64);
+        section_size = sizeof(struct section_64);
+    }
+
+    if (load_cmd.cmdsize < segment_size) {
+        return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
+    }
+
+    /*
+     * The segment-name is at the same offset in both segment structures.
+     */
+
+    const struct segment_command *const segment =
+        (const struct segment_command *)load_cmd_iter;
+
+    if (!segment_has_image_info_sect(segment->segname)) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    uint32_t nsects = 0;
+    if (is_64) {
+        const struct segment_command_64 *const segment_64 =
+            (const struct segment_command_64 *)load_cmd_iter;
+
+        nsects = get_uint32(segment_64->nsects, is_big_endian);
+    } else {
+        nsects = get_uint32(segment->nsects, is_big_endian);
+    }
+
+    if (nsects == 0) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    /*
+     * Verify the size and integrity of the sections.
+     */
+
+    uint64_t sections_size = section_size;
+    if (guard_overflow_mul(&sections_size, nsects)) {
+        return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
+    }
+
+    const uint32_t max_sections_size = load_cmd.cmdsize - segment_size;
+    if (sections_size > max_sections_size) {
+        return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
+    }
+
+    uint32_t swift_version = 0;
+    const uint8_t *sect_iter = load_cmd_iter + segment_size;
+
+    for (uint32_t j = 0; j < nsects; j++, sect_iter += section_size) {
+        /*
+         * The section-name is also at the same offset in both section
+         * structures.
+         */
+
+        const struct section *const sect = (const struct section *)sect_iter;
+        if (!is_image_info_section(sect->sectname)) {
+            continue;
+        }
+
+        uint64_t sect_addr = 0;
+        uint32_t sect_offset = 0;
+        uint64_t sect_size = 0;
+
+        if (is_64) {
+            const struct section_64 *const sect_64 =
+                (const struct section_64 *)sect_iter;
+
+            sect_addr = get_uint64(sect_64->addr, is_big_endian);
+            sect_offset = get_uint32(sect_64->offset, is_big_endian);
+            sect_size = get_uint64(sect_64->size, is_big_endian);
+        } else {
+            sect_addr = get_uint32(sect->addr, is_big_endian);
+            sect_offset = get_uint32(sect->offset, is_big_endian);
+            sect_size = get_uint32(sect->size, is_big_endian);
+        }
+
+        const enum macho_file_parse_result parse_section_result =
+            parse_section(info_in,
+                          load_cmds,
+                          &swift_version,
+                          sect_addr,
+                          sect_offset,
+                          sect_size,
+                          is_big_endian);
+
+        if (parse_section_result != E_MACHO_FILE_PARSE_OK) {
+            return parse_section_result;
+        }
+    }
+
+    if (info_in->swift_version != 0) {
+        const bool ignore_conflicting_fields =
+            load_cmds->options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
+
+        if (!ignore_conflicting_fields) {
+            if (info_in->swift_version != swift_version) {
+                return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
+            }
+        }
+    } else {
+        info_in->swift_version = swift_version;
+    }
+
+    return E_MACHO_FILE_PARSE_OK;
+}
+
 static enum macho_file_parse_result
 add_export_to_info(struct tbd_create_info *const info_in,
                    const uint64_t arch_bit,
                    const enum tbd_export_type type,
                    const char *const string,
-                   const uint32_t string_length)
+                   const uint32_t string_length,
+                   const bool borrow_string)
 {
     struct tbd_export_info export_info = {
         .archs = arch_bit,
@@ -247,15 +546,9 @@ add_export_to_info(struct tbd_create_info *const info_in,
         .type = type
     };
 
-    struct array *const exports = &info_in->exports;
-    struct array_cached_index_info cached_info = {};
-
+    uint64_t hash = 0;
     struct tbd_export_info *const existing_info =
-        array_find_item_in_sorted(exports,
-                                  sizeof(export_info),
-                                  &export_info,
-                                  tbd_export_info_no_archs_comparator,
-                                  &cached_info);
+        tbd_create_info_find_export(info_in, &export_info, &hash);
 
     if (existing_info != NULL) {
         const uint64_t archs = existing_info->archs;
@@ -282,46 +575,69 @@ add_export_to_info(struct tbd_create_info *const info_in,
     }
 
     /*
-     * Copy the provided string as the original string comes from the large
+     * Unless the string can be borrowed from the map, copy the provided string
+     * into the export-strings pool as the original string comes from the large
      * load-command buffer which will soon be freed.
      */
 
-    export_info.string = alloc_and_copy(export_info.string, export_info.length);
-    if (export_info.string == NULL) {
-        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    if (borrow_string) {
+        export_info.flags |= F_TBD_EXPORT_INFO_STRING_IS_BORROWED;
+    } else {
+        export_info.string =
+            string_pool_copy_string(&info_in->export_strings,
+                                    export_info.string,
+                                    export_info.length);
+
+        if (export_info.string == NULL) {
+            return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+        }
     }
 
+    /*
+     * Any copied string is left in the pool if adding the export-info fails,
+     * and is reclaimed when the pool is reset.
+     */
+
     const enum array_result add_export_info_result =
-        array_add_item_with_cached_index_info(exports,
-                                              sizeof(export_info),
-                                              &export_info,
-                                              &cached_info,
-                                              NULL);
+        tbd_create_info_add_export(info_in, &export_info, hash);
 
     if (add_export_info_result != E_ARRAY_OK) {
-        free(export_info.string);
         return E_MACHO_FILE_PARSE_ARRAY_FAIL;
     }
 
     return E_MACHO_FILE_PARSE_OK;
 }
 
-static inline
-enum macho_file_parse_result
+static inline __attribute__((always_inline)) enum macho_file_parse_result
 parse_load_command(struct tbd_create_info *const info_in,
-                   struct tbd_uuid_info *const uuid_info_in,
-                   bool *const found_uuid_in,
-                   const uint64_t arch_bit,
-                   struct load_command load_cmd,
+                   const struct load_commands *const load_cmds,
+                   struct load_commands_state *const state,
+                   const struct load_command load_cmd,
                    const uint8_t *const load_cmd_iter,
-                   const bool is_big_endian,
-                   const uint64_t tbd_options,
-                   const uint64_t options,
-                   const bool copy_strings,
-                   bool *const found_identification_out,
-                   struct symtab_command *const symtab_out)
+                   const bool is_big_endian)
 {
+    const uint64_t arch_bit = load_cmds->arch_bit;
+    const uint64_t tbd_options = load_cmds->tbd_options;
+    const uint64_t options = load_cmds->options;
+    const bool copy_strings = load_cmds->copy_strings;
+
     switch (load_cmd.cmd) {
+        case LC_SEGMENT:
+            return parse_segment(info_in,
+                                 load_cmds,
+                                 load_cmd,
+                                 load_cmd_iter,
+                                 false,
+                                 is_big_endian);
+
+        case LC_SEGMENT_64:
+            return parse_segment(info_in,
+                                 load_cmds,
+                                 load_cmd,
+                                 load_cmd_iter,
+                                 true,
+                                 is_big_endian);
+
         case LC_BUILD_VERSION: {
             /*
              * If the platform isn't needed, skip the unnecessary parsing.
@@ -350,10 +666,8 @@ parse_load_command(struct tbd_create_info *const info_in,
             const struct build_version_command *const build_version =
                 (const struct build_version_command *)load_cmd_iter;
 
-            uint32_t build_version_platform = build_version->platform;
-            if (is_big_endian) {
-                build_version_platform = swap_uint32(build_version_platform);
-            }
+            const uint32_t build_version_platform =
+                get_uint32(build_version->platform, is_big_endian);
 
             if (build_version_platform < TBD_PLATFORM_MACOS) {
                 /*
@@ -405,6 +719,68 @@ parse_load_command(struct tbd_create_info *const info_in,
             break;
         }
 
+        case LC_DYLD_INFO:
+        case LC_DYLD_INFO_ONLY: {
+            /*
+             * If symbols aren't needed, skip the unnecessary parsing.
+             */
+
+            if (tbd_options & O_TBD_PARSE_IGNORE_SYMBOLS) {
+                break;
+            }
+
+            /*
+             * For leniency, ignore a malformed dyld-info load-command, as we
+             * can still fall back to the symbol-table.
+             */
+
+            if (load_cmd.cmdsize != sizeof(struct dyld_info_command)) {
+                break;
+            }
+
+            const struct dyld_info_command *const dyld_info =
+                (const struct dyld_info_command *)load_cmd_iter;
+
+            struct linkedit_data_command *const export_trie =
+                &state->export_trie;
+
+            export_trie->cmd = load_cmd.cmd;
+            export_trie->cmdsize = load_cmd.cmdsize;
+            export_trie->dataoff =
+                get_uint32(dyld_info->export_off, is_big_endian);
+
+            export_trie->datasize =
+                get_uint32(dyld_info->export_size, is_big_endian);
+
+            break;
+        }
+
+        case LC_DYLD_EXPORTS_TRIE: {
+            if (tbd_options & O_TBD_PARSE_IGNORE_SYMBOLS) {
+                break;
+            }
+
+            if (load_cmd.cmdsize != sizeof(struct linkedit_data_command)) {
+                break;
+            }
+
+            const struct linkedit_data_command *const exports_trie =
+                (const struct linkedit_data_command *)load_cmd_iter;
+
+            struct linkedit_data_command *const export_trie =
+                &state->export_trie;
+
+            export_trie->cmd = load_cmd.cmd;
+            export_trie->cmdsize = load_cmd.cmdsize;
+            export_trie->dataoff =
+                get_uint32(exports_trie->dataoff, is_big_endian);
+
+            export_trie->datasize =
+                get_uint32(exports_trie->datasize, is_big_endian);
+
+            break;
+        }
+
         case LC_ID_DYLIB: {
             /*
              * We could check here if an LC_ID_DYLIB was already found for the
@@ -419,7 +795,7 @@ parse_load_command(struct tbd_create_info *const info_in,
                 tbd_options & O_TBD_PARSE_IGNORE_COMPATIBILITY_VERSION &&
                 tbd_options & O_TBD_PARSE_IGNORE_INSTALL_NAME)
             {
-                *found_identification_out = true;
+                state->found_identification = true;
                 break;
             }
 
@@ -438,10 +814,8 @@ parse_load_command(struct tbd_create_info *const info_in,
             const struct dylib_command *const dylib_command =
                 (const struct dylib_command *)load_cmd_iter;
 
-            uint32_t name_offset = dylib_command->dylib.name.offset;
-            if (is_big_endian) {
-                name_offset = swap_uint32(name_offset);
-            }
+            const uint32_t name_offset =
+                get_uint32(dylib_command->dylib.name.offset, is_big_endian);
 
             /*
              * Ensure that the install-name offset is not within the basic
@@ -450,7 +824,7 @@ parse_load_command(struct tbd_create_info *const info_in,
 
             if (name_offset < sizeof(struct dylib_command)) {
                 if (options & O_MACHO_FILE_PARSE_IGNORE_INVALID_FIELDS) {
-                    *found_identification_out = true;
+                    state->found_identification = true;
                     break;
                 }
 
@@ -459,7 +833,7 @@ parse_load_command(struct tbd_create_info *const info_in,
 
             if (name_offset >= load_cmd.cmdsize) {
                 if (options & O_MACHO_FILE_PARSE_IGNORE_INVALID_FIELDS) {
-                    *found_identification_out = true;
+                    state->found_identification = true;
                     break;
                 }
 
@@ -479,7 +853,7 @@ parse_load_command(struct tbd_create_info *const info_in,
 
             if (length == 0) {
                 if (options & O_MACHO_FILE_PARSE_IGNORE_INVALID_FIELDS) {
-                    *found_identification_out = true;
+                    state->found_identification = true;
                     break;
                 }
 
@@ -504,13 +878,20 @@ parse_load_command(struct tbd_create_info *const info_in,
              * are pretty lenient, so we don't enforce this.
              */
 
-            const struct dylib dylib = dylib_command->dylib;
+            struct dylib dylib = dylib_command->dylib;
+
+            dylib.current_version =
+                get_uint32(dylib.current_version, is_big_endian);
+
+            dylib.compatibility_version =
+                get_uint32(dylib.compatibility_version, is_big_endian);
+
             if (info_in->install_name != NULL) {
                 const bool ignore_conflicting_fields =
                     options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
 
                 if (ignore_conflicting_fields) {
-                    *found_identification_out = true;
+                    state->found_identification = true;
                     break;
                 }
 
@@ -563,7 +944,7 @@ parse_load_command(struct tbd_create_info *const info_in,
                 }
             }
 
-            *found_identification_out = true;
+            state->found_identification = true;
             break;
         }
 
@@ -587,10 +968,8 @@ parse_load_command(struct tbd_create_info *const info_in,
             const struct dylib_command *const reexport_dylib =
                 (const struct dylib_command *)load_cmd_iter;
 
-            uint32_t reexport_offset = reexport_dylib->dylib.name.offset;
-            if (is_big_endian) {
-                reexport_offset = swap_uint32(reexport_offset);
-            }
+            const uint32_t reexport_offset =
+                get_uint32(reexport_dylib->dylib.name.offset, is_big_endian);
 
             /*
              * Ensure that the reexport-string is not within the basic
@@ -625,7 +1004,8 @@ parse_load_command(struct tbd_create_info *const info_in,
                                    arch_bit,
                                    TBD_EXPORT_TYPE_REEXPORT,
                                    reexport_string,
-                                   length);
+                                   length,
+                                   !copy_strings && length < max_length);
 
             if (add_reexport_result != E_MACHO_FILE_PARSE_OK) {
                 return add_reexport_result;
@@ -664,10 +1044,8 @@ parse_load_command(struct tbd_create_info *const info_in,
             const struct sub_client_command *const client_command =
                 (const struct sub_client_command *)load_cmd_iter;
 
-            uint32_t client_offset = client_command->client.offset;
-            if (is_big_endian) {
-                client_offset = swap_uint32(client_offset);
-            }
+            const uint32_t client_offset =
+                get_uint32(client_command->client.offset, is_big_endian);
 
             /*
              * Ensure that the client-string offset is not within the basic
@@ -701,7 +1079,8 @@ parse_load_command(struct tbd_create_info *const info_in,
                                    arch_bit,
                                    TBD_EXPORT_TYPE_CLIENT,
                                    string,
-                                   length);
+                                   length,
+                                   !copy_strings && length < max_length);
 
             if (add_client_result != E_MACHO_FILE_PARSE_OK) {
                 return add_client_result;
@@ -734,10 +1113,8 @@ parse_load_command(struct tbd_create_info *const info_in,
             const struct sub_framework_command *const framework_command =
                 (const struct sub_framework_command *)load_cmd_iter;
 
-            uint32_t umbrella_offset = framework_command->umbrella.offset;
-            if (is_big_endian) {
-                umbrella_offset = swap_uint32(umbrella_offset);
-            }
+            const uint32_t umbrella_offset =
+                get_uint32(framework_command->umbrella.offset, is_big_endian);
 
             /*
              * Ensure that the umbrella-string offset is not within the basic
@@ -848,7 +1225,20 @@ parse_load_command(struct tbd_create_info *const info_in,
              * fill in the symtab's info fields.
              */
 
-            *symtab_out = *(const struct symtab_command *)load_cmd_iter;
+            const struct symtab_command *const symtab_cmd =
+                (const struct symtab_command *)load_cmd_iter;
+
+            struct symtab_command *const symtab = &state->symtab;
+
+            symtab->cmd = load_cmd.cmd;
+            symtab->cmdsize = load_cmd.cmdsize;
+
+            symtab->symoff = get_uint32(symtab_cmd->symoff, is_big_endian);
+            symtab->nsyms = get_uint32(symtab_cmd->nsyms, is_big_endian);
+
+            symtab->stroff = get_uint32(symtab_cmd->stroff, is_big_endian);
+            symtab->strsize = get_uint32(symtab_cmd->strsize, is_big_endian);
+
             break;
         }
 
@@ -865,12 +1255,14 @@ parse_load_command(struct tbd_create_info *const info_in,
                 return E_MACHO_FILE_PARSE_INVALID_UUID;
             }
 
-            const bool found_uuid = *found_uuid_in;
+            const bool found_uuid = state->found_uuid;
             const struct uuid_command *const uuid_cmd =
                 (const struct uuid_command *)load_cmd_iter;
 
             if (found_uuid) {
-                const char *const uuid_str = (const char *)uuid_info_in->uuid;
+                const char *const uuid_str =
+                    (const char *)state->uuid_info.uuid;
+
                 const char *const uuid_cmd_uuid = (const char *)uuid_cmd->uuid;
 
                 const bool ignore_conflicting_fields =
@@ -882,8 +1274,8 @@ parse_load_command(struct tbd_create_info *const info_in,
                     }
                 }
             } else {
-                memcpy(uuid_info_in->uuid, uuid_cmd->uuid, 16);
-                *found_uuid_in = true;
+                memcpy(state->uuid_info.uuid, uuid_cmd->uuid, 16);
+                state->found_uuid = true;
             }
 
             break;
@@ -1028,597 +1420,101 @@ parse_load_command(struct tbd_create_info *const info_in,
     return E_MACHO_FILE_PARSE_OK;
 }
 
-enum macho_file_parse_result
-macho_file_parse_load_commands_from_file(
-    struct tbd_create_info *const info_in,
-    const struct mf_parse_load_commands_from_file_info *const parse_info,
-    struct symtab_command *const symtab_out)
+/*
+ * The load-command decoder, instantiated by parse_load_commands() for each
+ * byte-order, so that native-endian mach-o files are parsed without any checks
+ * for swapping.
+ */
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
+scan_load_commands(struct tbd_create_info *const info_in,
+                   const struct load_commands *const load_cmds,
+                   struct load_commands_state *const state,
+                   const bool is_big_endian)
 {
-    const uint32_t ncmds = parse_info->ncmds;
-    if (ncmds == 0) {
-        return E_MACHO_FILE_PARSE_NO_LOAD_COMMANDS;
-    }
-
-    /*
-     * Verify the size and integrity of the load-commands.
-     */
+    const uint8_t *load_cmd_iter = load_cmds->buffer;
 
-    const uint32_t sizeofcmds = parse_info->sizeofcmds;
-    if (sizeofcmds < sizeof(struct load_command)) {
-        return E_MACHO_FILE_PARSE_LOAD_COMMANDS_AREA_TOO_SMALL;
-    }
+    const uint32_t ncmds = load_cmds->ncmds;
+    uint32_t size_left = load_cmds->sizeofcmds;
 
-    /*
-     * Get the minimum size by multiplying the ncmds and
-     * sizeof(struct load_command).
-     *
-     * Since sizeof(struct load_command) is a power of 2 (8), use a shift by 3
-     * instead.
-     */
+    for (uint32_t i = 0; i != ncmds; i++) {
+        /*
+         * Verify that we still have space for a load-command.
+         */
 
-    uint32_t minimum_size = sizeof(struct load_command);
-    if (guard_overflow_mul(&minimum_size, ncmds)) {
-        return E_MACHO_FILE_PARSE_TOO_MANY_LOAD_COMMANDS;
-    }
+        if (size_left < sizeof(struct load_command)) {
+            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
+        }
 
-    if (sizeofcmds < minimum_size) {
-        return E_MACHO_FILE_PARSE_TOO_MANY_LOAD_COMMANDS;
-    }
+        /*
+         * Big-endian mach-o files have load-commands whose information is also
+         * big-endian.
+         */
 
-    /*
-     * Ensure that sizeofcmds doesn't go past mach-o's size.
-     */
+        const struct load_command *const raw_load_cmd =
+            (const struct load_command *)load_cmd_iter;
 
-    const struct range full_range = parse_info->full_range;
-    const struct range available_range = parse_info->available_range;
+        const struct load_command load_cmd = {
+            .cmd = get_uint32(raw_load_cmd->cmd, is_big_endian),
+            .cmdsize = get_uint32(raw_load_cmd->cmdsize, is_big_endian)
+        };
 
-    const uint64_t macho_size = full_range.end - full_range.begin;
-    const uint32_t max_sizeofcmds =
-        (uint32_t)(available_range.end - available_range.begin);
+        /*
+         * Verify the cmdsize by checking that a load-cmd can actually fit.
+         * More verification can be done here, but we don't aim to be too picky.
+         */
 
-    if (sizeofcmds > max_sizeofcmds) {
-        return E_MACHO_FILE_PARSE_TOO_MANY_LOAD_COMMANDS;
-    }
+        if (load_cmd.cmdsize < sizeof(struct load_command)) {
+            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
+        }
 
-    const uint64_t header_size = available_range.begin - full_range.begin;
-    const struct range relative_range = {
-        .begin = header_size,
-        .end = macho_size
-    };
+        if (size_left < load_cmd.cmdsize) {
+            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
+        }
 
-    bool found_identification = false;
-    bool found_uuid = false;
-
-    struct symtab_command symtab = {};
-    struct tbd_uuid_info uuid_info = { .arch = parse_info->arch };
-
-    /*
-     * Allocate the entire load-commands buffer to allow fast parsing.
-     */
-
-    uint8_t *const load_cmd_buffer = malloc(sizeofcmds);
-    if (load_cmd_buffer == NULL) {
-        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
-    }
-
-    const int fd = parse_info->fd;
-    if (read(fd, load_cmd_buffer, sizeofcmds) < 0) {
-        free(load_cmd_buffer);
-        return E_MACHO_FILE_PARSE_READ_FAIL;
-    }
-
-    info_in->flags |= F_TBD_CREATE_INFO_STRINGS_WERE_COPIED;
-
-    /*
-     * Iterate over the load-commands, which is located directly after the
-     * mach-o header.
-     */
-
-    const bool is_64 = parse_info->is_64;
-    const bool is_big_endian = parse_info->is_big_endian;
-
-    const uint64_t arch_bit = parse_info->arch_bit;
-    const uint64_t options = parse_info->options;
-    const uint64_t tbd_options = parse_info->tbd_options;
-
-    uint8_t *load_cmd_iter = load_cmd_buffer;
-    uint32_t size_left = sizeofcmds;
-
-    for (uint32_t i = 0; i != ncmds; i++) {
-        /*
-         * Verify that we still have space for a load-command.
-         */
-
-        if (size_left < sizeof(struct load_command)) {
-            free(load_cmd_buffer);
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
-
-        /*
-         * Big-endian mach-o files have load-commands whose information is also
-         * big-endian.
-         */
-
-        struct load_command load_cmd = *(struct load_command *)load_cmd_iter;
-        if (is_big_endian) {
-            load_cmd.cmd = swap_uint32(load_cmd.cmd);
-            load_cmd.cmdsize = swap_uint32(load_cmd.cmdsize);
-        }
-
-        /*
-         * Verify the cmdsize by checking that a load-cmd can actually fit.
-         * More verification can be done here, but we don't aim to be too picky.
-         */
-
-        if (load_cmd.cmdsize < sizeof(struct load_command)) {
-            free(load_cmd_buffer);
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
-
-        if (size_left < load_cmd.cmdsize) {
-            free(load_cmd_buffer);
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
-
-        size_left -= load_cmd.cmdsize;
+        size_left -= load_cmd.cmdsize;
 
         /*
          * We can't check size_left here, as this could be the last
          * load-command, so we have to check at the very beginning of the loop.
          */
 
-        switch (load_cmd.cmd) {
-            case LC_SEGMENT: {
-                /*
-                 * If no information from a segment is needed, skip the
-                 * unnecessary parsing.
-                 */
-
-                if ((tbd_options & O_TBD_PARSE_IGNORE_OBJC_CONSTRAINT) &&
-                    (tbd_options & O_TBD_PARSE_IGNORE_SWIFT_VERSION))
-                {
-                    break;
-                }
-
-                /*
-                 * Verify we have the right segment for the right word-size
-                 * (32-bit vs 64-bit).
-                 *
-                 * We just ignore this as having the wrong segment-type doesn't
-                 * matter for us.
-                 */
-
-                if (is_64) {
-                    break;
-                }
-
-                if (load_cmd.cmdsize < sizeof(struct segment_command)) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-                }
-
-                const struct segment_command *const segment =
-                    (const struct segment_command *)load_cmd_iter;
-
-                if (!segment_has_image_info_sect(segment->segname)) {
-                    break;
-                }
-
-                uint32_t nsects = segment->nsects;
-                if (nsects == 0) {
-                    break;
-                }
-
-                if (is_big_endian) {
-                    nsects = swap_uint32(nsects);
-                }
-
-                /*
-                 * Verify the size and integrity of the sections.
-                 */
-
-                uint64_t sections_size = sizeof(struct section);
-                if (guard_overflow_mul(&sections_size, nsects)) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
-
-                const uint32_t max_sections_size =
-                    load_cmd.cmdsize - sizeof(struct segment_command);
-
-                if (sections_size > max_sections_size) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
-
-                uint32_t swift_version = 0;
-                const uint8_t *const sect_ptr =
-                    load_cmd_iter + sizeof(struct segment_command);
-
-                const struct section *sect = (const struct section *)sect_ptr;
-                for (uint32_t j = 0; j < nsects; j++, sect++) {
-                    if (!is_image_info_section(sect->sectname)) {
-                        continue;
-                    }
-
-                    uint32_t sect_offset = sect->offset;
-                    uint32_t sect_size = sect->size;
-
-                    if (is_big_endian) {
-                        sect_offset = swap_uint32(sect_offset);
-                        sect_size = swap_uint32(sect_size);
-                    }
-
-                    const enum macho_file_parse_result parse_section_result =
-                        parse_section_from_file(info_in,
-                                                &swift_version,
-                                                fd,
-                                                full_range,
-                                                relative_range,
-                                                sect_offset,
-                                                sect_size,
-                                                options);
-
-                    if (parse_section_result != E_MACHO_FILE_PARSE_OK) {
-                        free(load_cmd_buffer);
-                        return parse_section_result;
-                    }
-                }
-
-                if (info_in->swift_version != 0) {
-                    const bool ignore_conflicting_fields =
-                        options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
-
-                    if (!ignore_conflicting_fields) {
-                        if (info_in->swift_version != swift_version) {
-                            free(load_cmd_buffer);
-                            return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
-                        }
-                    }
-                } else {
-                    info_in->swift_version = swift_version;
-                }
-
-                break;
-            }
-
-            case LC_SEGMENT_64: {
-                /*
-                 * If no information from a segment is needed, skip the
-                 * unnecessary parsing.
-                 */
-
-                if ((tbd_options & O_TBD_PARSE_IGNORE_OBJC_CONSTRAINT) &&
-                    (tbd_options & O_TBD_PARSE_IGNORE_SWIFT_VERSION))
-                {
-                    break;
-                }
-
-                /*
-                 * Verify we have the right segment for the right word-size
-                 * (32-bit vs 64-bit).
-                 *
-                 * We just ignore this as having the wrong segment-type doesn't
-                 * matter for us.
-                 */
-
-                if (!is_64) {
-                    break;
-                }
-
-                if (load_cmd.cmdsize < sizeof(struct segment_command_64)) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-                }
-
-                const struct segment_command_64 *const segment =
-                    (const struct segment_command_64 *)load_cmd_iter;
-
-                if (!segment_has_image_info_sect(segment->segname)) {
-                    break;
-                }
-
-                uint32_t nsects = segment->nsects;
-                if (nsects == 0) {
-                    break;
-                }
-
-                if (is_big_endian) {
-                    nsects = swap_uint32(nsects);
-                }
-
-                /*
-                 * Verify the size and integrity of the sections.
-                 */
-
-                uint64_t sections_size = sizeof(struct section_64);
-                if (guard_overflow_mul(&sections_size, nsects)) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
-
-                const uint32_t max_sections_size =
-                    load_cmd.cmdsize - sizeof(struct segment_command_64);
-
-                if (sections_size > max_sections_size) {
-                    free(load_cmd_buffer);
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
-
-                uint32_t swift_version = 0;
-                const uint8_t *const sect_ptr =
-                    load_cmd_iter + sizeof(struct segment_command_64);
-
-                const struct section_64 *sect =
-                    (const struct section_64 *)sect_ptr;
-
-                for (uint32_t j = 0; j < nsects; j++, sect++) {
-                    if (!is_image_info_section(sect->sectname)) {
-                        continue;
-                    }
-
-                    uint32_t sect_offset = sect->offset;
-                    uint64_t sect_size = sect->size;
-
-                    if (is_big_endian) {
-                        sect_offset = swap_uint32(sect_offset);
-                        sect_size = swap_uint64(sect_size);
-                    }
-
-                    const enum macho_file_parse_result parse_section_result =
-                        parse_section_from_file(info_in,
-                                                &swift_version,
-                                                fd,
-                                                full_range,
-                                                relative_range,
-                                                sect_offset,
-                                                sect_size,
-                                                options);
-
-                    if (parse_section_result != E_MACHO_FILE_PARSE_OK) {
-                        free(load_cmd_buffer);
-                        return parse_section_result;
-                    }
-                }
-
-                if (info_in->swift_version != 0) {
-                    const bool ignore_conflicting_fields =
-                        options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
-
-                    if (!ignore_conflicting_fields) {
-                        if (info_in->swift_version != swift_version) {
-                            free(load_cmd_buffer);
-                            return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
-                        }
-                    }
-                } else {
-                    info_in->swift_version = swift_version;
-                }
-
-                break;
-            }
-
-            default: {
-                const enum macho_file_parse_result parse_load_command_result =
-                    parse_load_command(info_in,
-                                       &uuid_info,
-                                       &found_uuid,
-                                       arch_bit,
-                                       load_cmd,
-                                       load_cmd_iter,
-                                       is_big_endian,
-                                       tbd_options,
-                                       options,
-                                       true,
-                                       &found_identification,
-                                       &symtab);
-
-                if (parse_load_command_result != E_MACHO_FILE_PARSE_OK) {
-                    free(load_cmd_buffer);
-                    return parse_load_command_result;
-                }
+        const enum macho_file_parse_result parse_load_command_result =
+            parse_load_command(info_in,
+                               load_cmds,
+                               state,
+                               load_cmd,
+                               load_cmd_iter,
+                               is_big_endian);
 
-                break;
-            }
+        if (parse_load_command_result != E_MACHO_FILE_PARSE_OK) {
+            return parse_load_command_result;
         }
 
         load_cmd_iter += load_cmd.cmdsize;
     }
 
-    free(load_cmd_buffer);
-    if (!found_identification) {
-        return E_MACHO_FILE_PARSE_NO_IDENTIFICATION;
-    }
-
-    /*
-     * Ensure that the uuid found is unique among all other containers before
-     * adding to the fd's uuid arrays.
-     */
-
-    const uint8_t *const array_uuid =
-        array_find_item(&info_in->uuids,
-                        sizeof(uuid_info),
-                        &uuid_info,
-                        tbd_uuid_info_comparator,
-                        NULL);
-
-    if (array_uuid != NULL) {
-        return E_MACHO_FILE_PARSE_CONFLICTING_UUID;
-    }
-
-    const enum array_result add_uuid_info_result =
-        array_add_item(&info_in->uuids, sizeof(uuid_info), &uuid_info, NULL);
-
-    if (add_uuid_info_result != E_ARRAY_OK) {
-        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
-    }
-
-    if (!(tbd_options & O_TBD_PARSE_IGNORE_PLATFORM)) {
-        if (info_in->platform == 0) {
-            return E_MACHO_FILE_PARSE_NO_PLATFORM;
-        }
-    }
-
-    if (!(tbd_options & O_TBD_PARSE_IGNORE_SYMBOLS)) {
-        if (symtab.cmd != LC_SYMTAB) {
-            return E_MACHO_FILE_PARSE_NO_SYMBOL_TABLE;
-        }
-    }
-
-    if (!(tbd_options & O_TBD_PARSE_IGNORE_UUID)) {
-        if (!found_uuid) {
-            return E_MACHO_FILE_PARSE_NO_UUID;
-        }
-    }
-
-    /*
-     * Retrieve the symbol-table and string-table info via the symtab_command.
-     */
-
-    if (is_big_endian) {
-        symtab.symoff = swap_uint32(symtab.symoff);
-        symtab.nsyms = swap_uint32(symtab.nsyms);
-
-        symtab.stroff = swap_uint32(symtab.stroff);
-        symtab.strsize = swap_uint32(symtab.strsize);
-    }
-
-    if (symtab_out != NULL) {
-        *symtab_out = symtab;
-    }
-
-    if (options & O_MACHO_FILE_PARSE_DONT_PARSE_SYMBOL_TABLE) {
-        return E_MACHO_FILE_PARSE_OK;
-    }
-
-    /*
-     * Verify the symbol-table's information.
-     */
-
-    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
-    if (is_64) {
-        ret =
-            macho_file_parse_symbols_64_from_file(info_in,
-                                                  fd,
-                                                  full_range,
-                                                  available_range,
-                                                  arch_bit,
-                                                  is_big_endian,
-                                                  symtab.symoff,
-                                                  symtab.nsyms,
-                                                  symtab.stroff,
-                                                  symtab.strsize,
-                                                  tbd_options);
-    } else {
-        ret =
-            macho_file_parse_symbols_from_file(info_in,
-                                               fd,
-                                               full_range,
-                                               available_range,
-                                               arch_bit,
-                                               is_big_endian,
-                                               symtab.symoff,
-                                               symtab.nsyms,
-                                               symtab.stroff,
-                                               symtab.strsize,
-                                               tbd_options);
-    }
-
-    if (ret != E_MACHO_FILE_PARSE_OK) {
-        return ret;
-    }
-
     return E_MACHO_FILE_PARSE_OK;
 }
 
 static enum macho_file_parse_result
-parse_section_from_map(struct tbd_create_info *const info_in,
-                       uint32_t *const existing_swift_version_in,
-                       const struct range map_range,
-                       const struct range macho_range,
-                       const uint8_t *const map,
-                       const uint8_t *const macho,
-                       uint32_t sect_offset,
-                       uint64_t sect_size,
-                       const uint64_t options)
+parse_load_commands(struct tbd_create_info *const info_in,
+                    const struct load_commands *const load_cmds,
+                    struct load_commands_state *const state,
+                    const bool is_big_endian)
 {
-    if (sect_size != sizeof(struct objc_image_info)) {
-        return E_MACHO_FILE_PARSE_INVALID_SECTION;
-    }
-
-    const struct objc_image_info *image_info = NULL;
-    const struct range sect_range = {
-        .begin = sect_offset,
-        .end = sect_offset + sect_size
-    };
-
-    if (options & O_MACHO_FILE_PARSE_SECT_OFF_ABSOLUTE) {
-        if (!range_contains_range(map_range, sect_range)) {
-            return E_MACHO_FILE_PARSE_INVALID_SECTION;
-        }
-
-        const void *const iter = map + sect_offset;
-        image_info = (const struct objc_image_info *)iter;
-    } else {
-        if (!range_contains_range(macho_range, sect_range)) {
-            return E_MACHO_FILE_PARSE_INVALID_SECTION;
-        }
-
-        const void *const iter = macho + sect_offset;
-        image_info = (const struct objc_image_info *)iter;
-    }
-
-    /*
-     * Parse the objc-constraint and ensure it's the same as the one discovered
-     * for another containers.
-     */
-
-    const uint32_t flags = image_info->flags;
-    enum tbd_objc_constraint objc_constraint =
-        TBD_OBJC_CONSTRAINT_RETAIN_RELEASE;
-
-    if (flags & F_OBJC_IMAGE_INFO_REQUIRES_GC) {
-        objc_constraint = TBD_OBJC_CONSTRAINT_GC;
-    } else if (flags & F_OBJC_IMAGE_INFO_SUPPORTS_GC) {
-        objc_constraint = TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_OR_GC;
-    } else if (flags & F_OBJC_IMAGE_INFO_IS_FOR_SIMULATOR) {
-        objc_constraint = TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_FOR_SIMULATOR;
-    }
-
-    const enum tbd_objc_constraint info_objc_constraint =
-        info_in->objc_constraint;
-
-    if (info_objc_constraint != 0) {
-        if (info_objc_constraint != objc_constraint) {
-            return E_MACHO_FILE_PARSE_CONFLICTING_OBJC_CONSTRAINT;
-        }
-    } else {
-        info_in->objc_constraint = objc_constraint;
-    }
-
-    const uint32_t mask = objc_image_info_swift_version_mask;
-
-    const uint32_t existing_swift_version = *existing_swift_version_in;
-    const uint32_t image_swift_version = (flags & mask) >> 8;
-
-    if (existing_swift_version != 0) {
-        if (existing_swift_version != image_swift_version) {
-            return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
-        }
-    } else {
-        *existing_swift_version_in = image_swift_version;
+    if (is_big_endian) {
+        return scan_load_commands(info_in, load_cmds, state, true);
     }
 
-    return E_MACHO_FILE_PARSE_OK;
+    return scan_load_commands(info_in, load_cmds, state, false);
 }
 
-enum macho_file_parse_result
-macho_file_parse_load_commands_from_map(
-    struct tbd_create_info *const info_in,
-    const struct mf_parse_load_commands_from_map_info *const parse_info,
-    struct symtab_command *const symtab_out)
+static enum macho_file_parse_result
+verify_load_commands_size(const uint32_t ncmds,
+                          const uint32_t sizeofcmds,
+                          const uint32_t max_sizeofcmds)
 {
-    const uint32_t ncmds = parse_info->ncmds;
     if (ncmds == 0) {
         return E_MACHO_FILE_PARSE_NO_LOAD_COMMANDS;
     }
@@ -1627,7 +1523,6 @@ macho_file_parse_load_commands_from_map(
      * Verify the size and integrity of the load-commands.
      */
 
-    const uint32_t sizeofcmds = parse_info->sizeofcmds;
     if (sizeofcmds < sizeof(struct load_command)) {
         return E_MACHO_FILE_PARSE_LOAD_COMMANDS_AREA_TOO_SMALL;
     }
@@ -1647,383 +1542,271 @@ macho_file_parse_load_commands_from_map(
     }
 
     /*
-     * Ensure that sizeofcmds doesn't go beyond end of mach-o.
+     * Ensure that sizeofcmds doesn't go past the end of the mach-o.
      */
 
-    const bool is_64 = parse_info->is_64;
-    uint32_t header_size = sizeof(struct mach_header);
-
-    if (is_64) {
-        header_size += sizeof(uint32_t);
-    }
-
-    const uint64_t macho_size = parse_info->macho_size;
-    const uint32_t max_sizeofcmds = (uint32_t)(macho_size - header_size);
-
     if (sizeofcmds > max_sizeofcmds) {
         return E_MACHO_FILE_PARSE_TOO_MANY_LOAD_COMMANDS;
     }
 
-    const struct range relative_range = {
-        .begin = 0,
-        .end = macho_size
-    };
-
-    bool found_identification = false;
-    bool found_uuid = false;
-
-    struct symtab_command symtab = {};
-    struct tbd_uuid_info uuid_info = { .arch = parse_info->arch };
-
-    /*
-     * Allocate the entire load-commands buffer to allow fast parsing.
-     */
+    return E_MACHO_FILE_PARSE_OK;
+}
 
-    const uint8_t *const macho = parse_info->macho;
+/*
+ * Ensure that the uuid found is unique among all other containers before
+ * adding to the uuid array.
+ */
 
-    const uint8_t *load_cmd_iter = macho + header_size;
-    const uint64_t options = parse_info->options;
+static enum macho_file_parse_result
+add_uuid_info(struct tbd_create_info *const info_in,
+              const struct tbd_uuid_info *const uuid_info)
+{
+    const uint8_t *const array_uuid =
+        array_find_item(&info_in->uuids,
+                        sizeof(*uuid_info),
+                        uuid_info,
+                        tbd_uuid_info_comparator,
+                        NULL);
 
-    if (options & O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP) {
-        info_in->flags |= F_TBD_CREATE_INFO_STRINGS_WERE_COPIED;
+    if (array_uuid != NULL) {
+        return E_MACHO_FILE_PARSE_CONFLICTING_UUID;
     }
 
-    const bool is_big_endian = parse_info->is_big_endian;
-    const uint64_t tbd_options = parse_info->tbd_options;
-
-    const uint8_t *const map = parse_info->map;
-    const uint64_t arch_bit = parse_info->arch_bit;
-
-    const struct range available_map_range = parse_info->available_map_range;
-    uint32_t size_left = sizeofcmds;
+    const enum array_result add_uuid_info_result =
+        array_add_item(&info_in->uuids, sizeof(*uuid_info), uuid_info, NULL);
 
-    for (uint32_t i = 0; i != ncmds; i++) {
-        /*
-         * Verify that we still have space for a load-command.
-         */
+    if (add_uuid_info_result != E_ARRAY_OK) {
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
 
-        if (size_left < sizeof(struct load_command)) {
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
+    return E_MACHO_FILE_PARSE_OK;
+}
 
-        /*
-         * Big-endian mach-o files have load-commands whose information is also
-         * big-endian.
-         */
+enum macho_file_parse_result
+macho_file_parse_load_commands_from_file(
+    struct tbd_create_info *const info_in,
+    const struct mf_parse_load_commands_from_file_info *const parse_info,
+    struct symtab_command *const symtab_out,
+    struct linkedit_data_command *const export_trie_out)
+{
+    const struct range full_range = parse_info->full_range;
+    const struct range available_range = parse_info->available_range;
 
-        struct load_command load_cmd =
-            *(const struct load_command *)load_cmd_iter;
+    const uint32_t ncmds = parse_info->ncmds;
+    const uint32_t sizeofcmds = parse_info->sizeofcmds;
+    const uint32_t max_sizeofcmds =
+        (uint32_t)(available_range.end - available_range.begin);
 
-        if (is_big_endian) {
-            load_cmd.cmd = swap_uint32(load_cmd.cmd);
-            load_cmd.cmdsize = swap_uint32(load_cmd.cmdsize);
-        }
+    const enum macho_file_parse_result verify_size_result =
+        verify_load_commands_size(ncmds, sizeofcmds, max_sizeofcmds);
 
-        /*
-         * Verify the cmdsize by checking that a load-cmd can actually fit.
-         * More verification can be done here, but we don't aim to be too picky.
-         */
+    if (verify_size_result != E_MACHO_FILE_PARSE_OK) {
+        return verify_size_result;
+    }
 
-        if (load_cmd.cmdsize < sizeof(struct load_command)) {
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
+    /*
+     * Allocate the entire load-commands buffer to allow fast parsing.
+     */
 
-        if (size_left < load_cmd.cmdsize) {
-            return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-        }
+    uint8_t *const load_cmd_buffer = malloc(sizeofcmds);
+    if (load_cmd_buffer == NULL) {
+        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    }
 
-        size_left -= load_cmd.cmdsize;
+    const int fd = parse_info->fd;
+    if (read(fd, load_cmd_buffer, sizeofcmds) < 0) {
+        free(load_cmd_buffer);
+        return E_MACHO_FILE_PARSE_READ_FAIL;
+    }
 
-        /*
-         * We can't check size_left here, as this could be the last
-         * load-command, so we have to check at the very beginning of the loop.
-         */
+    info_in->flags |= F_TBD_CREATE_INFO_STRINGS_WERE_COPIED;
 
-        switch (load_cmd.cmd) {
-            case LC_SEGMENT: {
-                /*
-                 * If no information from a segment is needed, skip the
-                 * unnecessary parsing.
-                 */
+    const bool is_64 = parse_info->is_64;
+    const bool is_big_endian = parse_info->is_big_endian;
 
-                if ((tbd_options & O_TBD_PARSE_IGNORE_OBJC_CONSTRAINT) &&
-                    (tbd_options & O_TBD_PARSE_IGNORE_SWIFT_VERSION))
-                {
-                    break;
-                }
+    const uint64_t arch_bit = parse_info->arch_bit;
+    const uint64_t options = parse_info->options;
+    const uint64_t tbd_options = parse_info->tbd_options;
 
-                /*
-                 * Verify we have the right segment for the right word-size
-                 * (32-bit vs 64-bit).
-                 *
-                 * We just ignore this as having the wrong segment-type doesn't
-                 * matter for us.
-                 */
+    const struct load_commands load_cmds = {
+        .buffer = load_cmd_buffer,
 
-                if (is_64) {
-                    break;
-                }
+        .ncmds = ncmds,
+        .sizeofcmds = sizeofcmds,
 
-                if (load_cmd.cmdsize < sizeof(struct segment_command)) {
-                    return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-                }
+        .arch_bit = arch_bit,
 
-                const struct segment_command *const segment =
-                    (const struct segment_command *)load_cmd_iter;
+        .tbd_options = tbd_options,
+        .options = options,
 
-                if (!segment_has_image_info_sect(segment->segname)) {
-                    break;
-                }
+        .is_64 = is_64,
+        .copy_strings = true,
 
-                uint32_t nsects = segment->nsects;
-                if (nsects == 0) {
-                    break;
-                }
+        .file_info = parse_info
+    };
 
-                if (is_big_endian) {
-                    nsects = swap_uint32(nsects);
-                }
+    struct load_commands_state state = {
+        .uuid_info = { .arch = parse_info->arch }
+    };
 
-                /*
-                 * Verify the size and integrity of the sections.
-                 */
+    const enum macho_file_parse_result parse_load_commands_result =
+        parse_load_commands(info_in, &load_cmds, &state, is_big_endian);
 
-                uint64_t sections_size = sizeof(struct section);
-                if (guard_overflow_mul(&sections_size, nsects)) {
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
+    free(load_cmd_buffer);
+    if (parse_load_commands_result != E_MACHO_FILE_PARSE_OK) {
+        return parse_load_commands_result;
+    }
 
-                const uint32_t max_sections_size =
-                    load_cmd.cmdsize - sizeof(struct segment_command);
+    if (!state.found_identification) {
+        return E_MACHO_FILE_PARSE_NO_IDENTIFICATION;
+    }
 
-                if (sections_size > max_sections_size) {
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
+    const enum macho_file_parse_result add_uuid_info_result =
+        add_uuid_info(info_in, &state.uuid_info);
 
-                uint32_t swift_version = 0;
-                const uint8_t *const sect_ptr =
-                    load_cmd_iter + sizeof(struct segment_command);
+    if (add_uuid_info_result != E_MACHO_FILE_PARSE_OK) {
+        return add_uuid_info_result;
+    }
 
-                const struct section *sect = (const struct section *)sect_ptr;
-                for (uint32_t j = 0; j < nsects; j++, sect++) {
-                    if (!is_image_info_section(sect->sectname)) {
-                        continue;
-                    }
+    if (!(tbd_options & O_TBD_PARSE_IGNORE_PLATFORM)) {
+        if (info_in->platform == 0) {
+            return E_MACHO_FILE_PARSE_NO_PLATFORM;
+        }
+    }
 
-                    uint32_t sect_offset = sect->offset;
-                    uint32_t sect_size = sect->size;
+    const struct symtab_command symtab = state.symtab;
+    if (!(tbd_options & O_TBD_PARSE_IGNORE_SYMBOLS)) {
+        if (symtab.cmd != LC_SYMTAB) {
+            return E_MACHO_FILE_PARSE_NO_SYMBOL_TABLE;
+        }
+    }
 
-                    if (is_big_endian) {
-                        sect_offset = swap_uint32(sect_offset);
-                        sect_size = swap_uint32(sect_size);
-                    }
+    if (!(tbd_options & O_TBD_PARSE_IGNORE_UUID)) {
+        if (!state.found_uuid) {
+            return E_MACHO_FILE_PARSE_NO_UUID;
+        }
+    }
 
-                    const enum macho_file_parse_result parse_section_result =
-                        parse_section_from_map(info_in,
-                                               &swift_version,
-                                               available_map_range,
-                                               relative_range,
-                                               map,
-                                               macho,
-                                               sect_offset,
-                                               sect_size,
-                                               options);
-
-                    if (parse_section_result != E_MACHO_FILE_PARSE_OK) {
-                        return parse_section_result;
-                    }
-                }
+    const struct linkedit_data_command export_trie = state.export_trie;
+    if (symtab_out != NULL) {
+        *symtab_out = symtab;
+    }
 
-                if (info_in->swift_version != 0) {
-                    const bool ignore_conflicting_fields =
-                        options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
+    if (export_trie_out != NULL) {
+        *export_trie_out = export_trie;
+    }
 
-                    if (!ignore_conflicting_fields) {
-                        if (info_in->swift_version != swift_version) {
-                            return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
-                        }
-                    }
-                } else {
-                    info_in->swift_version = swift_version;
-                }
+    if (options & O_MACHO_FILE_PARSE_DONT_PARSE_SYMBOL_TABLE) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
 
-                break;
-            }
+    const struct mf_parse_exports_info exports_info = {
+        .fd = fd,
 
-            case LC_SEGMENT_64: {
-                /*
-                 * If no information from a segment is needed, skip the
-                 * unnecessary parsing.
-                 */
+        .full_range = full_range,
+        .available_range = available_range,
 
-                if ((tbd_options & O_TBD_PARSE_IGNORE_OBJC_CONSTRAINT) &&
-                    (tbd_options & O_TBD_PARSE_IGNORE_SWIFT_VERSION))
-                {
-                    break;
-                }
+        .arch_bit = arch_bit,
 
-                /*
-                 * Verify we have the right segment for the right word-size
-                 * (32-bit vs 64-bit).
-                 *
-                 * We just ignore this as having the wrong segment-type doesn't
-                 * matter for us.
-                 */
+        .is_64 = is_64,
+        .is_big_endian = is_big_endian,
 
-                if (!is_64) {
-                    break;
-                }
+        .symtab = symtab,
+        .export_trie = export_trie,
 
-                if (load_cmd.cmdsize < sizeof(struct segment_command_64)) {
-                    return E_MACHO_FILE_PARSE_INVALID_LOAD_COMMAND;
-                }
+        .tbd_options = tbd_options
+    };
 
-                const struct segment_command_64 *const segment =
-                    (const struct segment_command_64 *)load_cmd_iter;
+    return macho_file_parse_exports(info_in, &exports_info);
+}
 
-                if (!segment_has_image_info_sect(segment->segname)) {
-                    break;
-                }
+enum macho_file_parse_result
+macho_file_parse_load_commands_from_map(
+    struct tbd_create_info *const info_in,
+    const struct mf_parse_load_commands_from_map_info *const parse_info,
+    struct symtab_command *const symtab_out,
+    struct linkedit_data_command *const export_trie_out)
+{
+    const bool is_64 = parse_info->is_64;
+    uint32_t header_size = sizeof(struct mach_header);
 
-                uint32_t nsects = segment->nsects;
-                if (nsects == 0) {
-                    break;
-                }
+    if (is_64) {
+        header_size += sizeof(uint32_t);
+    }
 
-                if (is_big_endian) {
-                    nsects = swap_uint32(nsects);
-                }
+    const uint32_t ncmds = parse_info->ncmds;
+    const uint32_t sizeofcmds = parse_info->sizeofcmds;
 
-                /*
-                 * Verify the size and integrity of the sections.
-                 */
+    const uint64_t macho_size = parse_info->macho_size;
+    const uint32_t max_sizeofcmds = (uint32_t)(macho_size - header_size);
 
-                uint64_t sections_size = sizeof(struct section_64);
-                if (guard_overflow_mul(&sections_size, nsects)) {
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
+    const enum macho_file_parse_result verify_size_result =
+        verify_load_commands_size(ncmds, sizeofcmds, max_sizeofcmds);
 
-                const uint32_t max_sections_size =
-                    load_cmd.cmdsize - sizeof(struct segment_command_64);
+    if (verify_size_result != E_MACHO_FILE_PARSE_OK) {
+        return verify_size_result;
+    }
 
-                if (sections_size > max_sections_size) {
-                    return E_MACHO_FILE_PARSE_TOO_MANY_SECTIONS;
-                }
+    const uint64_t options = parse_info->options;
+    const bool copy_strings = options & O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
 
-                uint32_t swift_version = 0;
-                const uint8_t *const sect_ptr =
-                    load_cmd_iter + sizeof(struct segment_command_64);
+    if (copy_strings) {
+        info_in->flags |= F_TBD_CREATE_INFO_STRINGS_WERE_COPIED;
+    }
 
-                const struct section_64 *sect =
-                    (const struct section_64 *)sect_ptr;
+    const bool is_big_endian = parse_info->is_big_endian;
+    const uint64_t tbd_options = parse_info->tbd_options;
 
-                for (uint32_t j = 0; j < nsects; j++, sect++) {
-                    if (!is_image_info_section(sect->sectname)) {
-                        continue;
-                    }
+    const uint8_t *const map = parse_info->map;
+    const uint64_t arch_bit = parse_info->arch_bit;
 
-                    uint32_t sect_offset = sect->offset;
-                    uint64_t sect_size = sect->size;
+    const struct range available_map_range = parse_info->available_map_range;
+    const struct load_commands load_cmds = {
+        .buffer = parse_info->macho + header_size,
 
-                    if (is_big_endian) {
-                        sect_offset = swap_uint32(sect_offset);
-                        sect_size = swap_uint64(sect_size);
-                    }
+        .ncmds = ncmds,
+        .sizeofcmds = sizeofcmds,
 
-                    const enum macho_file_parse_result parse_section_result =
-                        parse_section_from_map(info_in,
-                                               &swift_version,
-                                               available_map_range,
-                                               relative_range,
-                                               map,
-                                               macho,
-                                               sect_offset,
-                                               sect_size,
-                                               options);
-
-                    if (parse_section_result != E_MACHO_FILE_PARSE_OK) {
-                        return parse_section_result;
-                    }
-                }
+        .arch_bit = arch_bit,
 
-                if (info_in->swift_version != 0) {
-                    const bool ignore_conflicting_fields =
-                        options & O_MACHO_FILE_PARSE_IGNORE_CONFLICTING_FIELDS;
+        .tbd_options = tbd_options,
+        .options = options,
 
-                    if (!ignore_conflicting_fields) {
-                        if (info_in->swift_version != swift_version) {
-                            return E_MACHO_FILE_PARSE_CONFLICTING_SWIFT_VERSION;
-                        }
-                    }
-                } else {
-                    info_in->swift_version = swift_version;
-                }
+        .is_64 = is_64,
+        .copy_strings = copy_strings,
 
-                break;
-            }
+        .map_info = parse_info
+    };
 
-            default: {
-                const bool copy_strings =
-                    options & O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
-
-                const enum macho_file_parse_result parse_load_command_result =
-                    parse_load_command(info_in,
-                                       &uuid_info,
-                                       &found_uuid,
-                                       arch_bit,
-                                       load_cmd,
-                                       load_cmd_iter,
-                                       is_big_endian,
-                                       tbd_options,
-                                       options,
-                                       copy_strings,
-                                       &found_identification,
-                                       &symtab);
-
-                if (parse_load_command_result != E_MACHO_FILE_PARSE_OK) {
-                    return parse_load_command_result;
-                }
+    struct load_commands_state state = {
+        .uuid_info = { .arch = parse_info->arch }
+    };
 
-                break;
-            }
-        }
+    const enum macho_file_parse_result parse_load_commands_result =
+        parse_load_commands(info_in, &load_cmds, &state, is_big_endian);
 
-        load_cmd_iter += load_cmd.cmdsize;
+    if (parse_load_commands_result != E_MACHO_FILE_PARSE_OK) {
+        return parse_load_commands_result;
     }
 
-    if (!found_identification) {
+    if (!state.found_identification) {
         return E_MACHO_FILE_PARSE_NO_IDENTIFICATION;
     }
 
     if (!(tbd_options & O_TBD_PARSE_IGNORE_UUID)) {
-        if (!found_uuid) {
+        if (!state.found_uuid) {
             return E_MACHO_FILE_PARSE_NO_UUID;
         }
     }
 
-    /*
-     * Ensure that the uuid found is unique among all other containers before
-     * adding to the fd's uuid arrays.
-     */
-
-    const uint8_t *const array_uuid =
-        array_find_item(&info_in->uuids,
-                        sizeof(uuid_info),
-                        &uuid_info,
-                        tbd_uuid_info_comparator,
-                        NULL);
-
-    if (array_uuid != NULL) {
-        return E_MACHO_FILE_PARSE_CONFLICTING_UUID;
-    }
-
-    const enum array_result add_uuid_info_result =
-        array_add_item(&info_in->uuids, sizeof(uuid_info), &uuid_info, NULL);
+    const enum macho_file_parse_result add_uuid_info_result =
+        add_uuid_info(info_in, &state.uuid_info);
 
-    if (add_uuid_info_result != E_ARRAY_OK) {
-        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    if (add_uuid_info_result != E_MACHO_FILE_PARSE_OK) {
+        return add_uuid_info_result;
     }
 
+    const struct symtab_command symtab = state.symtab;
     if (symtab.cmd != LC_SYMTAB) {
         if (tbd_options & O_TBD_PARSE_IGNORE_SYMBOLS) {
             return E_MACHO_FILE_PARSE_OK;
@@ -2036,60 +1819,34 @@ macho_file_parse_load_commands_from_map(
         return E_MACHO_FILE_PARSE_NO_SYMBOL_TABLE;
     }
 
-    /*
-     * Retrieve the symbol-table and string-table info via the symtab_command.
-     */
-
-    if (is_big_endian) {
-        symtab.symoff = swap_uint32(symtab.symoff);
-        symtab.nsyms = swap_uint32(symtab.nsyms);
-
-        symtab.stroff = swap_uint32(symtab.stroff);
-        symtab.strsize = swap_uint32(symtab.strsize);
-    }
-
+    const struct linkedit_data_command export_trie = state.export_trie;
     if (symtab_out != NULL) {
         *symtab_out = symtab;
     }
 
+    if (export_trie_out != NULL) {
+        *export_trie_out = export_trie;
+    }
+
     if (options & O_MACHO_FILE_PARSE_DONT_PARSE_SYMBOL_TABLE) {
         return E_MACHO_FILE_PARSE_OK;
     }
 
-    /*
-     * Verify the symbol-table's information.
-     */
+    const struct mf_parse_exports_info exports_info = {
+        .map = map,
 
-    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
-    if (is_64) {
-        ret =
-            macho_file_parse_symbols_64_from_map(info_in,
-                                                 map,
-                                                 available_map_range,
-                                                 arch_bit,
-                                                 is_big_endian,
-                                                 symtab.symoff,
-                                                 symtab.nsyms,
-                                                 symtab.stroff,
-                                                 symtab.strsize,
-                                                 tbd_options);
-    } else {
-        ret =
-            macho_file_parse_symbols_from_map(info_in,
-                                              map,
-                                              available_map_range,
-                                              arch_bit,
-                                              is_big_endian,
-                                              symtab.symoff,
-                                              symtab.nsyms,
-                                              symtab.stroff,
-                                              symtab.strsize,
-                                              tbd_options);
-    }
+        .available_range = available_map_range,
+        .arch_bit = arch_bit,
 
-    if (ret != E_MACHO_FILE_PARSE_OK) {
-        return ret;
-    }
+        .is_64 = is_64,
+        .is_big_endian = is_big_endian,
 
-    return E_MACHO_FILE_PARSE_OK;
+        .symtab = symtab,
+        .export_trie = export_trie,
+
+        .tbd_options = tbd_options,
+        .options = options
+    };
+
+    return macho_file_parse_exports(info_in, &exports_info);
 }
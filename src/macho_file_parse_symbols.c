@@ -15,7 +15,6 @@
 #include "mach-o/nlist.h"
 
 #include "arch_info.h"
-#include "copy.h"
 
 #include "guard_overflow.h"
 #include "macho_file_parse_symbols.h"
@@ -26,6 +25,32 @@
 #include "tbd.h"
 #include "yaml.h"
 
+/*
+ * Most of a symbol-table's symbols are usually local or undefined, so reserving
+ * space for every symbol would over-allocate the exports array and export-set,
+ * which are kept for the next file. Instead, reserve space for up to
+ * max_reserved_exports exports, past which the exports array simply grows.
+ */
+
+static const uint32_t max_reserved_exports = 4096;
+
+static enum array_result
+reserve_exports_for_symbols(struct tbd_create_info *const info_in,
+                            const uint32_t nsyms)
+{
+    const uint64_t exports_count =
+        array_get_item_count(&info_in->exports,
+                             sizeof(struct tbd_export_info));
+
+    uint32_t reserved_count = nsyms;
+    if (reserved_count > max_reserved_exports) {
+        reserved_count = max_reserved_exports;
+    }
+
+    return tbd_create_info_reserve_exports(info_in,
+                                           exports_count + reserved_count);
+}
+
 /*
  * For performance, compare strings using the largest byte-size integers
  * possible, instead of iterating with strncmp.
@@ -35,8 +60,7 @@ static inline bool
 is_objc_class_symbol(const char *const symbol,
                      const uint64_t first,
                      const uint32_t max_length,
-                     const char **const symbol_out,
-                     uint32_t *const length_out)
+                     const char **const symbol_out)
 {
     if (max_length < 13) {
         return false;
@@ -67,8 +91,6 @@ is_objc_class_symbol(const char *const symbol,
             const char *const real_symbol = symbol + 13;
 
             *symbol_out = real_symbol;
-            *length_out = (uint32_t)strnlen(real_symbol, max_length - 13);
-
             break;
         }
 
@@ -98,8 +120,6 @@ is_objc_class_symbol(const char *const symbol,
             const char *const real_symbol = symbol + 17;
 
             *symbol_out = real_symbol;
-            *length_out = (uint32_t)strnlen(real_symbol, max_length - 17);
-
             break;
         }
 
@@ -125,9 +145,6 @@ is_objc_class_symbol(const char *const symbol,
             const char *const real_symbol = symbol + 16;
 
             *symbol_out = real_symbol;
-            *length_out = (uint32_t)strnlen(real_symbol, max_length - 16);
-
-
             break;
         }
 
@@ -160,53 +177,30 @@ bool is_objc_ivar_symbol(const char *const symbol, const uint64_t first) {
     return true;
 }
 
-static enum macho_file_parse_result
-add_export_info(uint64_t *const export_count_in,
-                struct tbd_create_info *const info,
-                struct tbd_export_info export_info)
-{
-    const bool needs_quotes =
-        yaml_check_c_str(export_info.string, export_info.length);
-
-    if (needs_quotes) {
-        export_info.flags |= F_TBD_EXPORT_INFO_STRING_NEEDS_QUOTES;
-    }
-
-    /*
-     * Add our symbol-info to the list, as a matching symbol-info was not found.
-     *
-     * Note: As the symbol is from a large allocation in the call hierarchy that
-     * will eventually be freed, we need to allocate a copy of the symbol before
-     * placing it in the list.
-     */
-
-    export_info.string = alloc_and_copy(export_info.string, export_info.length);
-    if (export_info.string == NULL) {
-        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
-    }
-
-    struct array *const exports = &info->exports;
-    const enum array_result add_export_info_result =
-        array_add_item(exports, sizeof(export_info), &export_info, NULL);
+static inline bool allows_private_symbols(const uint64_t options) {
+    const uint64_t all_allow_symbols_flags =
+        O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_OBJC_CLASS_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_OBJC_IVAR_SYMBOLS |
+        O_TBD_PARSE_ALLOW_PRIVATE_WEAK_DEF_SYMBOLS;
 
-    if (add_export_info_result != E_ARRAY_OK) {
-        free(export_info.string);
-        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
-    }
-
-    *export_count_in += 1;
-    return E_MACHO_FILE_PARSE_OK;
+    return options & all_allow_symbols_flags;
 }
 
-static enum macho_file_parse_result
+/*
+ * handle_symbol() is always inlined into scan_symbol_table(), so that it's
+ * specialized for whether only external symbols reach it.
+ */
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
 handle_symbol(struct tbd_create_info *const info_in,
-              uint64_t *const exports_count_in,
               const uint64_t arch_bit,
               const uint32_t index,
               const uint32_t strsize,
               const char *const symbol_string,
               const uint16_t n_desc,
-              const uint8_t n_type,
+              const bool is_external,
+              const bool copy_strings,
               const uint64_t options)
 {
     /*
@@ -214,14 +208,8 @@ handle_symbol(struct tbd_create_info *const info_in,
      * provided to allow any type of non-external symbols.
      */
 
-    if (!(n_type & N_EXT)) {
-        const uint64_t all_allow_symbols_flags =
-            O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS |
-            O_TBD_PARSE_ALLOW_PRIVATE_OBJC_CLASS_SYMBOLS |
-            O_TBD_PARSE_ALLOW_PRIVATE_OBJC_IVAR_SYMBOLS |
-            O_TBD_PARSE_ALLOW_PRIVATE_WEAK_DEF_SYMBOLS;
-
-        if (!(options & all_allow_symbols_flags)) {
+    if (!is_external) {
+        if (!allows_private_symbols(options)) {
             return E_MACHO_FILE_PARSE_OK;
         }
     }
@@ -237,17 +225,14 @@ handle_symbol(struct tbd_create_info *const info_in,
      */
 
     enum tbd_export_type symbol_type = TBD_EXPORT_TYPE_NORMAL_SYMBOL;
-    uint32_t length = 0;
-
     if (n_desc & N_WEAK_DEF) {
         if (!(options & O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS)) {
-            if (!(n_type & N_EXT)) {
+            if (!is_external) {
                 return E_MACHO_FILE_PARSE_OK;
             }
         }
 
         symbol_type = TBD_EXPORT_TYPE_WEAK_DEF_SYMBOL;
-        length = (uint32_t)strnlen(symbol_string, max_len);
     } else {
         /*
          * Only check for symbols who max potential length is greater than 12,
@@ -258,9 +243,9 @@ handle_symbol(struct tbd_create_info *const info_in,
             const uint64_t first = *(const uint64_t *)string;
             const char *const str = string;
 
-            if (is_objc_class_symbol(str, first, max_len, &string, &length)) {
+            if (is_objc_class_symbol(str, first, max_len, &string)) {
                 if (!(options & O_TBD_PARSE_ALLOW_PRIVATE_OBJC_CLASS_SYMBOLS)) {
-                    if (!(n_type & N_EXT)) {
+                    if (!is_external) {
                         return E_MACHO_FILE_PARSE_OK;
                     }
                 }
@@ -268,39 +253,44 @@ handle_symbol(struct tbd_create_info *const info_in,
                 symbol_type = TBD_EXPORT_TYPE_OBJC_CLASS_SYMBOL;
             } else if (is_objc_ivar_symbol(symbol_string, first)) {
                 if (!(options & O_TBD_PARSE_ALLOW_PRIVATE_OBJC_IVAR_SYMBOLS)) {
-                    if (!(n_type & N_EXT)) {
+                    if (!is_external) {
                         return E_MACHO_FILE_PARSE_OK;
                     }
                 }
 
                 string += 12;
-                length = (uint32_t)strnlen(string, max_len - 12);
-
                 symbol_type = TBD_EXPORT_TYPE_OBJC_IVAR_SYMBOL;
             } else {
                 if (!(options & O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS)) {
-                    if (!(n_type & N_EXT)) {
+                    if (!is_external) {
                         return E_MACHO_FILE_PARSE_OK;
                     }
                 }
-
-                length = (uint32_t)strnlen(string, max_len);
-            }
-
-            if (length == 0) {
-                return E_MACHO_FILE_PARSE_OK;
             }
         } else {
             if (!(options & O_TBD_PARSE_ALLOW_PRIVATE_NORMAL_SYMBOLS)) {
-                if (!(n_type & N_EXT)) {
+                if (!is_external) {
                     return E_MACHO_FILE_PARSE_OK;
                 }
             }
-
-            length = (uint32_t)strnlen(string, max_len);
         }
     }
 
+    /*
+     * Find the length of the (prefix-stripped) symbol, and whether it needs
+     * quotes, in a single pass over the string.
+     */
+
+    const uint32_t offset = (uint32_t)(string - symbol_string);
+
+    bool needs_quotes = false;
+    const uint32_t length =
+        (uint32_t)yaml_scan_c_str(string, max_len - offset, &needs_quotes);
+
+    if (length == 0) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
     struct tbd_export_info export_info = {
         .archs = arch_bit,
         .archs_count = 1,
@@ -309,27 +299,9 @@ handle_symbol(struct tbd_create_info *const info_in,
         .type = symbol_type,
     };
 
-    struct array *const exports = &info_in->exports;
-    const uint64_t exports_count = *exports_count_in;
-
-    if (exports_count == 0) {
-        return add_export_info(exports_count_in, info_in, export_info);
-    }
-
-    const struct array_slice slice = {
-        .front = 0,
-        .back = exports_count - 1
-    };
-
-    struct array_cached_index_info cached_info = {};
+    uint64_t hash = 0;
     struct tbd_export_info *const existing_info =
-        array_find_item_in_sorted_with_slice(
-            exports,
-            sizeof(export_info),
-            slice,
-            &export_info,
-            tbd_export_info_no_archs_comparator,
-            &cached_info);
+        tbd_create_info_find_export(info_in, &export_info, &hash);
 
     if (existing_info != NULL) {
         const uint64_t archs = existing_info->archs;
@@ -347,7 +319,6 @@ handle_symbol(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_OK;
     }
 
-    const bool needs_quotes = yaml_check_c_str(string, length);
     if (needs_quotes) {
         export_info.flags |= F_TBD_EXPORT_INFO_STRING_NEEDS_QUOTES;
     }
@@ -355,32 +326,281 @@ handle_symbol(struct tbd_create_info *const info_in,
     /*
      * Add our symbol-info to the list, as a matching symbol-info was not found.
      *
-     * Note: As the symbol is from a large allocation in the call hierarchy that
-     * will eventually be freed, we need to allocate a copy of the symbol before
-     * placing it in the list.
+     * If allowed, and the string is null-terminated within the string-table,
+     * the symbol is borrowed from the map. Otherwise, as the symbol is from a
+     * large allocation in the call hierarchy that will eventually be freed, we
+     * need to copy the symbol into the export-strings pool before placing it in
+     * the list.
      */
 
-    export_info.string = alloc_and_copy(export_info.string, export_info.length);
-    if (export_info.string == NULL) {
-        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    const bool is_terminated = offset + length < max_len;
+
+    if (!copy_strings && is_terminated) {
+        export_info.flags |= F_TBD_EXPORT_INFO_STRING_IS_BORROWED;
+    } else {
+        export_info.string =
+            string_pool_copy_string(&info_in->export_strings,
+                                    export_info.string,
+                                    export_info.length);
+
+        if (export_info.string == NULL) {
+            return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+        }
     }
 
+    /*
+     * Any copied string is left in the pool if adding the export-info fails,
+     * and is reclaimed when the pool is reset.
+     */
+
     const enum array_result add_export_info_result =
-        array_add_item_with_cached_index_info(exports,
-                                              sizeof(export_info),
-                                              &export_info,
-                                              &cached_info,
-                                              NULL);
+        tbd_create_info_add_export(info_in, &export_info, hash);
 
     if (add_export_info_result != E_ARRAY_OK) {
-        free(export_info.string);
         return E_MACHO_FILE_PARSE_ARRAY_FAIL;
     }
 
-    *exports_count_in = exports_count + 1;
     return E_MACHO_FILE_PARSE_OK;
 }
 
+struct symbol_table {
+    const uint8_t *symbol_table;
+    const char *string_table;
+
+    uint32_t nsyms;
+    uint32_t strsize;
+
+    uint64_t arch_bit;
+    uint64_t tbd_options;
+
+    bool copy_strings;
+};
+
+/*
+ * Returns whether an nlist with n_type should be handed to handle_symbol().
+ * Only symbols that either connect back to a section, or are indirect, are
+ * parsed, and only external ones when private symbols aren't allowed.
+ */
+
+static inline bool
+is_candidate_symbol(const uint8_t n_type, const bool external_only) {
+    const uint8_t type = n_type & N_TYPE;
+    if (type != N_SECT && type != N_INDR) {
+        return false;
+    }
+
+    if (external_only) {
+        if (!(n_type & N_EXT)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Most entries in a symbol-table are locals or undefined symbols, so the
+ * n_types of 8 nlists are gathered into a single word and checked at once,
+ * letting blocks with no candidate symbols be skipped entirely.
+ *
+ * N_SECT (0xe) and N_INDR (0xa) differ only in 0x4, so setting 0x4 in every
+ * byte leaves a candidate's byte equal to N_SECT (with N_EXT if required).
+ */
+
+static inline bool
+block_has_candidate_symbol(const uint64_t n_types, const bool external_only) {
+    const uint64_t ones = 0x0101010101010101ull;
+
+    uint64_t mask = N_TYPE * ones;
+    uint64_t expected = N_SECT * ones;
+
+    if (external_only) {
+        mask |= N_EXT * ones;
+        expected |= N_EXT * ones;
+    }
+
+    const uint64_t set = (n_types | ((N_SECT ^ N_INDR) * ones)) & mask;
+    const uint64_t misses = set ^ expected;
+
+    /*
+     * A candidate's byte is zero in misses.
+     */
+
+    return (misses - ones) & ~misses & (0x80 * ones);
+}
+
+static inline __attribute__((always_inline)) uint8_t
+get_nlist_type(const uint8_t *const nlist, const bool is_64) {
+    if (is_64) {
+        return ((const struct nlist_64 *)nlist)->n_type;
+    }
+
+    return ((const struct nlist *)nlist)->n_type;
+}
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
+handle_nlist(struct tbd_create_info *const info_in,
+             const struct symbol_table *const table,
+             const uint8_t *const nlist,
+             const bool is_64,
+             const bool is_big_endian,
+             const bool external_only)
+{
+    const uint8_t n_type = get_nlist_type(nlist, is_64);
+    if (!is_candidate_symbol(n_type, external_only)) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    uint32_t index = 0;
+    uint16_t n_desc = 0;
+
+    if (is_64) {
+        const struct nlist_64 *const entry = (const struct nlist_64 *)nlist;
+
+        index = entry->n_un.n_strx;
+        n_desc = entry->n_desc;
+    } else {
+        const struct nlist *const entry = (const struct nlist *)nlist;
+
+        index = entry->n_un.n_strx;
+        n_desc = (uint16_t)entry->n_desc;
+    }
+
+    if (is_big_endian) {
+        index = swap_uint32(index);
+        n_desc = swap_uint16(n_desc);
+    }
+
+    /*
+     * For leniency reasons, ignore invalid symbol-references instead of
+     * erroring out.
+     */
+
+    const uint32_t strsize = table->strsize;
+    if (index >= strsize) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    const bool is_external = external_only || (n_type & N_EXT);
+    return handle_symbol(info_in,
+                         table->arch_bit,
+                         index,
+                         strsize,
+                         table->string_table + index,
+                         n_desc,
+                         is_external,
+                         table->copy_strings,
+                         table->tbd_options);
+}
+
+/*
+ * The symbol-table kernel, instantiated by parse_symbol_table() for every
+ * layout (32/64-bit and endianness), and for whether private symbols are
+ * allowed, so that none of these are checked per symbol.
+ */
+
+static inline __attribute__((always_inline)) enum macho_file_parse_result
+scan_symbol_table(struct tbd_create_info *const info_in,
+                  const struct symbol_table *const table,
+                  const bool is_64,
+                  const bool is_big_endian,
+                  const bool external_only)
+{
+    const uint64_t nlist_size =
+        is_64 ? sizeof(struct nlist_64) : sizeof(struct nlist);
+
+    const uint32_t nsyms = table->nsyms;
+
+    const uint8_t *nlist = table->symbol_table;
+    const uint8_t *const end = nlist + nlist_size * nsyms;
+    const uint8_t *const blocks_end =
+        nlist + nlist_size * (nsyms & ~(uint32_t)7);
+
+    while (nlist != blocks_end) {
+        uint64_t n_types = 0;
+        for (uint64_t i = 0; i != 8; i++) {
+            const uint8_t *const iter = nlist + nlist_size * i;
+            const uint8_t n_type = get_nlist_type(iter, is_64);
+
+            n_types |= (uint64_t)n_type << (i * 8);
+        }
+
+        const uint8_t *const block_end = nlist + nlist_size * 8;
+        if (!block_has_candidate_symbol(n_types, external_only)) {
+            nlist = block_end;
+            continue;
+        }
+
+        for (; nlist != block_end; nlist += nlist_size) {
+            const enum macho_file_parse_result handle_nlist_result =
+                handle_nlist(info_in,
+                             table,
+                             nlist,
+                             is_64,
+                             is_big_endian,
+                             external_only);
+
+            if (handle_nlist_result != E_MACHO_FILE_PARSE_OK) {
+                return handle_nlist_result;
+            }
+        }
+    }
+
+    for (; nlist != end; nlist += nlist_size) {
+        const enum macho_file_parse_result handle_nlist_result =
+            handle_nlist(info_in,
+                         table,
+                         nlist,
+                         is_64,
+                         is_big_endian,
+                         external_only);
+
+        if (handle_nlist_result != E_MACHO_FILE_PARSE_OK) {
+            return handle_nlist_result;
+        }
+    }
+
+    return E_MACHO_FILE_PARSE_OK;
+}
+
+static enum macho_file_parse_result
+parse_symbol_table(struct tbd_create_info *const info_in,
+                   const struct symbol_table *const table,
+                   const bool is_64,
+                   const bool is_big_endian)
+{
+    const bool external_only = !allows_private_symbols(table->tbd_options);
+    if (is_64) {
+        if (is_big_endian) {
+            if (external_only) {
+                return scan_symbol_table(info_in, table, true, true, true);
+            }
+
+            return scan_symbol_table(info_in, table, true, true, false);
+        }
+
+        if (external_only) {
+            return scan_symbol_table(info_in, table, true, false, true);
+        }
+
+        return scan_symbol_table(info_in, table, true, false, false);
+    }
+
+    if (is_big_endian) {
+        if (external_only) {
+            return scan_symbol_table(info_in, table, false, true, true);
+        }
+
+        return scan_symbol_table(info_in, table, false, true, false);
+    }
+
+    if (external_only) {
+        return scan_symbol_table(info_in, table, false, false, true);
+    }
+
+    return scan_symbol_table(info_in, table, false, false, false);
+}
+
 enum macho_file_parse_result
 macho_file_parse_symbols_from_file(struct tbd_create_info *const info_in,
                                    const int fd,
@@ -492,108 +712,33 @@ macho_file_parse_symbols_from_file(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_READ_FAIL;
     }
 
-    uint64_t exports_count =
-        array_get_item_count(&info_in->exports, sizeof(struct tbd_export_info));
-
-    const struct nlist *nlist = symbol_table;
-    const struct nlist *const end = symbol_table + nsyms;
+    const enum array_result reserve_exports_result =
+        reserve_exports_for_symbols(info_in, nsyms);
 
-    if (is_big_endian) {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
-
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
-
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
-
-            const uint32_t index = swap_uint32(nlist->n_un.n_strx);
-            if (index >= strsize) {
-                continue;
-            }
-
-            const int16_t n_desc = swap_int16(nlist->n_desc);
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              (uint16_t)n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                free(symbol_table);
-                free(string_table);
-
-                return handle_symbol_result;
-            }
-        }
-    } else {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
+    if (reserve_exports_result != E_ARRAY_OK) {
+        free(symbol_table);
+        free(string_table);
 
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
 
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
+    const struct symbol_table table = {
+        .symbol_table = (const uint8_t *)symbol_table,
+        .string_table = string_table,
+        .nsyms = nsyms,
+        .strsize = strsize,
+        .arch_bit = arch_bit,
+        .tbd_options = tbd_options,
+        .copy_strings = true
+    };
 
-            const uint32_t index = nlist->n_un.n_strx;
-            if (index >= strsize) {
-                continue;
-            }
-
-            const int16_t n_desc = swap_int16(nlist->n_desc);
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              (uint16_t)n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                free(symbol_table);
-                free(string_table);
-
-                return handle_symbol_result;
-            }
-        }
-    }
+    const enum macho_file_parse_result parse_table_result =
+        parse_symbol_table(info_in, &table, false, is_big_endian);
 
     free(symbol_table);
     free(string_table);
 
-    return E_MACHO_FILE_PARSE_OK;
+    return parse_table_result;
 }
 
 enum macho_file_parse_result
@@ -707,108 +852,33 @@ macho_file_parse_symbols_64_from_file(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_READ_FAIL;
     }
 
-    uint64_t exports_count =
-        array_get_item_count(&info_in->exports, sizeof(struct tbd_export_info));
-
-    const struct nlist_64 *nlist = symbol_table;
-    const struct nlist_64 *const end = symbol_table + nsyms;
-
-    if (is_big_endian) {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
+    const enum array_result reserve_exports_result =
+        reserve_exports_for_symbols(info_in, nsyms);
 
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
-
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
-
-            const uint32_t index = swap_uint32(nlist->n_un.n_strx);
-            if (index >= strsize) {
-                continue;
-            }
-
-            const uint16_t n_desc = swap_uint16(nlist->n_desc);
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                free(symbol_table);
-                free(string_table);
-
-                return handle_symbol_result;
-            }
-        }
-    } else {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
-
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
+    if (reserve_exports_result != E_ARRAY_OK) {
+        free(symbol_table);
+        free(string_table);
 
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
 
-            const uint32_t index = nlist->n_un.n_strx;
-            if (index >= strsize) {
-                continue;
-            }
+    const struct symbol_table table = {
+        .symbol_table = (const uint8_t *)symbol_table,
+        .string_table = string_table,
+        .nsyms = nsyms,
+        .strsize = strsize,
+        .arch_bit = arch_bit,
+        .tbd_options = tbd_options,
+        .copy_strings = true
+    };
 
-            const uint16_t n_desc = nlist->n_desc;
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                free(symbol_table);
-                free(string_table);
-
-                return handle_symbol_result;
-            }
-        }
-    }
+    const enum macho_file_parse_result parse_table_result =
+        parse_symbol_table(info_in, &table, true, is_big_endian);
 
     free(symbol_table);
     free(string_table);
 
-    return E_MACHO_FILE_PARSE_OK;
+    return parse_table_result;
 }
 
 enum macho_file_parse_result
@@ -821,7 +891,8 @@ macho_file_parse_symbols_from_map(struct tbd_create_info *const info_in,
                                   const uint32_t nsyms,
                                   const uint32_t stroff,
                                   const uint32_t strsize,
-                                  const uint64_t tbd_options)
+                                  const uint64_t tbd_options,
+                                  const uint64_t options)
 {
     if (nsyms == 0) {
         return E_MACHO_FILE_PARSE_OK;
@@ -863,101 +934,27 @@ macho_file_parse_symbols_from_map(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_INVALID_SYMBOL_TABLE;
     }
 
-    uint64_t exports_count =
-        array_get_item_count(&info_in->exports, sizeof(struct tbd_export_info));
-
-    const char *const string_table = (const char *)(map + stroff);
-
-    const struct nlist *nlist = (const struct nlist *)(map + symoff);
-    const struct nlist *const end = nlist + nsyms;
-
-    if (is_big_endian) {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
-
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
-
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
-
-            const uint32_t index = swap_uint32(nlist->n_un.n_strx);
-            if (index >= strsize) {
-                continue;
-            }
-
-            const int16_t n_desc = swap_int16(nlist->n_desc);
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              (uint16_t)n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                return handle_symbol_result;
-            }
-        }
-    } else {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol connects back to __TEXT, or is an
-             * indirect symbol.
-             */
-
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
-
-            if (type != N_SECT && type != N_INDR) {
-                continue;
-            }
-
-            /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
-             */
-
-            const uint32_t index = nlist->n_un.n_strx;
-            if (index >= strsize) {
-                continue;
-            }
+    const enum array_result reserve_exports_result =
+        reserve_exports_for_symbols(info_in, nsyms);
 
-            const int16_t n_desc = nlist->n_desc;
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              (uint16_t)n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                return handle_symbol_result;
-            }
-        }
+    if (reserve_exports_result != E_ARRAY_OK) {
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
     }
 
-    return E_MACHO_FILE_PARSE_OK;
+    const char *const string_table = (const char *)(map + stroff);
+    const bool copy_strings = options & O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
+
+    const struct symbol_table table = {
+        .symbol_table = map + symoff,
+        .string_table = string_table,
+        .nsyms = nsyms,
+        .strsize = strsize,
+        .arch_bit = arch_bit,
+        .tbd_options = tbd_options,
+        .copy_strings = copy_strings
+    };
+
+    return parse_symbol_table(info_in, &table, false, is_big_endian);
 }
 
 enum macho_file_parse_result
@@ -970,7 +967,8 @@ macho_file_parse_symbols_64_from_map(struct tbd_create_info *const info_in,
                                      const uint32_t nsyms,
                                      const uint32_t stroff,
                                      const uint32_t strsize,
-                                     const uint64_t tbd_options)
+                                     const uint64_t tbd_options,
+                                     const uint64_t options)
 {
     if (nsyms == 0) {
         return E_MACHO_FILE_PARSE_OK;
@@ -1017,99 +1015,516 @@ macho_file_parse_symbols_64_from_map(struct tbd_create_info *const info_in,
         return E_MACHO_FILE_PARSE_INVALID_SYMBOL_TABLE;
     }
 
-    uint64_t exports_count =
-        array_get_item_count(&info_in->exports, sizeof(struct tbd_export_info));
+    const enum array_result reserve_exports_result =
+        reserve_exports_for_symbols(info_in, nsyms);
+
+    if (reserve_exports_result != E_ARRAY_OK) {
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
 
     const char *const string_table = (const char *)(map + stroff);
+    const bool copy_strings = options & O_MACHO_FILE_PARSE_COPY_STRINGS_IN_MAP;
+
+    const struct symbol_table table = {
+        .symbol_table = map + symoff,
+        .string_table = string_table,
+        .nsyms = nsyms,
+        .strsize = strsize,
+        .arch_bit = arch_bit,
+        .tbd_options = tbd_options,
+        .copy_strings = copy_strings
+    };
 
-    const struct nlist_64 *nlist = (const struct nlist_64 *)(map + symoff);
-    const struct nlist_64 *const end = nlist + nsyms;
+    return parse_symbol_table(info_in, &table, true, is_big_endian);
+}
 
-    if (is_big_endian) {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol either connects back to __TEXT, or is an
-             * indirect symbol.
-             */
+static inline bool
+read_uleb128(const uint8_t **const iter_in,
+             const uint8_t *const end,
+             uint64_t *const value_out)
+{
+    const uint8_t *iter = *iter_in;
 
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
+    uint64_t value = 0;
+    uint32_t shift = 0;
 
-            if (type != N_SECT && type != N_INDR) {
-                continue;
+    do {
+        if (iter == end || shift > 63) {
+            return false;
+        }
+
+        const uint8_t byte = *iter;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+
+        iter++;
+        shift += 7;
+
+        if (!(byte & 0x80)) {
+            break;
+        }
+    } while (true);
+
+    *iter_in = iter;
+    *value_out = value;
+
+    return true;
+}
+
+/*
+ * A node to be visited in the export-trie, along with the edge-string leading
+ * to it and the length of the name built up to its parent.
+ */
+
+struct export_trie_node {
+    uint32_t offset;
+
+    uint32_t edge_offset;
+    uint32_t edge_length;
+
+    uint32_t prefix_length;
+};
+
+static enum macho_file_parse_result
+parse_export_trie(struct tbd_create_info *const info_in,
+                  const uint64_t arch_bit,
+                  const uint8_t *const trie,
+                  const uint32_t trie_size,
+                  const uint64_t tbd_options)
+{
+    const uint8_t *const trie_end = trie + trie_size;
+
+    /*
+     * Walk the trie depth-first with an explicit stack, building each node's
+     * name in a single buffer. A node's siblings only ever write past their
+     * shared prefix, so the prefix is still intact when a sibling is popped.
+     */
+
+    uint64_t stack_capacity = 64;
+    uint64_t stack_count = 1;
+
+    struct export_trie_node *stack =
+        malloc(sizeof(struct export_trie_node) * stack_capacity);
+
+    if (stack == NULL) {
+        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    }
+
+    uint64_t name_capacity = 256;
+    char *name = malloc(name_capacity);
+
+    if (name == NULL) {
+        free(stack);
+        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    }
+
+    stack[0] = (struct export_trie_node){};
+
+    /*
+     * Every node takes up at least two bytes, so a well-formed trie can't have
+     * more nodes than its size in bytes. Visiting more nodes than that means
+     * the trie has a cycle.
+     */
+
+    uint64_t nodes_left = trie_size;
+    enum macho_file_parse_result ret = E_MACHO_FILE_PARSE_OK;
+
+    while (stack_count != 0) {
+        if (nodes_left == 0) {
+            ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+            break;
+        }
+
+        nodes_left--;
+        stack_count--;
+
+        const struct export_trie_node node = stack[stack_count];
+        const uint64_t name_length =
+            (uint64_t)node.prefix_length + node.edge_length;
+
+        if (name_length + 1 > name_capacity) {
+            do {
+                name_capacity *= 2;
+            } while (name_length + 1 > name_capacity);
+
+            char *const new_name = realloc(name, name_capacity);
+            if (new_name == NULL) {
+                ret = E_MACHO_FILE_PARSE_ALLOC_FAIL;
+                break;
+            }
+
+            name = new_name;
+        }
+
+        memcpy(name + node.prefix_length,
+               trie + node.edge_offset,
+               node.edge_length);
+
+        name[name_length] = '\0';
+
+        const uint8_t *iter = trie + node.offset;
+        uint64_t terminal_size = 0;
+
+        if (!read_uleb128(&iter, trie_end, &terminal_size)) {
+            ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+            break;
+        }
+
+        if (terminal_size > (uint64_t)(trie_end - iter)) {
+            ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+            break;
+        }
+
+        if (terminal_size != 0) {
+            const uint8_t *const terminal_end = iter + terminal_size;
+            uint64_t flags = 0;
+
+            if (!read_uleb128(&iter, terminal_end, &flags)) {
+                ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+                break;
             }
 
             /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
+             * Absolute symbols don't connect back to a section, and so are
+             * skipped, just as they are when parsing the symbol-table.
+             *
+             * Every other terminal is an exported symbol, which we pass to
+             * handle_symbol() as an external symbol, with the string-table
+             * being just the name we built.
              */
 
-            const uint32_t index = swap_uint32(nlist->n_un.n_strx);
-            if (index >= strsize) {
-                continue;
+            const uint64_t kind = flags & EXPORT_SYMBOL_FLAGS_KIND_MASK;
+            if (kind != EXPORT_SYMBOL_FLAGS_KIND_ABSOLUTE) {
+                uint16_t n_desc = 0;
+                if (flags & EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION) {
+                    n_desc = N_WEAK_DEF;
+                }
+
+                ret =
+                    handle_symbol(info_in,
+                                  arch_bit,
+                                  0,
+                                  (uint32_t)name_length + 1,
+                                  name,
+                                  n_desc,
+                                  true,
+                                  true,
+                                  tbd_options);
+
+                if (ret != E_MACHO_FILE_PARSE_OK) {
+                    break;
+                }
             }
 
-            const uint16_t n_desc = swap_uint16(nlist->n_desc);
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                return handle_symbol_result;
+            iter = terminal_end;
+        }
+
+        if (iter == trie_end) {
+            ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+            break;
+        }
+
+        const uint8_t children_count = *iter;
+        iter++;
+
+        if (stack_count + children_count > stack_capacity) {
+            do {
+                stack_capacity *= 2;
+            } while (stack_count + children_count > stack_capacity);
+
+            const uint64_t stack_size =
+                sizeof(struct export_trie_node) * stack_capacity;
+
+            struct export_trie_node *const new_stack =
+                realloc(stack, stack_size);
+
+            if (new_stack == NULL) {
+                ret = E_MACHO_FILE_PARSE_ALLOC_FAIL;
+                break;
             }
+
+            stack = new_stack;
         }
-    } else {
-        for (; nlist != end; nlist++) {
-            /*
-             * Ensure that each symbol connects back to __TEXT, or is an
-             * indirect symbol.
-             */
 
-            const uint8_t n_type = nlist->n_type;
-            const uint8_t type = n_type & N_TYPE;
+        for (uint8_t i = 0; i != children_count; i++) {
+            const uint64_t edge_length =
+                strnlen((const char *)iter, (size_t)(trie_end - iter));
+
+            if (edge_length == (uint64_t)(trie_end - iter)) {
+                ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+                break;
+            }
+
+            const uint32_t edge_offset = (uint32_t)(iter - trie);
+            iter += edge_length + 1;
+
+            uint64_t child_offset = 0;
+            if (!read_uleb128(&iter, trie_end, &child_offset)) {
+                ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+                break;
+            }
 
-            if (type != N_SECT && type != N_INDR) {
-                continue;
+            if (child_offset >= trie_size) {
+                ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+                break;
             }
 
             /*
-             * For leniency reasons, ignore invalid symbol-references instead of
-             * erroring out.
+             * Names are limited to 32-bit lengths like every other export.
              */
 
-            const uint32_t index = nlist->n_un.n_strx;
-            if (index >= strsize) {
-                continue;
+            if (name_length + edge_length > UINT32_MAX - 1) {
+                ret = E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+                break;
             }
 
-            const uint16_t n_desc = nlist->n_desc;
-
-            const char *const symbol_string = string_table + index;
-            const enum macho_file_parse_result handle_symbol_result =
-                handle_symbol(info_in,
-                              &exports_count,
-                              arch_bit,
-                              index,
-                              strsize,
-                              symbol_string,
-                              n_desc,
-                              n_type,
-                              tbd_options);
-
-            if (handle_symbol_result != E_MACHO_FILE_PARSE_OK) {
-                return handle_symbol_result;
-            }
+            stack[stack_count] = (struct export_trie_node){
+                .offset = (uint32_t)child_offset,
+                .edge_offset = edge_offset,
+                .edge_length = (uint32_t)edge_length,
+                .prefix_length = (uint32_t)name_length
+            };
+
+            stack_count++;
+        }
+
+        if (ret != E_MACHO_FILE_PARSE_OK) {
+            break;
         }
     }
 
-    return E_MACHO_FILE_PARSE_OK;
+    free(stack);
+    free(name);
+
+    return ret;
+}
+
+enum macho_file_parse_result
+macho_file_parse_export_trie_from_file(struct tbd_create_info *const info_in,
+                                       const int fd,
+                                       const struct range full_range,
+                                       const struct range available_range,
+                                       const uint64_t arch_bit,
+                                       const uint32_t export_off,
+                                       const uint32_t export_size,
+                                       const uint64_t tbd_options)
+{
+    if (export_size == 0) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    uint64_t absolute_export_off = full_range.begin;
+    if (guard_overflow_add(&absolute_export_off, export_off)) {
+        return E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+    }
+
+    uint64_t export_end = absolute_export_off;
+    if (guard_overflow_add(&export_end, export_size)) {
+        return E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+    }
+
+    const struct range export_range = {
+        .begin = absolute_export_off,
+        .end = export_end
+    };
+
+    if (!range_contains_range(available_range, export_range)) {
+        return E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+    }
+
+    if (lseek(fd, (off_t)absolute_export_off, SEEK_SET) < 0) {
+        return E_MACHO_FILE_PARSE_SEEK_FAIL;
+    }
+
+    uint8_t *const trie = malloc(export_size);
+    if (trie == NULL) {
+        return E_MACHO_FILE_PARSE_ALLOC_FAIL;
+    }
+
+    if (read(fd, trie, export_size) < 0) {
+        free(trie);
+        return E_MACHO_FILE_PARSE_READ_FAIL;
+    }
+
+    const enum macho_file_parse_result ret =
+        parse_export_trie(info_in, arch_bit, trie, export_size, tbd_options);
+
+    free(trie);
+    return ret;
+}
+
+enum macho_file_parse_result
+macho_file_parse_export_trie_from_map(struct tbd_create_info *const info_in,
+                                      const uint8_t *const map,
+                                      const struct range available_range,
+                                      const uint64_t arch_bit,
+                                      const uint32_t export_off,
+                                      const uint32_t export_size,
+                                      const uint64_t tbd_options)
+{
+    if (export_size == 0) {
+        return E_MACHO_FILE_PARSE_OK;
+    }
+
+    const struct range export_range = {
+        .begin = export_off,
+        .end = (uint64_t)export_off + export_size
+    };
+
+    if (!range_contains_range(available_range, export_range)) {
+        return E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE;
+    }
+
+    const uint8_t *const trie = map + export_off;
+    return parse_export_trie(info_in, arch_bit, trie, export_size, tbd_options);
+}
+
+static enum macho_file_parse_result
+parse_trie_exports(struct tbd_create_info *const info_in,
+                   const struct mf_parse_exports_info *const parse_info)
+{
+    const struct range available_range = parse_info->available_range;
+    const struct linkedit_data_command export_trie = parse_info->export_trie;
+
+    const uint64_t arch_bit = parse_info->arch_bit;
+    const uint64_t tbd_options = parse_info->tbd_options;
+
+    if (parse_info->map != NULL) {
+        return macho_file_parse_export_trie_from_map(info_in,
+                                                     parse_info->map,
+                                                     available_range,
+                                                     arch_bit,
+                                                     export_trie.dataoff,
+                                                     export_trie.datasize,
+                                                     tbd_options);
+    }
+
+    return macho_file_parse_export_trie_from_file(info_in,
+                                                  parse_info->fd,
+                                                  parse_info->full_range,
+                                                  available_range,
+                                                  arch_bit,
+                                                  export_trie.dataoff,
+                                                  export_trie.datasize,
+                                                  tbd_options);
+}
+
+static enum macho_file_parse_result
+parse_symbol_table_exports(
+    struct tbd_create_info *const info_in,
+    const struct mf_parse_exports_info *const parse_info)
+{
+    const struct range available_range = parse_info->available_range;
+    const struct symtab_command symtab = parse_info->symtab;
+
+    const uint64_t arch_bit = parse_info->arch_bit;
+    const bool is_big_endian = parse_info->is_big_endian;
+    const uint64_t tbd_options = parse_info->tbd_options;
+
+    const uint8_t *const map = parse_info->map;
+    if (map != NULL) {
+        if (parse_info->is_64) {
+            return macho_file_parse_symbols_64_from_map(info_in,
+                                                        map,
+                                                        available_range,
+                                                        arch_bit,
+                                                        is_big_endian,
+                                                        symtab.symoff,
+                                                        symtab.nsyms,
+                                                        symtab.stroff,
+                                                        symtab.strsize,
+                                                        tbd_options,
+                                                        parse_info->options);
+        }
+
+        return macho_file_parse_symbols_from_map(info_in,
+                                                 map,
+                                                 available_range,
+                                                 arch_bit,
+                                                 is_big_endian,
+                                                 symtab.symoff,
+                                                 symtab.nsyms,
+                                                 symtab.stroff,
+                                                 symtab.strsize,
+                                                 tbd_options,
+                                                 parse_info->options);
+    }
+
+    const int fd = parse_info->fd;
+    const struct range full_range = parse_info->full_range;
+
+    if (parse_info->is_64) {
+        return macho_file_parse_symbols_64_from_file(info_in,
+                                                     fd,
+                                                     full_range,
+                                                     available_range,
+                                                     arch_bit,
+                                                     is_big_endian,
+                                                     symtab.symoff,
+                                                     symtab.nsyms,
+                                                     symtab.stroff,
+                                                     symtab.strsize,
+                                                     tbd_options);
+    }
+
+    return macho_file_parse_symbols_from_file(info_in,
+                                              fd,
+                                              full_range,
+                                              available_range,
+                                              arch_bit,
+                                              is_big_endian,
+                                              symtab.symoff,
+                                              symtab.nsyms,
+                                              symtab.stroff,
+                                              symtab.strsize,
+                                              tbd_options);
+}
+
+enum macho_file_parse_result
+macho_file_parse_exports(struct tbd_create_info *const info_in,
+                         const struct mf_parse_exports_info *const parse_info)
+{
+    /*
+     * Prefer the export-trie, which holds only the exported symbols, over
+     * scanning the full symbol-table.
+     */
+
+    const bool use_export_trie =
+        parse_info->export_trie.cmd != 0 &&
+        macho_file_can_parse_export_trie(parse_info->tbd_options);
+
+    if (!use_export_trie) {
+        return parse_symbol_table_exports(info_in, parse_info);
+    }
+
+    const uint64_t exports_count =
+        array_get_item_count(&info_in->exports,
+                             sizeof(struct tbd_export_info));
+
+    const enum macho_file_parse_result parse_trie_result =
+        parse_trie_exports(info_in, parse_info);
+
+    if (parse_trie_result != E_MACHO_FILE_PARSE_INVALID_EXPORT_TRIE) {
+        return parse_trie_result;
+    }
+
+    /*
+     * An invalid export-trie doesn't make the mach-o invalid if its
+     * symbol-table can be parsed instead, after discarding the exports already
+     * added from the export-trie.
+     */
+
+    if (parse_info->symtab.cmd != LC_SYMTAB) {
+        return parse_trie_result;
+    }
+
+    const enum array_result remove_symbols_result =
+        tbd_create_info_remove_symbols_since(info_in,
+                                             exports_count,
+                                             parse_info->arch_bit);
+
+    if (remove_symbols_result != E_ARRAY_OK) {
+        return E_MACHO_FILE_PARSE_ARRAY_FAIL;
+    }
+
+    return parse_symbol_table_exports(info_in, parse_info);
 }
@@ -29,9 +29,23 @@
 #include "path.h"
 
 #include "recursive.h"
+#include "tbd_cache.h"
 
 #include "unused.h"
 #include "usage.h"
+#include "worker_pool.h"
+
+struct recurse_path {
+    char *string;
+    uint64_t length;
+
+    /*
+     * Set by a worker if the file wasn't a mach-o file, but may still be a
+     * dyld_shared_cache file to be parsed after all workers have finished.
+     */
+
+    bool is_dsc_candidate;
+};
 
 struct recurse_callback_info {
     struct tbd_for_main *global;
@@ -41,6 +55,19 @@ struct recurse_callback_info {
     uint64_t retained_info;
 
     bool print_paths;
+
+    /*
+     * When parsing with several workers, paths are first collected while
+     * recursing, and are only parsed after the recurse has finished.
+     *
+     * Every worker receives its own copy of tbd, so each one has its own
+     * create-info to parse into.
+     */
+
+    struct array paths;
+
+    struct tbd_for_main *worker_tbds;
+    uint64_t *worker_files_parsed;
 };
 
 static bool
@@ -136,6 +163,235 @@ recurse_directory_callback(const char *const parse_path,
     return true;
 }
 
+static bool
+collect_path_callback(const char *const parse_path,
+                      const uint64_t parse_path_length,
+                      struct dirent *__unused const dirent,
+                      void *const callback_info)
+{
+    struct recurse_callback_info *const recurse_info =
+        (struct recurse_callback_info *)callback_info;
+
+    char *const string = alloc_and_copy(parse_path, parse_path_length);
+    if (string == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    const struct recurse_path path = {
+        .string = string,
+        .length = parse_path_length
+    };
+
+    const enum array_result add_path_result =
+        array_add_item(&recurse_info->paths, sizeof(path), &path, NULL);
+
+    if (add_path_result != E_ARRAY_OK) {
+        fputs("Internal failure: Failed to add path to array\n", stderr);
+        exit(1);
+    }
+
+    return true;
+}
+
+static void
+parse_collected_path(const uint64_t index,
+                     const uint32_t worker,
+                     void *const callback_info)
+{
+    struct recurse_callback_info *const recurse_info =
+        (struct recurse_callback_info *)callback_info;
+
+    struct recurse_path *const path =
+        (struct recurse_path *)recurse_info->paths.data + index;
+
+    struct tbd_for_main *const tbd = recurse_info->worker_tbds + worker;
+    const uint64_t flags = tbd->flags;
+
+    /*
+     * dyld_shared_cache files are left to be parsed serially, as their
+     * image-filters and image-paths are shared between all workers.
+     */
+
+    if (tbd->filetype == TBD_FOR_MAIN_FILETYPE_DYLD_SHARED_CACHE) {
+        path->is_dsc_candidate = flags & F_TBD_FOR_MAIN_RECURSE_INCLUDE_DSC;
+        return;
+    }
+
+    const char *const parse_path = path->string;
+    const int fd = open(parse_path, O_RDONLY);
+
+    if (fd < 0) {
+        if (!(flags & F_TBD_FOR_MAIN_IGNORE_WARNINGS)) {
+            worker_pool_lock_output();
+            fprintf(stderr,
+                    "Warning: Failed to open file (at path %s), error: %s\n",
+                    parse_path,
+                    strerror(errno));
+
+            worker_pool_unlock_output();
+        }
+
+        return;
+    }
+
+    char magic[16] = {};
+    uint64_t magic_size = 0;
+
+    const bool parse_as_macho_result =
+        parse_macho_file(&magic,
+                         &magic_size,
+                         &recurse_info->retained_info,
+                         recurse_info->global,
+                         tbd,
+                         parse_path,
+                         path->length,
+                         fd,
+                         true,
+                         true);
+
+    if (parse_as_macho_result) {
+        recurse_info->worker_files_parsed[worker] += 1;
+    } else {
+        path->is_dsc_candidate = flags & F_TBD_FOR_MAIN_RECURSE_INCLUDE_DSC;
+    }
+
+    close(fd);
+}
+
+static void
+parse_collected_dsc_paths(struct recurse_callback_info *const recurse_info) {
+    struct tbd_for_main *const tbd = recurse_info->tbd;
+
+    const struct recurse_path *path = recurse_info->paths.data;
+    const struct recurse_path *const end = recurse_info->paths.data_end;
+
+    for (; path != end; path++) {
+        if (!path->is_dsc_candidate) {
+            continue;
+        }
+
+        const int fd = open(path->string, O_RDONLY);
+        if (fd < 0) {
+            if (!(tbd->flags & F_TBD_FOR_MAIN_IGNORE_WARNINGS)) {
+                fprintf(stderr,
+                        "Warning: Failed to open file (at path %s), error: "
+                        "%s\n",
+                        path->string,
+                        strerror(errno));
+            }
+
+            continue;
+        }
+
+        char magic[16] = {};
+        uint64_t magic_size = 0;
+
+        const bool parse_as_dsc_result =
+            parse_shared_cache(&magic,
+                               &magic_size,
+                               &recurse_info->retained_info,
+                               recurse_info->global,
+                               tbd,
+                               path->string,
+                               path->length,
+                               fd,
+                               true,
+                               true,
+                               true);
+
+        if (parse_as_dsc_result) {
+            recurse_info->files_parsed += 1;
+        }
+
+        close(fd);
+    }
+}
+
+/*
+ * Parse all paths collected while recursing with tbd->jobs workers.
+ *
+ * Mach-o files are parsed concurrently, with dyld_shared_cache files parsed
+ * afterwards, so the number of files parsed and the messages printed match
+ * those of a serial recurse.
+ */
+
+static void
+parse_collected_paths(struct recurse_callback_info *const recurse_info) {
+    struct tbd_for_main *const tbd = recurse_info->tbd;
+
+    const uint32_t jobs = tbd->jobs;
+    const uint64_t paths_count =
+        array_get_item_count(&recurse_info->paths, sizeof(struct recurse_path));
+
+    struct tbd_for_main *const worker_tbds =
+        calloc(jobs, sizeof(struct tbd_for_main));
+
+    uint64_t *const worker_files_parsed = calloc(jobs, sizeof(uint64_t));
+    if (worker_tbds == NULL || worker_files_parsed == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i != jobs; i++) {
+        worker_tbds[i] = *tbd;
+
+        /*
+         * Each worker parses into its own storage, copies export-strings into
+         * its own pool, and formats tbds into its own write-buffer.
+         */
+
+        const struct tbd_create_info empty_info = {};
+        tbd_create_info_keep_storage(&worker_tbds[i].info, &empty_info);
+
+        const struct write_buffer empty_buffer = {};
+        worker_tbds[i].write_buffer = empty_buffer;
+
+        /*
+         * Files are already parsed concurrently, so the slices of a fat
+         * mach-o are parsed by the worker parsing the file.
+         */
+
+        worker_tbds[i].jobs = 1;
+    }
+
+    recurse_info->worker_tbds = worker_tbds;
+    recurse_info->worker_files_parsed = worker_files_parsed;
+
+    worker_pool_run(jobs, paths_count, recurse_info, parse_collected_path);
+
+    for (uint32_t i = 0; i != jobs; i++) {
+        recurse_info->files_parsed += worker_files_parsed[i];
+    }
+
+    /*
+     * Apart from their create-info storage and write-buffer, the worker tbds
+     * only share their allocated fields with tbd, and so must not be
+     * destroyed.
+     */
+
+    for (uint32_t i = 0; i != jobs; i++) {
+        tbd_create_info_destroy_storage(&worker_tbds[i].info);
+        write_buffer_destroy(&worker_tbds[i].write_buffer);
+    }
+
+    free(worker_tbds);
+    free(worker_files_parsed);
+
+    parse_collected_dsc_paths(recurse_info);
+}
+
+static void destroy_paths_array(struct array *const paths) {
+    struct recurse_path *path = paths->data;
+    const struct recurse_path *const end = paths->data_end;
+
+    for (; path != end; path++) {
+        free(path->string);
+    }
+
+    array_destroy(paths);
+}
+
 static bool
 recurse_directory_fail_callback(const char *const path,
                                 __unused const uint64_t path_length,
@@ -671,6 +927,36 @@ int main(const int argc, const char *const argv[]) {
                         }
                     } else if (strcmp(inner_opt, "dsc") == 0) {
                         tbd.filetype = TBD_FOR_MAIN_FILETYPE_DYLD_SHARED_CACHE;
+                    } else if (strcmp(inner_opt, "dsc-merge") == 0) {
+                        index += 1;
+                        if (index == argc) {
+                            fputs("Please provide a path to a "
+                                  "dyld_shared_cache file to merge\n",
+                                  stderr);
+
+                            tbd_for_main_destroy(&global);
+                            destroy_tbds_array(&tbds);
+
+                            return 1;
+                        }
+
+                        const char *const merge_path = argv[index];
+                        const enum array_result add_merge_path_result =
+                            array_add_item(&tbd.dsc_merge_paths,
+                                           sizeof(merge_path),
+                                           &merge_path,
+                                           NULL);
+
+                        if (add_merge_path_result != E_ARRAY_OK) {
+                            fputs("Experienced an array failure when trying "
+                                  "to add a dyld_shared_cache to merge\n",
+                                  stderr);
+
+                            tbd_for_main_destroy(&global);
+                            destroy_tbds_array(&tbds);
+
+                            return 1;
+                        }
                     } else if (strcmp(inner_opt, "include-dsc") == 0) {
                         tbd.flags |= F_TBD_FOR_MAIN_RECURSE_INCLUDE_DSC;
                     } else {
@@ -935,6 +1221,27 @@ int main(const int argc, const char *const argv[]) {
                     }
                 }
 
+                if (!array_is_empty(&tbd.dsc_merge_paths)) {
+                    const bool is_dsc =
+                        tbd.filetype == TBD_FOR_MAIN_FILETYPE_DYLD_SHARED_CACHE;
+
+                    if (!is_dsc ||
+                        (tbd.flags & F_TBD_FOR_MAIN_RECURSE_DIRECTORIES))
+                    {
+                        fprintf(stderr,
+                                "Option --dsc-merge, provided for path (%s), "
+                                "is only for parsing a single "
+                                "dyld_shared_cache file\n",
+                                path);
+
+                        tbd_for_main_destroy(&global);
+                        destroy_tbds_array(&tbds);
+
+                        free(tbd.parse_path);
+                        return 1;
+                    }
+                }
+
                 found_path = true;
                 break;
             }
@@ -1011,7 +1318,15 @@ int main(const int argc, const char *const argv[]) {
 
             return 0;
         } else if (strcmp(option, "list-dsc-images") == 0) {
-            if (index != 1 || argc != 3) {
+            /*
+             * --list-dsc-images may be followed by --machine-readable, before
+             * the path to the dyld_shared_cache file.
+             */
+
+            const bool machine_readable =
+                argc == 4 && strcmp(argv[2], "--machine-readable") == 0;
+
+            if (index != 1 || (argc != 3 && !machine_readable)) {
                 fputs("--list-dsc-images needs to be run with a single path to "
                       "a dyld_shared_cache file whose images will be printed\n",
                       stderr);
@@ -1020,7 +1335,7 @@ int main(const int argc, const char *const argv[]) {
                 return 1;
             }
 
-            const char *const path = argv[2];
+            const char *const path = argv[argc - 1];
             char *const full_path =
                 path_get_absolute_path_if_necessary(path, strlen(path), NULL);
 
@@ -1038,7 +1353,7 @@ int main(const int argc, const char *const argv[]) {
                 return 1;
             }
 
-            print_list_of_dsc_images(fd);
+            print_list_of_dsc_images(fd, machine_readable);
             return 0;
         } else if (strcmp(option, "list-objc-constraints") == 0) {
             if (index != 1 || argc != 2) {
@@ -1157,10 +1472,23 @@ int main(const int argc, const char *const argv[]) {
     const bool should_print_paths = item_count != 1;
     const struct tbd_for_main *const end = tbds.data_end;
 
+    /*
+     * Every cache-directory is cleaned up only once, and as paths share the
+     * cache-path of the global options, comparing pointers is enough.
+     */
+
+    const char *cleaned_cache_path = NULL;
+
     struct tbd_for_main *tbd = tbds.data;
     for (; tbd != end; tbd++) {
         tbd_for_main_apply_from(tbd, &global);
 
+        const char *const cache_path = tbd->cache_path;
+        if (cache_path != NULL && cache_path != cleaned_cache_path) {
+            tbd_cache_remove_stale_entries(cache_path);
+            cleaned_cache_path = cache_path;
+        }
+
         const uint64_t options = tbd->flags;
         if (options & F_TBD_FOR_MAIN_RECURSE_DIRECTORIES) {
             /*
@@ -1187,14 +1515,30 @@ int main(const int argc, const char *const argv[]) {
                 .print_paths = true
             };
 
+            /*
+             * With more than one job, we first collect all paths, and then
+             * have them parsed by our workers.
+             */
+
+            const bool use_workers = tbd->jobs > 1;
+            const dir_recurse_callback callback =
+                (use_workers) ?
+                    collect_path_callback :
+                    recurse_directory_callback;
+
             const enum dir_recurse_result recurse_dir_result =
                 dir_recurse(tbd->parse_path,
                             tbd->parse_path_length,
                             options & F_TBD_FOR_MAIN_RECURSE_SUBDIRECTORIES,
                             &recurse_info,
-                            recurse_directory_callback,
+                            callback,
                             recurse_directory_fail_callback);
 
+            if (use_workers) {
+                parse_collected_paths(&recurse_info);
+                destroy_paths_array(&recurse_info.paths);
+            }
+
             if (recurse_dir_result != E_DIR_RECURSE_OK) {
                 if (should_print_paths) {
                     fprintf(stderr,
@@ -7,12 +7,16 @@
 //
 
 #include <errno.h>
+#include <fcntl.h>
 
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include "arch_info.h"
+#include "copy.h"
+#include "dsc_image_cond_index.h"
 #include "handle_dsc_parse_result.h"
 #include "parse_dsc_for_main.h"
 
@@ -20,23 +24,90 @@
 #include "path.h"
 
 #include "recursive.h"
-#include "unused.h"
+#include "tbd_cache.h"
+#include "worker_pool.h"
 
 struct image_error {
     const char *path;
     enum dsc_image_parse_result result;
 };
 
+struct dsc_merge_image {
+    const char *path;
+    const struct dyld_cache_image_info *image;
+};
+
+/*
+ * A dyld_shared_cache (of another architecture) whose images are merged into
+ * the images of the same path in the dyld_shared_cache being parsed.
+ *
+ * The export-strings of merged images point into every cache's map, so all
+ * caches stay mapped until every image has been written out.
+ */
+
+struct dsc_merge_cache {
+    struct dyld_shared_cache_info info;
+    const char *path;
+
+    /*
+     * The cache's images, sorted by path.
+     */
+
+    struct dsc_merge_image *images;
+};
+
 struct dsc_iterate_images_callback_info {
     struct dyld_shared_cache_info *dsc_info;
 
+    struct dsc_merge_cache *merge_caches;
+    uint64_t merge_caches_count;
+
     const char *dsc_path;
     char *write_path;
 
     struct tbd_for_main *global;
     struct tbd_for_main *tbd;
 
+    /*
+     * When parsing with several workers, images (and the filters and paths
+     * they matched) are first collected, and only then parsed.
+     */
+
     struct array images;
+    struct array matches;
+
+    /*
+     * Index of the tbd's filters and paths, holding the ones the image last
+     * checked may match.
+     */
+
+    struct dsc_image_cond_index cond_index;
+
+    /*
+     * Flags for every image, indexed by the image's index, as the
+     * dyld_shared_cache itself is mapped read-only.
+     */
+
+    uint8_t *image_flags;
+
+    /*
+     * For every image, the index (plus one) of the next image at the same
+     * address (an alias of the image), or zero.
+     *
+     * Only created when images are written out to a directory, so the tbd of
+     * an image can be written out for each of its aliases without parsing
+     * the image again.
+     */
+
+    uint32_t *image_aliases;
+
+    /*
+     * When caching, the paths of every file written out, which are stored in
+     * the shared-cache's cache-entry.
+     */
+
+    struct array written_paths;
+    bool record_written_paths;
 
     uint64_t write_path_length;
     uint64_t *retained_info;
@@ -46,16 +117,41 @@ struct dsc_iterate_images_callback_info {
     bool did_print_messages_header;
 };
 
-enum dyld_cache_image_info_pad {
-    E_DYLD_CACHE_IMAGE_INFO_PAD_ALREADY_EXTRACTED = 1 << 0
+enum dsc_image_flags {
+    F_DSC_IMAGE_ALREADY_EXTRACTED = 1 << 0
 };
 
+static inline uint64_t
+get_image_index(
+    const struct dsc_iterate_images_callback_info *const callback_info,
+    const struct dyld_cache_image_info *const image)
+{
+    return (uint64_t)(image - callback_info->dsc_info->images);
+}
+
+static inline uint8_t *
+get_image_flags(
+    const struct dsc_iterate_images_callback_info *const callback_info,
+    const struct dyld_cache_image_info *const image)
+{
+    const uint64_t index = get_image_index(callback_info, image);
+    return callback_info->image_flags + index;
+}
+
 static void
 clear_create_info(struct tbd_create_info *const info_in,
                   const struct tbd_create_info *const orig)
 {
-    tbd_create_info_destroy(info_in);
+    tbd_create_info_clear(info_in);
+
+    /*
+     * Keep the (now emptied) storage to be reused by the next parse.
+     */
+
+    const struct tbd_create_info cleared = *info_in;
+
     *info_in = *orig;
+    tbd_create_info_keep_storage(info_in, &cleared);
 }
 
 static void
@@ -147,12 +243,58 @@ print_write_error(struct dsc_iterate_images_callback_info *const callback_info,
     print_write_to_path_result(tbd, image_path, result);
 }
 
+/*
+ * Images may be written out by several workers at once, so the written-paths
+ * are only added to while holding the lock.
+ */
+
+static void
+record_written_path(struct dsc_iterate_images_callback_info *const info,
+                    const char *const write_path,
+                    const uint64_t length)
+{
+    if (!info->record_written_paths) {
+        return;
+    }
+
+    char *const path = alloc_and_copy(write_path, length);
+    if (path == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    worker_pool_lock_output();
+
+    const enum array_result add_path_result =
+        array_add_item(&info->written_paths, sizeof(path), &path, NULL);
+
+    worker_pool_unlock_output();
+
+    if (add_path_result != E_ARRAY_OK) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+}
+
+static void destroy_written_paths(struct array *const written_paths) {
+    char **path = written_paths->data;
+    char **const paths_end = written_paths->data_end;
+
+    for (; path != paths_end; path++) {
+        free(*path);
+    }
+
+    array_destroy(written_paths);
+}
+
 static enum tbd_for_main_write_to_path_result
-write_out_tbd_info_for_single_filter_dir(struct tbd_for_main *const tbd,
-                                         const char *const filter_dir,
-                                         const uint64_t filter_length,
-                                         const char *const image_path,
-                                         const uint64_t image_path_length)
+write_out_tbd_info_for_single_filter_dir(
+    struct dsc_iterate_images_callback_info *const info,
+    struct tbd_for_main *const tbd,
+    const char *const filter_dir,
+    const uint64_t filter_length,
+    const char *const image_path,
+    const uint64_t image_path_length)
 {
     const char *const subdirs_ptr =
         path_get_next_component(filter_dir, filter_length);
@@ -175,19 +317,23 @@ write_out_tbd_info_for_single_filter_dir(struct tbd_for_main *const tbd,
     const enum tbd_for_main_write_to_path_result result =
         tbd_for_main_write_to_path(tbd, write_path, length, true);
 
-    free(write_path);
-
     if (result != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+        free(write_path);
         return result;
     }
 
+    record_written_path(info, write_path, length);
+    free(write_path);
+
     return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
 }
 
 static enum tbd_for_main_write_to_path_result
-write_out_tbd_info_for_single_filter_filename(struct tbd_for_main *const tbd,
-                                              const char *const filter_filename,
-                                              const uint64_t filter_length)
+write_out_tbd_info_for_single_filter_filename(
+    struct dsc_iterate_images_callback_info *const info,
+    struct tbd_for_main *const tbd,
+    const char *const filter_filename,
+    const uint64_t filter_length)
 {
     uint64_t length = 0;
     char *const write_path =
@@ -204,17 +350,20 @@ write_out_tbd_info_for_single_filter_filename(struct tbd_for_main *const tbd,
     const enum tbd_for_main_write_to_path_result write_result =
         tbd_for_main_write_to_path(tbd, write_path, length, true);
 
-    free(write_path);
-
     if (write_result != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+        free(write_path);
         return write_result;
     }
 
+    record_written_path(info, write_path, length);
+    free(write_path);
+
     return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
 }
 
 static enum tbd_for_main_write_to_path_result
 write_out_tbd_info_for_single_filter(
+    struct dsc_iterate_images_callback_info *const info,
     const struct tbd_for_main_dsc_image_filter *const filter,
     struct tbd_for_main *const tbd,
     const char *const image_path,
@@ -226,7 +375,8 @@ write_out_tbd_info_for_single_filter(
     switch (filter->type) {
         case TBD_FOR_MAIN_DSC_IMAGE_FILTER_TYPE_DIRECTORY:
             result =
-                write_out_tbd_info_for_single_filter_dir(tbd,
+                write_out_tbd_info_for_single_filter_dir(info,
+                                                         tbd,
                                                          filter->tmp_ptr,
                                                          filter->length,
                                                          image_path,
@@ -236,7 +386,8 @@ write_out_tbd_info_for_single_filter(
 
         case TBD_FOR_MAIN_DSC_IMAGE_FILTER_TYPE_FILE:
             result =
-                write_out_tbd_info_for_single_filter_filename(tbd,
+                write_out_tbd_info_for_single_filter_filename(info,
+                                                              tbd,
                                                               filter->tmp_ptr,
                                                               filter->length);
 
@@ -253,12 +404,15 @@ write_out_tbd_info_for_filters(
     const char *const image_path,
     const uint64_t length)
 {
-    const struct array *const filters = &tbd->dsc_image_filters;
+    const struct dsc_image_cond_index *const index = &info->cond_index;
 
-    struct tbd_for_main_dsc_image_filter *filter = filters->data;
-    const struct tbd_for_main_dsc_image_filter *const end = filters->data_end;
+    const uint32_t *iter = index->filter_candidates.data;
+    const uint32_t *const end = index->filter_candidates.data_end;
+
+    for (; iter != end; iter++) {
+        struct tbd_for_main_dsc_image_filter *const filter =
+            index->filters + *iter;
 
-    for (; filter != end; filter++) {
         uint64_t flags = filter->flags;
         if (!(flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
             continue;
@@ -270,7 +424,8 @@ write_out_tbd_info_for_filters(
         filter->flags = flags;
 
         const enum tbd_for_main_write_to_path_result write_result =
-            write_out_tbd_info_for_single_filter(filter,
+            write_out_tbd_info_for_single_filter(info,
+                                                 filter,
                                                  tbd,
                                                  image_path,
                                                  length);
@@ -283,9 +438,11 @@ write_out_tbd_info_for_filters(
 }
 
 static enum tbd_for_main_write_to_path_result
-write_out_tbd_info_for_image_path(const struct tbd_for_main *const tbd,
-                                  const char *const image_path,
-                                  const uint64_t image_path_length)
+write_out_tbd_info_for_image_path(
+    struct dsc_iterate_images_callback_info *const info,
+    struct tbd_for_main *const tbd,
+    const char *const image_path,
+    const uint64_t image_path_length)
 {
     uint64_t length = 0;
     char *const write_path =
@@ -302,12 +459,14 @@ write_out_tbd_info_for_image_path(const struct tbd_for_main *const tbd,
     const enum tbd_for_main_write_to_path_result write_result =
         tbd_for_main_write_to_path(tbd, write_path, length, true);
 
-    free(write_path);
-
     if (write_result != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+        free(write_path);
         return write_result;
     }
 
+    record_written_path(info, write_path, length);
+    free(write_path);
+
     return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
 }
 
@@ -318,12 +477,13 @@ write_out_tbd_info_for_paths(
     const char *const image_path,
     const uint64_t length)
 {
-    const struct array *const paths = &tbd->dsc_image_paths;
+    const struct dsc_image_cond_index *const index = &info->cond_index;
 
-    struct tbd_for_main_dsc_image_path *path = paths->data;
-    const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
+    const uint32_t *iter = index->path_candidates.data;
+    const uint32_t *const end = index->path_candidates.data_end;
 
-    for (; path != end; path++) {
+    for (; iter != end; iter++) {
+        struct tbd_for_main_dsc_image_path *const path = index->paths + *iter;
         uint64_t flags = path->flags;
         if (!(flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
             continue;
@@ -335,7 +495,7 @@ write_out_tbd_info_for_paths(
         path->flags = flags;
 
         const enum tbd_for_main_write_to_path_result write_result =
-            write_out_tbd_info_for_image_path(tbd, image_path, length);
+            write_out_tbd_info_for_image_path(info, tbd, image_path, length);
 
         if (write_result != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
             print_write_error(info, tbd, image_path, write_result);
@@ -358,12 +518,21 @@ write_out_tbd_info(struct dsc_iterate_images_callback_info *const info,
 
     const uint64_t length = info->write_path_length;
     if (tbd->flags & F_TBD_FOR_MAIN_DSC_WRITE_PATH_IS_FILE) {
-        tbd_for_main_write_to_path(tbd, write_path, length, true);
+        const enum tbd_for_main_write_to_path_result write_result =
+            tbd_for_main_write_to_path(tbd, write_path, length, true);
+
+        if (write_result == E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+            record_written_path(info, write_path, length);
+        }
+
         return;
     }
 
     if (info->parse_all_images) {
-        write_out_tbd_info_for_image_path(tbd, image_path, image_path_length);
+        write_out_tbd_info_for_image_path(info,
+                                          tbd,
+                                          image_path,
+                                          image_path_length);
         return;
     }
 
@@ -372,46 +541,109 @@ write_out_tbd_info(struct dsc_iterate_images_callback_info *const info,
 }
 
 static int
-actually_parse_image(
-    struct tbd_for_main *const tbd,
-    struct dyld_cache_image_info *const image,
-    const char *const image_path,
-    struct dsc_iterate_images_callback_info *const callback_info)
+merge_image_comparator(const void *const array_item, const void *const item) {
+    const struct dsc_merge_image *const array_image =
+        (const struct dsc_merge_image *)array_item;
+
+    const struct dsc_merge_image *const image =
+        (const struct dsc_merge_image *)item;
+
+    return strcmp(array_image->path, image->path);
+}
+
+static const struct dyld_cache_image_info *
+find_merge_image(const struct dsc_merge_cache *const cache,
+                 const char *const path)
 {
-    struct tbd_create_info *const create_info = &callback_info->tbd->info;
-    const struct tbd_create_info original_info = *create_info;
+    const struct dsc_merge_image key = {
+        .path = path
+    };
+
+    const struct dsc_merge_image *const image =
+        bsearch(&key,
+                cache->images,
+                cache->info.images_count,
+                sizeof(struct dsc_merge_image),
+                merge_image_comparator);
 
+    if (image == NULL) {
+        return NULL;
+    }
+
+    return image->image;
+}
+
+/*
+ * Parse image, and the images of the same path in every merge-cache, into
+ * create_info, returning the path of the dyld_shared_cache whose image failed
+ * to parse in dsc_path_out.
+ */
+
+static enum dsc_image_parse_result
+parse_image(struct dsc_iterate_images_callback_info *const callback_info,
+            const struct tbd_for_main *const tbd,
+            struct tbd_create_info *const create_info,
+            const struct dyld_cache_image_info *const image,
+            const char *const image_path,
+            const char **const dsc_path_out)
+{
+    struct dyld_shared_cache_info *const dsc_info = callback_info->dsc_info;
     const uint64_t macho_options =
         O_MACHO_FILE_PARSE_IGNORE_INVALID_FIELDS | tbd->macho_options;
 
-    const enum dsc_image_parse_result parse_image_result =
+    *dsc_path_out = callback_info->dsc_path;
+
+    const uint64_t merge_caches_count = callback_info->merge_caches_count;
+    if (merge_caches_count == 0) {
+        return dsc_image_parse(create_info,
+                               dsc_info,
+                               image,
+                               macho_options,
+                               tbd->parse_options,
+                               0);
+    }
+
+    enum dsc_image_parse_result result =
         dsc_image_parse(create_info,
-                        callback_info->dsc_info,
+                        dsc_info,
                         image,
                         macho_options,
-                        tbd->dsc_options,
-                        0);
+                        tbd->parse_options,
+                        O_DSC_IMAGE_PARSE_MERGE);
 
-    const bool should_continue =
-        handle_dsc_image_parse_result(callback_info->retained_info,
-                                      callback_info->global,
-                                      callback_info->tbd,
-                                      callback_info->dsc_path,
-                                      image_path,
-                                      parse_image_result,
-                                      callback_info->print_paths);
+    if (result != E_DSC_IMAGE_PARSE_OK) {
+        return result;
+    }
 
-    if (!should_continue) {
-        clear_create_info(create_info, &original_info);
-        print_image_error(callback_info, image_path, parse_image_result);
+    uint64_t archs = dsc_info->arch_bit;
+    struct dsc_merge_cache *cache = callback_info->merge_caches;
 
-        return 1;
-    }
+    const struct dsc_merge_cache *const end = cache + merge_caches_count;
+    for (; cache != end; cache++) {
+        const struct dyld_cache_image_info *const merge_image =
+            find_merge_image(cache, image_path);
 
-    write_out_tbd_info(callback_info, tbd, image_path, strlen(image_path));
-    clear_create_info(create_info, &original_info);
+        if (merge_image == NULL) {
+            continue;
+        }
 
-    return 0;
+        result =
+            dsc_image_parse(create_info,
+                            &cache->info,
+                            merge_image,
+                            macho_options,
+                            tbd->parse_options,
+                            O_DSC_IMAGE_PARSE_MERGE);
+
+        if (result != E_DSC_IMAGE_PARSE_OK) {
+            *dsc_path_out = cache->path;
+            return result;
+        }
+
+        archs |= cache->info.arch_bit;
+    }
+
+    return dsc_image_finish_merge(create_info, archs, tbd->parse_options);
 }
 
 static bool
@@ -445,53 +677,71 @@ path_passes_through_filter(
     return false;
 }
 
+static void find_candidate_conds(struct dsc_image_cond_index *const index,
+                                 const char *const path)
+{
+    if (!dsc_image_cond_index_find_candidates(index, path, strlen(path))) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+}
+
 static bool
-should_parse_image(const struct array *const filters,
-                   const struct array *const paths,
+should_parse_image(struct dsc_image_cond_index *const index,
                    const char *const path)
 {
-    bool should_parse = false;
-    if (!array_is_empty(paths)) {
-        const uint64_t path_length = strlen(path);
+    /*
+     * Conditions already selected for an image to be parsed by a worker are
+     * treated as if the image had already been parsed.
+     */
 
-        struct tbd_for_main_dsc_image_path *image_path = paths->data;
-        const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
+    const uint64_t found_flags =
+        F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE |
+        F_TBD_FOR_MAIN_DSC_IMAGE_SELECTED_ONE;
 
-        for (; image_path != end; image_path++) {
-            /*
-             * We here make the assumption that there is only one path for every
-             * image.
-             */
+    /*
+     * Only the paths and filters path may match are checked, in the order they
+     * were provided.
+     */
 
-            if (image_path->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
-                continue;
-            }
+    find_candidate_conds(index, path);
 
-            if (image_path->length != path_length) {
-                continue;
-            }
+    bool should_parse = false;
 
-            if (memcmp(image_path->string, path, path_length) != 0) {
-                continue;
-            }
+    const uint32_t *path_iter = index->path_candidates.data;
+    const uint32_t *const paths_end = index->path_candidates.data_end;
 
-            image_path->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING;
-            should_parse = true;
+    for (; path_iter != paths_end; path_iter++) {
+        struct tbd_for_main_dsc_image_path *const image_path =
+            index->paths + *path_iter;
+
+        /*
+         * We here make the assumption that there is only one path for every
+         * image.
+         */
+
+        if (image_path->flags & found_flags) {
+            continue;
         }
+
+        image_path->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING;
+        should_parse = true;
     }
 
-    struct tbd_for_main_dsc_image_filter *filter = filters->data;
-    const struct tbd_for_main_dsc_image_filter *const filters_end =
-        filters->data_end;
+    const uint32_t *filter_iter = index->filter_candidates.data;
+    const uint32_t *const filters_end = index->filter_candidates.data_end;
+
+    for (; filter_iter != filters_end; filter_iter++) {
+        struct tbd_for_main_dsc_image_filter *const filter =
+            index->filters + *filter_iter;
 
-    for (; filter != filters_end; filter++) {
         /*
          * If we've already concluded that the image should be parsed, and the
          * filter doesn't need to be marked as completed, we should skip the
          * expensive path_passes_through_filter() call.
          */
 
-        if (filter->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
+        if (filter->flags & found_flags) {
             if (should_parse) {
                 continue;
             }
@@ -507,16 +757,18 @@ should_parse_image(const struct array *const filters,
 }
 
 static void
-unmark_currently_parsing_conds(const struct array *const filters,
-                               const struct array *const paths)
+unmark_currently_parsing_conds(const struct dsc_image_cond_index *const index)
 {
     const uint64_t anti_currently_parsing_flag =
         (uint64_t)~F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING;
 
-    struct tbd_for_main_dsc_image_path *image_path = paths->data;
-    const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
+    const uint32_t *path_iter = index->path_candidates.data;
+    const uint32_t *const paths_end = index->path_candidates.data_end;
+
+    for (; path_iter != paths_end; path_iter++) {
+        struct tbd_for_main_dsc_image_path *const image_path =
+            index->paths + *path_iter;
 
-    for (; image_path != end; image_path++) {
         if (!(image_path->flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
             continue;
         }
@@ -524,11 +776,13 @@ unmark_currently_parsing_conds(const struct array *const filters,
         image_path->flags &= anti_currently_parsing_flag;
     }
 
-    struct tbd_for_main_dsc_image_filter *filter = filters->data;
-    const struct tbd_for_main_dsc_image_filter *const filters_end =
-        filters->data_end;
+    const uint32_t *filter_iter = index->filter_candidates.data;
+    const uint32_t *const filters_end = index->filter_candidates.data_end;
+
+    for (; filter_iter != filters_end; filter_iter++) {
+        struct tbd_for_main_dsc_image_filter *const filter =
+            index->filters + *filter_iter;
 
-    for (; filter != filters_end; filter++) {
         if (!(filter->flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
             continue;
         }
@@ -537,60 +791,765 @@ unmark_currently_parsing_conds(const struct array *const filters,
     }
 }
 
-static bool
-dsc_iterate_images_callback(struct dyld_cache_image_info *const image,
-                            const char *const image_path,
-                            void *const item)
+/*
+ * Write out the tbd just parsed for image for each of image's aliases that is
+ * to be parsed, so the same image isn't parsed again for every alias.
+ */
+
+static void
+write_out_tbd_info_for_aliases(
+    struct dsc_iterate_images_callback_info *const callback_info,
+    struct tbd_for_main *const tbd,
+    const struct dyld_cache_image_info *const image)
 {
-    if (image->pad & E_DYLD_CACHE_IMAGE_INFO_PAD_ALREADY_EXTRACTED) {
-        return true;
+    const uint32_t *const aliases = callback_info->image_aliases;
+    if (aliases == NULL) {
+        return;
     }
 
-    struct dsc_iterate_images_callback_info *const callback_info =
-       (struct dsc_iterate_images_callback_info *)item;
+    const struct dyld_shared_cache_info *const dsc_info =
+        callback_info->dsc_info;
 
-    struct tbd_for_main *const tbd = callback_info->tbd;
+    const uint64_t index = get_image_index(callback_info, image);
+    for (uint32_t next = aliases[index]; next != 0; next = aliases[next - 1]) {
+        const struct dyld_cache_image_info *const alias =
+            dsc_info->images + (next - 1);
 
-    /*
-     * Skip any dyld_shared_cache images if we haven't been prompted to accept
-     * them. We extract all the images in the dyld_shared_cache if none specific
-     * have been provided.
-     */
+        uint8_t *const alias_flags = get_image_flags(callback_info, alias);
+        if (*alias_flags & F_DSC_IMAGE_ALREADY_EXTRACTED) {
+            continue;
+        }
 
-    const struct array *const filters = &tbd->dsc_image_filters;
-    const struct array *const paths = &tbd->dsc_image_paths;
+        const char *const alias_path =
+            (const char *)(dsc_info->map + alias->pathFileOffset);
 
-    if (!callback_info->parse_all_images) {
-        if (!should_parse_image(filters, paths, image_path)) {
-            return true;
+        if (!callback_info->parse_all_images) {
+            if (!should_parse_image(&callback_info->cond_index, alias_path)) {
+                continue;
+            }
         }
-    }
 
-    if (actually_parse_image(tbd, image, image_path, callback_info)) {
-        unmark_currently_parsing_conds(filters, paths);
-        return true;
+        write_out_tbd_info(callback_info, tbd, alias_path, strlen(alias_path));
+        *alias_flags |= F_DSC_IMAGE_ALREADY_EXTRACTED;
     }
-
-    image->pad |= E_DYLD_CACHE_IMAGE_INFO_PAD_ALREADY_EXTRACTED;
-    return true;
 }
 
-static bool found_at_least_one_image(const struct array *const filters) {
-    const struct tbd_for_main_dsc_image_filter *filter = filters->data;
-    const struct tbd_for_main_dsc_image_filter *const end = filters->data_end;
+static int
+actually_parse_image(
+    struct tbd_for_main *const tbd,
+    const struct dyld_cache_image_info *const image,
+    const char *const image_path,
+    struct dsc_iterate_images_callback_info *const callback_info,
+    const bool write_aliases)
+{
+    struct tbd_create_info *const create_info = &callback_info->tbd->info;
+    const struct tbd_create_info original_info = *create_info;
 
-    for (; filter != end; filter++) {
-        if (filter->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
-            continue;
-        }
+    const char *dsc_path = NULL;
+    const enum dsc_image_parse_result parse_image_result =
+        parse_image(callback_info,
+                    tbd,
+                    create_info,
+                    image,
+                    image_path,
+                    &dsc_path);
 
-        return false;
-    }
+    const bool should_continue =
+        handle_dsc_image_parse_result(callback_info->retained_info,
+                                      callback_info->global,
+                                      callback_info->tbd,
+                                      dsc_path,
+                                      image_path,
+                                      parse_image_result,
+                                      callback_info->print_paths);
 
-    return true;
-}
+    if (!should_continue) {
+        clear_create_info(create_info, &original_info);
+        print_image_error(callback_info, image_path, parse_image_result);
 
-static bool found_all_paths(const struct array *const paths) {
+        return 1;
+    }
+
+    write_out_tbd_info(callback_info, tbd, image_path, strlen(image_path));
+    if (write_aliases) {
+        write_out_tbd_info_for_aliases(callback_info, tbd, image);
+    }
+
+    clear_create_info(create_info, &original_info);
+    return 0;
+}
+
+static bool
+dsc_iterate_images_callback(const struct dyld_cache_image_info *const image,
+                            const char *const image_path,
+                            void *const item)
+{
+    struct dsc_iterate_images_callback_info *const callback_info =
+       (struct dsc_iterate_images_callback_info *)item;
+
+    uint8_t *const image_flags = get_image_flags(callback_info, image);
+    if (*image_flags & F_DSC_IMAGE_ALREADY_EXTRACTED) {
+        return true;
+    }
+
+    struct tbd_for_main *const tbd = callback_info->tbd;
+    struct dsc_image_cond_index *const cond_index = &callback_info->cond_index;
+
+    /*
+     * Skip any dyld_shared_cache images if we haven't been prompted to accept
+     * them. We extract all the images in the dyld_shared_cache if none specific
+     * have been provided.
+     */
+
+    if (!callback_info->parse_all_images) {
+        if (!should_parse_image(cond_index, image_path)) {
+            return true;
+        }
+    }
+
+    /*
+     * Have the next image read in while this image is parsed.
+     *
+     * The next image is only known to be parsed when parsing all images, and
+     * prefetching an image not selected would map and read in its subcache
+     * for nothing.
+     */
+
+    if (callback_info->parse_all_images) {
+        struct dyld_shared_cache_info *const dsc_info = callback_info->dsc_info;
+        const struct dyld_cache_image_info *const next_image = image + 1;
+
+        if (next_image != dsc_info->images + dsc_info->images_count) {
+            dyld_shared_cache_prefetch_image(dsc_info, next_image);
+        }
+    }
+
+    if (actually_parse_image(tbd, image, image_path, callback_info, true)) {
+        unmark_currently_parsing_conds(cond_index);
+        return true;
+    }
+
+    *image_flags |= F_DSC_IMAGE_ALREADY_EXTRACTED;
+    return true;
+}
+
+struct dsc_image_job {
+    const struct dyld_cache_image_info *image;
+    const char *path;
+
+    /*
+     * Range of the matches (in callback_info->matches) this image is to be
+     * written out for.
+     */
+
+    uint64_t matches_begin;
+    uint64_t matches_end;
+
+    /*
+     * The index (plus one) of the job of this image's next alias, or zero.
+     *
+     * The jobs of an image's aliases are handled by the job of the image's
+     * first alias, so only that job parses the image.
+     */
+
+    uint64_t next_alias;
+    bool is_alias;
+};
+
+/*
+ * Store the filter or path an image matched, along with the tmp_ptr of the
+ * filter at the time, as a filter's tmp_ptr is overwritten for every image.
+ */
+
+struct dsc_image_match {
+    struct tbd_for_main_dsc_image_filter *filter;
+    struct tbd_for_main_dsc_image_path *path;
+
+    const char *tmp_ptr;
+};
+
+static void
+add_image_match(struct dsc_iterate_images_callback_info *const callback_info,
+                const struct dsc_image_match *const match)
+{
+    const enum array_result add_match_result =
+        array_add_item(&callback_info->matches, sizeof(*match), match, NULL);
+
+    if (add_match_result != E_ARRAY_OK) {
+        fputs("Internal failure: Failed to add image-match to array\n",
+              stderr);
+
+        exit(1);
+    }
+}
+
+/*
+ * Move the conditions marked as currently-parsing by should_parse_image() into
+ * the matches array, marking them as selected instead.
+ */
+
+static void
+collect_currently_parsing_conds(
+    struct dsc_iterate_images_callback_info *const callback_info)
+{
+    const uint64_t anti_currently_parsing_flag =
+        (uint64_t)~F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING;
+
+    const struct dsc_image_cond_index *const index = &callback_info->cond_index;
+
+    const uint32_t *filter_iter = index->filter_candidates.data;
+    const uint32_t *const filters_end = index->filter_candidates.data_end;
+
+    for (; filter_iter != filters_end; filter_iter++) {
+        struct tbd_for_main_dsc_image_filter *const filter =
+            index->filters + *filter_iter;
+
+        uint64_t flags = filter->flags;
+        if (!(flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
+            continue;
+        }
+
+        flags &= anti_currently_parsing_flag;
+        flags |= F_TBD_FOR_MAIN_DSC_IMAGE_SELECTED_ONE;
+
+        filter->flags = flags;
+
+        const struct dsc_image_match match = {
+            .filter = filter,
+            .tmp_ptr = filter->tmp_ptr
+        };
+
+        add_image_match(callback_info, &match);
+    }
+
+    const uint32_t *path_iter = index->path_candidates.data;
+    const uint32_t *const paths_end = index->path_candidates.data_end;
+
+    for (; path_iter != paths_end; path_iter++) {
+        struct tbd_for_main_dsc_image_path *const image_path =
+            index->paths + *path_iter;
+
+        uint64_t flags = image_path->flags;
+        if (!(flags & F_TBD_FOR_MAIN_DSC_IMAGE_CURRENTLY_PARSING)) {
+            continue;
+        }
+
+        flags &= anti_currently_parsing_flag;
+        flags |= F_TBD_FOR_MAIN_DSC_IMAGE_SELECTED_ONE;
+
+        image_path->flags = flags;
+
+        const struct dsc_image_match match = {
+            .path = image_path
+        };
+
+        add_image_match(callback_info, &match);
+    }
+}
+
+static bool
+dsc_collect_images_callback(const struct dyld_cache_image_info *const image,
+                            const char *const image_path,
+                            void *const item)
+{
+    struct dsc_iterate_images_callback_info *const callback_info =
+       (struct dsc_iterate_images_callback_info *)item;
+
+    const uint8_t image_flags = *get_image_flags(callback_info, image);
+    if (image_flags & F_DSC_IMAGE_ALREADY_EXTRACTED) {
+        return true;
+    }
+
+    struct dsc_image_job job = {
+        .image = image,
+        .path = image_path
+    };
+
+    if (!callback_info->parse_all_images) {
+        if (!should_parse_image(&callback_info->cond_index, image_path)) {
+            return true;
+        }
+
+        job.matches_begin =
+            array_get_item_count(&callback_info->matches,
+                                 sizeof(struct dsc_image_match));
+
+        collect_currently_parsing_conds(callback_info);
+        job.matches_end =
+            array_get_item_count(&callback_info->matches,
+                                 sizeof(struct dsc_image_match));
+    }
+
+    const enum array_result add_job_result =
+        array_add_item(&callback_info->images, sizeof(job), &job, NULL);
+
+    if (add_job_result != E_ARRAY_OK) {
+        fputs("Internal failure: Failed to add image to array\n", stderr);
+        exit(1);
+    }
+
+    return true;
+}
+
+static void
+write_out_tbd_info_for_matches(
+    struct dsc_iterate_images_callback_info *const info,
+    struct tbd_for_main *const tbd,
+    const struct dsc_image_job *const job,
+    const uint64_t image_path_length)
+{
+    const struct dsc_image_match *const matches = info->matches.data;
+    const char *const image_path = job->path;
+
+    for (uint64_t i = job->matches_begin; i != job->matches_end; i++) {
+        const struct dsc_image_match *const match = matches + i;
+        enum tbd_for_main_write_to_path_result write_result =
+            E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
+
+        /*
+         * Our conditions are shared between all workers, and so can only be
+         * modified while holding the lock.
+         */
+
+        if (match->filter != NULL) {
+            worker_pool_lock_output();
+            match->filter->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE;
+            worker_pool_unlock_output();
+
+            /*
+             * Only copy the fields of the filter that are never modified, as
+             * its flags may be written to by other workers.
+             */
+
+            const struct tbd_for_main_dsc_image_filter filter = {
+                .string = match->filter->string,
+                .tmp_ptr = match->tmp_ptr,
+                .type = match->filter->type,
+                .length = match->filter->length
+            };
+
+            write_result =
+                write_out_tbd_info_for_single_filter(info,
+                                                     &filter,
+                                                     tbd,
+                                                     image_path,
+                                                     image_path_length);
+        } else {
+            worker_pool_lock_output();
+            match->path->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE;
+            worker_pool_unlock_output();
+
+            write_result =
+                write_out_tbd_info_for_image_path(info,
+                                                  tbd,
+                                                  image_path,
+                                                  image_path_length);
+        }
+
+        if (write_result != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+            worker_pool_lock_output();
+            print_write_error(info, tbd, image_path, write_result);
+            worker_pool_unlock_output();
+        }
+    }
+}
+
+struct dsc_parse_images_info {
+    struct dsc_iterate_images_callback_info *callback_info;
+    struct tbd_for_main *worker_tbds;
+
+    uint64_t images_count;
+};
+
+/*
+ * Parse the image of job into tbd's create-info, returning whether the image
+ * was parsed successfully. On failure, tbd's create-info is cleared.
+ */
+
+static bool
+parse_job_image(struct dsc_iterate_images_callback_info *const callback_info,
+                struct tbd_for_main *const tbd,
+                const struct dsc_image_job *const job,
+                const struct tbd_create_info *const original_info)
+{
+    struct tbd_create_info *const create_info = &tbd->info;
+
+    const char *dsc_path = NULL;
+    const enum dsc_image_parse_result parse_image_result =
+        parse_image(callback_info,
+                    tbd,
+                    create_info,
+                    job->image,
+                    job->path,
+                    &dsc_path);
+
+    /*
+     * Requests to the user, and changes made to global, are serialized
+     * between all workers.
+     */
+
+    worker_pool_lock_output();
+
+    const bool should_continue =
+        handle_dsc_image_parse_result(callback_info->retained_info,
+                                      callback_info->global,
+                                      tbd,
+                                      dsc_path,
+                                      job->path,
+                                      parse_image_result,
+                                      callback_info->print_paths);
+
+    if (!should_continue) {
+        print_image_error(callback_info, job->path, parse_image_result);
+    }
+
+    worker_pool_unlock_output();
+
+    if (!should_continue) {
+        clear_create_info(create_info, original_info);
+        return false;
+    }
+
+    return true;
+}
+
+static void
+write_out_job(struct dsc_iterate_images_callback_info *const callback_info,
+              struct tbd_for_main *const tbd,
+              const struct dsc_image_job *const job)
+{
+    const uint64_t image_path_length = strlen(job->path);
+    const bool has_write_path = callback_info->write_path != NULL;
+
+    if (has_write_path &&
+        !callback_info->parse_all_images &&
+        !(tbd->flags & F_TBD_FOR_MAIN_DSC_WRITE_PATH_IS_FILE))
+    {
+        write_out_tbd_info_for_matches(callback_info,
+                                       tbd,
+                                       job,
+                                       image_path_length);
+    } else {
+        write_out_tbd_info(callback_info, tbd, job->path, image_path_length);
+    }
+
+    /*
+     * Every job has its own image, and so its own flags, so no lock is needed
+     * here.
+     */
+
+    *get_image_flags(callback_info, job->image) |=
+        F_DSC_IMAGE_ALREADY_EXTRACTED;
+}
+
+static void
+parse_image_job(const uint64_t index,
+                const uint32_t worker,
+                void *const item)
+{
+    const struct dsc_parse_images_info *const parse_info =
+        (const struct dsc_parse_images_info *)item;
+
+    struct dsc_iterate_images_callback_info *const callback_info =
+        parse_info->callback_info;
+
+    const struct dsc_image_job *const jobs = callback_info->images.data;
+    const struct dsc_image_job *const job = jobs + index;
+
+    if (job->is_alias) {
+        return;
+    }
+
+    struct tbd_for_main *const tbd = parse_info->worker_tbds + worker;
+    struct tbd_create_info *const create_info = &tbd->info;
+
+    /*
+     * Have the image this worker will likely parse next read in while this
+     * image is parsed.
+     */
+
+    const uint64_t next_index = index + tbd->jobs;
+    if (next_index < parse_info->images_count) {
+        const struct dsc_image_job *const next_job = jobs + next_index;
+        dyld_shared_cache_prefetch_image(callback_info->dsc_info,
+                                         next_job->image);
+    }
+
+    const struct tbd_create_info original_info = *create_info;
+    if (parse_job_image(callback_info, tbd, job, &original_info)) {
+        write_out_job(callback_info, tbd, job);
+
+        uint64_t next = job->next_alias;
+        for (; next != 0; next = jobs[next - 1].next_alias) {
+            write_out_job(callback_info, tbd, jobs + (next - 1));
+        }
+
+        clear_create_info(create_info, &original_info);
+        return;
+    }
+
+    /*
+     * Have every alias report its own error if the image couldn't be parsed,
+     * as it would have without being an alias.
+     */
+
+    uint64_t next = job->next_alias;
+    for (; next != 0; next = jobs[next - 1].next_alias) {
+        const struct dsc_image_job *const alias = jobs + (next - 1);
+        if (!parse_job_image(callback_info, tbd, alias, &original_info)) {
+            continue;
+        }
+
+        write_out_job(callback_info, tbd, alias);
+        clear_create_info(create_info, &original_info);
+    }
+}
+
+/*
+ * Chain the jobs of every image's aliases to the job of the image's first
+ * alias.
+ */
+
+static void
+link_alias_jobs(struct dsc_iterate_images_callback_info *const callback_info,
+                const uint64_t images_count)
+{
+    const uint32_t *const aliases = callback_info->image_aliases;
+    if (aliases == NULL) {
+        return;
+    }
+
+    const uint32_t dsc_images_count = callback_info->dsc_info->images_count;
+    uint64_t *const image_jobs = calloc(dsc_images_count, sizeof(uint64_t));
+
+    if (image_jobs == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    struct dsc_image_job *const jobs = callback_info->images.data;
+    for (uint64_t i = 0; i != images_count; i++) {
+        image_jobs[get_image_index(callback_info, jobs[i].image)] = i + 1;
+    }
+
+    for (uint64_t i = 0; i != images_count; i++) {
+        struct dsc_image_job *const job = jobs + i;
+        if (job->is_alias) {
+            continue;
+        }
+
+        uint64_t *tail = &job->next_alias;
+        uint32_t next = aliases[get_image_index(callback_info, job->image)];
+
+        for (; next != 0; next = aliases[next - 1]) {
+            const uint64_t alias_job = image_jobs[next - 1];
+            if (alias_job == 0) {
+                continue;
+            }
+
+            jobs[alias_job - 1].is_alias = true;
+
+            *tail = alias_job;
+            tail = &jobs[alias_job - 1].next_alias;
+        }
+    }
+
+    free(image_jobs);
+}
+
+static void
+clear_selected_conds(const struct array *const filters,
+                     const struct array *const paths)
+{
+    const uint64_t anti_selected_flag =
+        (uint64_t)~F_TBD_FOR_MAIN_DSC_IMAGE_SELECTED_ONE;
+
+    struct tbd_for_main_dsc_image_filter *filter = filters->data;
+    const struct tbd_for_main_dsc_image_filter *const filters_end =
+        filters->data_end;
+
+    for (; filter != filters_end; filter++) {
+        filter->flags &= anti_selected_flag;
+    }
+
+    struct tbd_for_main_dsc_image_path *image_path = paths->data;
+    const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
+
+    for (; image_path != end; image_path++) {
+        image_path->flags &= anti_selected_flag;
+    }
+}
+
+/*
+ * Parse the images of the dyld_shared_cache with tbd->jobs workers.
+ *
+ * Images are first selected serially (as our filters and paths are matched
+ * in order), and are then parsed and written out concurrently, with every
+ * worker parsing into its own copy of tbd.
+ */
+
+static void
+parse_images_with_workers(
+    struct dsc_iterate_images_callback_info *const callback_info)
+{
+    struct tbd_for_main *const tbd = callback_info->tbd;
+    dyld_shared_cache_iterate_images_with_callback(callback_info->dsc_info,
+                                                   callback_info,
+                                                   dsc_collect_images_callback);
+
+    const uint32_t jobs = tbd->jobs;
+    struct tbd_for_main *const worker_tbds =
+        calloc(jobs, sizeof(struct tbd_for_main));
+
+    if (worker_tbds == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i != jobs; i++) {
+        worker_tbds[i] = *tbd;
+
+        /*
+         * Each worker parses into its own storage, copies export-strings into
+         * its own pool, and formats tbds into its own write-buffer.
+         */
+
+        const struct tbd_create_info empty_info = {};
+        tbd_create_info_keep_storage(&worker_tbds[i].info, &empty_info);
+
+        const struct write_buffer empty_buffer = {};
+        worker_tbds[i].write_buffer = empty_buffer;
+    }
+
+    const uint64_t images_count =
+        array_get_item_count(&callback_info->images,
+                             sizeof(struct dsc_image_job));
+
+    link_alias_jobs(callback_info, images_count);
+
+    struct dsc_parse_images_info parse_info = {
+        .callback_info = callback_info,
+        .worker_tbds = worker_tbds,
+        .images_count = images_count
+    };
+
+    worker_pool_run(jobs, images_count, &parse_info, parse_image_job);
+
+    /*
+     * Apart from their create-info storage and write-buffer, the worker tbds
+     * only share their allocated fields with tbd, and so must not be
+     * destroyed.
+     */
+
+    for (uint32_t i = 0; i != jobs; i++) {
+        tbd_create_info_destroy_storage(&worker_tbds[i].info);
+        write_buffer_destroy(&worker_tbds[i].write_buffer);
+    }
+
+    free(worker_tbds);
+
+    clear_selected_conds(&tbd->dsc_image_filters, &tbd->dsc_image_paths);
+
+    array_destroy(&callback_info->images);
+    array_destroy(&callback_info->matches);
+}
+
+struct dsc_image_address {
+    uint64_t address;
+    uint32_t index;
+};
+
+static int
+compare_image_addresses(const void *const left, const void *const right) {
+    const struct dsc_image_address *const left_image =
+        (const struct dsc_image_address *)left;
+
+    const struct dsc_image_address *const right_image =
+        (const struct dsc_image_address *)right;
+
+    if (left_image->address != right_image->address) {
+        return left_image->address > right_image->address ? 1 : -1;
+    }
+
+    if (left_image->index != right_image->index) {
+        return left_image->index > right_image->index ? 1 : -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Create the image-aliases array of callback_info, linking every image to the
+ * next image (by index) at the same address.
+ *
+ * Returns NULL if the dyld_shared_cache has no aliases.
+ */
+
+static uint32_t *
+create_image_aliases(const struct dyld_shared_cache_info *const dsc_info) {
+    const uint32_t images_count = dsc_info->images_count;
+    if (images_count < 2) {
+        return NULL;
+    }
+
+    struct dsc_image_address *const addresses =
+        calloc(images_count, sizeof(struct dsc_image_address));
+
+    if (addresses == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i != images_count; i++) {
+        addresses[i].address = dsc_info->images[i].address;
+        addresses[i].index = i;
+    }
+
+    qsort(addresses,
+          images_count,
+          sizeof(struct dsc_image_address),
+          compare_image_addresses);
+
+    uint32_t *aliases = NULL;
+    for (uint32_t i = 1; i != images_count; i++) {
+        const struct dsc_image_address *const prev = addresses + (i - 1);
+        const struct dsc_image_address *const image = addresses + i;
+
+        if (prev->address != image->address) {
+            continue;
+        }
+
+        if (aliases == NULL) {
+            aliases = calloc(images_count, sizeof(uint32_t));
+            if (aliases == NULL) {
+                fputs("Failed to allocate memory\n", stderr);
+                exit(1);
+            }
+        }
+
+        aliases[prev->index] = image->index + 1;
+    }
+
+    free(addresses);
+    return aliases;
+}
+
+static bool found_at_least_one_image(const struct array *const filters) {
+    const struct tbd_for_main_dsc_image_filter *filter = filters->data;
+    const struct tbd_for_main_dsc_image_filter *const end = filters->data_end;
+
+    for (; filter != end; filter++) {
+        if (filter->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool found_all_paths(const struct array *const paths) {
     const struct tbd_for_main_dsc_image_path *path = paths->data;
     const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
 
@@ -728,43 +1687,218 @@ read_magic(void *const magic_in,
 }
 
 static void
-mark_found_for_matching_conds(const struct array *const filters,
-                              const struct array *const paths,
-                              const char *const path)
+destroy_merge_caches(
+    struct dsc_iterate_images_callback_info *const callback_info)
 {
-    if (!array_is_empty(paths)) {
-        const uint64_t path_length = strlen(path);
+    struct dsc_merge_cache *const caches = callback_info->merge_caches;
+    const uint64_t count = callback_info->merge_caches_count;
 
-        struct tbd_for_main_dsc_image_path *image_path = paths->data;
-        const struct tbd_for_main_dsc_image_path *const end = paths->data_end;
+    for (uint64_t i = 0; i != count; i++) {
+        struct dsc_merge_cache *const cache = caches + i;
 
-        for (; image_path != end; image_path++) {
-            /*
-             * We here make the assumption that there is only one path for every
-             * image.
-             */
+        free(cache->images);
+        dyld_shared_cache_info_destroy(&cache->info);
+    }
 
-            if (image_path->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
-                continue;
-            }
+    free(caches);
 
-            if (image_path->length != path_length) {
-                continue;
-            }
+    callback_info->merge_caches = NULL;
+    callback_info->merge_caches_count = 0;
+}
 
-            if (memcmp(image_path->string, path, path_length) != 0) {
-                continue;
-            }
+static bool
+open_merge_cache(struct dsc_merge_cache *const cache,
+                 const struct tbd_for_main *const tbd,
+                 const char *const path)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr,
+                "Failed to open dyld_shared_cache file to merge (at path %s), "
+                "error: %s\n",
+                path,
+                strerror(errno));
+
+        return false;
+    }
+
+    char magic[16] = {};
+    const enum read_magic_result read_magic_result =
+        read_magic(magic, 0, fd, path, true);
+
+    switch (read_magic_result) {
+        case E_READ_MAGIC_OK:
+            break;
+
+        case E_READ_MAGIC_READ_FAILED:
+            close(fd);
+            return false;
+
+        case E_READ_MAGIC_NOT_LARGE_ENOUGH:
+            handle_dsc_file_parse_result(path,
+                                         E_DYLD_SHARED_CACHE_PARSE_NOT_A_CACHE,
+                                         true);
+
+            close(fd);
+            return false;
+    }
 
-            image_path->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE;
+    /*
+     * dyld_shared_caches of architectures that weren't selected are left out
+     * of the merge.
+     */
+
+    const uint64_t only_archs = tbd->only_archs;
+    if (only_archs != 0) {
+        const struct arch_info *const arch =
+            dyld_shared_cache_get_arch_info_from_magic(magic);
+
+        if (arch != NULL && !arch_info_is_in_archs(arch, only_archs)) {
+            close(fd);
+            return true;
         }
     }
 
-    struct tbd_for_main_dsc_image_filter *filter = filters->data;
-    const struct tbd_for_main_dsc_image_filter *const filters_end =
-        filters->data_end;
+    /*
+     * The dyld_shared_cache stays mapped after its file is closed.
+     */
+
+    const enum dyld_shared_cache_parse_result parse_dsc_file_result =
+        dyld_shared_cache_parse_from_file(&cache->info,
+                                          fd,
+                                          path,
+                                          magic,
+                                          tbd->dsc_options);
+
+    close(fd);
+
+    if (parse_dsc_file_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        handle_dsc_file_parse_result(path, parse_dsc_file_result, true);
+        return false;
+    }
+
+    cache->path = path;
+
+    /*
+     * calloc() may return NULL for a count of zero, so allocate at least one
+     * image.
+     */
+
+    const uint32_t images_count = cache->info.images_count;
+    cache->images =
+        calloc(images_count != 0 ? images_count : 1,
+               sizeof(struct dsc_merge_image));
+
+    if (cache->images == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    const uint8_t *const map = cache->info.map;
+    for (uint32_t i = 0; i != images_count; i++) {
+        const struct dyld_cache_image_info *const image =
+            cache->info.images + i;
+
+        cache->images[i] = (struct dsc_merge_image){
+            .path = (const char *)(map + image->pathFileOffset),
+            .image = image
+        };
+    }
+
+    qsort(cache->images,
+          images_count,
+          sizeof(struct dsc_merge_image),
+          merge_image_comparator);
+
+    return true;
+}
+
+/*
+ * Open and parse every dyld_shared_cache tbd has to merge, each of which must
+ * have an architecture different from every other cache's.
+ */
+
+static bool
+open_merge_caches(struct dsc_iterate_images_callback_info *const callback_info,
+                  const struct tbd_for_main *const tbd)
+{
+    const struct array *const merge_paths = &tbd->dsc_merge_paths;
+    const uint64_t count = array_get_item_count(merge_paths, sizeof(char *));
+
+    if (count == 0) {
+        return true;
+    }
+
+    callback_info->merge_caches = calloc(count, sizeof(struct dsc_merge_cache));
+    if (callback_info->merge_caches == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    uint64_t archs = callback_info->dsc_info->arch_bit;
+    const char *const *const paths = merge_paths->data;
+
+    for (uint64_t i = 0; i != count; i++) {
+        struct dsc_merge_cache *const cache =
+            callback_info->merge_caches + callback_info->merge_caches_count;
+
+        const char *const path = paths[i];
+        if (!open_merge_cache(cache, tbd, path)) {
+            destroy_merge_caches(callback_info);
+            return false;
+        }
+
+        /*
+         * The cache's path is only set once it has been opened.
+         */
+
+        if (cache->path == NULL) {
+            continue;
+        }
+
+        callback_info->merge_caches_count += 1;
+
+        const uint64_t arch_bit = cache->info.arch_bit;
+        if (archs & arch_bit) {
+            fprintf(stderr,
+                    "dyld_shared_cache file to merge (at path %s) has the same "
+                    "architecture as another dyld_shared_cache being "
+                    "merged\n",
+                    path);
+
+            destroy_merge_caches(callback_info);
+            return false;
+        }
+
+        archs |= arch_bit;
+    }
+
+    return true;
+}
+
+static void
+mark_found_for_matching_conds(struct dsc_image_cond_index *const index,
+                              const char *const path)
+{
+    find_candidate_conds(index, path);
+
+    const uint32_t *path_iter = index->path_candidates.data;
+    const uint32_t *const paths_end = index->path_candidates.data_end;
+
+    for (; path_iter != paths_end; path_iter++) {
+        struct tbd_for_main_dsc_image_path *const image_path =
+            index->paths + *path_iter;
+
+        image_path->flags |= F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE;
+    }
+
+    const uint32_t *filter_iter = index->filter_candidates.data;
+    const uint32_t *const filters_end = index->filter_candidates.data_end;
+
+    for (; filter_iter != filters_end; filter_iter++) {
+        struct tbd_for_main_dsc_image_filter *const filter =
+            index->filters + *filter_iter;
 
-    for (; filter != filters_end; filter++) {
         if (filter->flags & F_TBD_FOR_MAIN_DSC_IMAGE_FOUND_ONE) {
             continue;
         }
@@ -803,13 +1937,42 @@ parse_shared_cache(void *const magic_in,
             return false;
     }
 
-    const uint64_t dsc_options =
-        O_DYLD_SHARED_CACHE_PARSE_ZERO_IMAGE_PADS | tbd->dsc_options;
+    /*
+     * Skip dyld_shared_caches of architectures that weren't selected before
+     * they're mapped.
+     */
+
+    const uint64_t only_archs = tbd->only_archs;
+    if (only_archs != 0) {
+        const struct arch_info *const arch =
+            dyld_shared_cache_get_arch_info_from_magic(magic_in);
+
+        if (arch != NULL && !arch_info_is_in_archs(arch, only_archs)) {
+            if (is_recursing) {
+                return true;
+            }
+
+            if (print_paths) {
+                fprintf(stderr,
+                        "dyld_shared_cache file (at path %s) is not of a "
+                        "selected architecture\n",
+                        path);
+            } else {
+                fputs("dyld_shared_cache file at the provided path is not of "
+                      "a selected architecture\n",
+                      stderr);
+            }
+
+            return true;
+        }
+    }
 
+    const uint64_t dsc_options = tbd->dsc_options;
     struct dyld_shared_cache_info dsc_info = {};
     const enum dyld_shared_cache_parse_result parse_dsc_file_result =
         dyld_shared_cache_parse_from_file(&dsc_info,
                                           fd,
+                                          path,
                                           magic_in,
                                           dsc_options);
 
@@ -860,10 +2023,77 @@ parse_shared_cache(void *const magic_in,
         .parse_all_images = true
     };
 
+    if (!open_merge_caches(&callback_info, tbd)) {
+        if (is_recursing) {
+            free(write_path);
+        }
+
+        dyld_shared_cache_info_destroy(&dsc_info);
+        return true;
+    }
+
+    /*
+     * When caching, skip the shared-cache entirely if it was already fully
+     * extracted with the same options, and every tbd it wrote out is still
+     * there.
+     *
+     * The cache-key only identifies a single dyld_shared_cache, so caching is
+     * skipped when merging.
+     */
+
+    const char *const cache_path = tbd->cache_path;
+    struct tbd_cache_key cache_key = {};
+
+    const bool is_merging = callback_info.merge_caches_count != 0;
+
+    bool use_cache = false;
+    if (cache_path != NULL && write_path != NULL && !is_merging) {
+        use_cache =
+            tbd_cache_key_for_dsc(&cache_key,
+                                  tbd,
+                                  fd,
+                                  &dsc_info,
+                                  write_path,
+                                  write_path_length);
+    }
+
+    if (use_cache && tbd_cache_has_entry(cache_path, &cache_key)) {
+        if (is_recursing) {
+            free(write_path);
+        }
+
+        destroy_merge_caches(&callback_info);
+        dyld_shared_cache_info_destroy(&dsc_info);
+
+        return true;
+    }
+
+    callback_info.record_written_paths = use_cache;
+
     const struct array *const filters = &tbd->dsc_image_filters;
     const struct array *const numbers = &tbd->dsc_image_numbers;
     const struct array *const paths = &tbd->dsc_image_paths;
 
+    struct dsc_image_cond_index *const cond_index = &callback_info.cond_index;
+    if (!dsc_image_cond_index_create(cond_index, filters, paths)) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
+    /*
+     * calloc() may return NULL for a count of zero, so allocate at least one
+     * image's flags.
+     */
+
+    const uint32_t images_count = dsc_info.images_count;
+    callback_info.image_flags =
+        calloc(images_count != 0 ? images_count : 1, sizeof(uint8_t));
+
+    if (callback_info.image_flags == NULL) {
+        fputs("Failed to allocate memory\n", stderr);
+        exit(1);
+    }
+
     /*
      * If numbers have been provided, directly call actually_parse_image()
      * instead of waiting around for the numbers to match up.
@@ -902,14 +2132,19 @@ parse_shared_cache(void *const magic_in,
             }
 
             const uint32_t index = number - 1;
-            struct dyld_cache_image_info *const image = dsc_info.images + index;
+            const struct dyld_cache_image_info *const image =
+                dsc_info.images + index;
 
             const uint32_t path_offset = image->pathFileOffset;
             const char *const image_path =
                 (const char *)(dsc_info.map + path_offset);
 
-            actually_parse_image(tbd, image, path, &callback_info);
-            mark_found_for_matching_conds(filters, paths, image_path);
+            actually_parse_image(tbd,
+                                 image,
+                                 image_path,
+                                 &callback_info,
+                                 false);
+            mark_found_for_matching_conds(cond_index, image_path);
         }
 
         /*
@@ -926,8 +2161,21 @@ parse_shared_cache(void *const magic_in,
             }
 
             print_dsc_warnings(&callback_info, filters, paths);
+
+            free(callback_info.image_flags);
+            dsc_image_cond_index_destroy(cond_index);
+
+            destroy_merge_caches(&callback_info);
             dyld_shared_cache_info_destroy(&dsc_info);
 
+            if (use_cache && !callback_info.did_print_messages_header) {
+                tbd_cache_store_entry(cache_path,
+                                      &cache_key,
+                                      &callback_info.written_paths);
+            }
+
+            destroy_written_paths(&callback_info.written_paths);
+
             return true;
         }
 
@@ -945,70 +2193,107 @@ parse_shared_cache(void *const magic_in,
         }
     }
 
+    /*
+     * Images at the same address are parsed only once, with their tbd written
+     * out for each alias. This is only done when writing to a directory, so
+     * tbds printed out, or merged, are still created in the images' order.
+     */
+
+    if (write_path != NULL &&
+        !(tbd->flags & F_TBD_FOR_MAIN_DSC_WRITE_PATH_IS_FILE) &&
+        !is_merging)
+    {
+        callback_info.image_aliases = create_image_aliases(&dsc_info);
+    }
+
     /*
      * Only create the write-path directory at the last-moment to avoid
      * unnecessary mkdir() calls for a shared-cache that may turn up empty.
      */
 
-    dyld_shared_cache_iterate_images_with_callback(&dsc_info,
-                                                   &callback_info,
-                                                   dsc_iterate_images_callback);
+    if (tbd->jobs > 1) {
+        parse_images_with_workers(&callback_info);
+    } else {
+        dyld_shared_cache_iterate_images_with_callback(
+            &dsc_info,
+            &callback_info,
+            dsc_iterate_images_callback);
+    }
 
     if (is_recursing) {
         free(write_path);
     }
 
     print_dsc_warnings(&callback_info, filters, paths);
-    dyld_shared_cache_info_destroy(&dsc_info);
 
-    return true;
-}
+    free(callback_info.image_aliases);
+    free(callback_info.image_flags);
+    dsc_image_cond_index_destroy(cond_index);
 
-struct dsc_list_images_callback {
-    uint64_t current_image_index;
-};
+    destroy_merge_caches(&callback_info);
+    dyld_shared_cache_info_destroy(&dsc_info);
 
-static bool
-dsc_list_images_callback(struct dyld_cache_image_info *__unused const image,
-                         const char *const image_path,
-                         void *const item)
-{
-    struct dsc_list_images_callback *const callback_info =
-        (struct dsc_list_images_callback *)item;
+    /*
+     * Only mark the shared-cache as extracted if no errors (or warnings) were
+     * printed, so that they're printed again on the next run.
+     */
 
-    const uint64_t current_image_index = callback_info->current_image_index;
+    if (use_cache && !callback_info.did_print_messages_header) {
+        tbd_cache_store_entry(cache_path,
+                              &cache_key,
+                              &callback_info.written_paths);
+    }
 
-    fprintf(stdout, "\t%" PRIu64 ". %s\n", current_image_index + 1, image_path);
-    callback_info->current_image_index = current_image_index + 1;
+    destroy_written_paths(&callback_info.written_paths);
 
     return true;
 }
 
-void print_list_of_dsc_images(const int fd) {
-    char magic[16] = {};
-    if (read(fd, &magic, sizeof(magic)) < 0) {
-        handle_dsc_file_parse_result(NULL,
-                                     E_DYLD_SHARED_CACHE_PARSE_READ_FAIL,
-                                     false);
+void print_list_of_dsc_images(const int fd, const bool machine_readable) {
+    /*
+     * Only the header, image-infos and image-paths are read, as mapping and
+     * validating the entire shared-cache is unnecessary to list its images.
+     */
 
+    struct dyld_shared_cache_image_list list = {};
+    const enum dyld_shared_cache_parse_result read_list_result =
+        dyld_shared_cache_read_image_list(&list, fd);
+
+    if (read_list_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
+        handle_dsc_file_parse_result(NULL, read_list_result, false);
         exit(1);
     }
 
-    struct dyld_shared_cache_info dsc_info = {};
-    const enum dyld_shared_cache_parse_result parse_dsc_file_result =
-        dyld_shared_cache_parse_from_file(&dsc_info, fd, magic, 0);
-
-    if (parse_dsc_file_result != E_DYLD_SHARED_CACHE_PARSE_OK) {
-        handle_dsc_file_parse_result(NULL, parse_dsc_file_result, false);
-        exit(1);
+    const uint32_t images_count = list.images_count;
+    if (!machine_readable) {
+        fprintf(stdout,
+                "The provided dyld_shared_cache file has %" PRIu32 " images\n",
+                images_count);
     }
 
-    fprintf(stdout,
-            "The provided dyld_shared_cache file has %" PRIu32 " images\n",
-            dsc_info.images_count);
+    /*
+     * The machine-readable list has a tab-separated line for every image, with
+     * the image's number, address, modification-time, inode and path.
+     */
+
+    for (uint32_t i = 0; i != images_count; i++) {
+        const struct dyld_cache_image_info *const image = list.images + i;
+        const char *const path =
+            dyld_shared_cache_image_list_get_path(&list, image);
+
+        if (machine_readable) {
+            fprintf(stdout,
+                    "%" PRIu32 "\t0x%" PRIx64 "\t%" PRIu64 "\t%" PRIu64
+                    "\t%s\n",
+                    i + 1,
+                    image->address,
+                    image->modTime,
+                    image->inode,
+                    path);
+        } else {
+            fprintf(stdout, "\t%" PRIu32 ". %s\n", i + 1, path);
+        }
+    }
 
-    struct dsc_list_images_callback callback_info = {};
-    dyld_shared_cache_iterate_images_with_callback(&dsc_info,
-                                                   &callback_info,
-                                                   dsc_list_images_callback);
+    dyld_shared_cache_image_list_destroy(&list);
 }
@@ -17,13 +17,23 @@
 
 #include "macho_file.h"
 #include "parse_macho_for_main.h"
+#include "tbd_cache.h"
+#include "worker_pool.h"
 
 static void
 clear_create_info(struct tbd_create_info *const info_in,
                   const struct tbd_create_info *const orig)
 {
-    tbd_create_info_destroy(info_in);
+    tbd_create_info_clear(info_in);
+
+    /*
+     * Keep the (now emptied) storage to be reused by the next parse.
+     */
+
+    const struct tbd_create_info cleared = *info_in;
+
     *info_in = *orig;
+    tbd_create_info_keep_storage(info_in, &cleared);
 }
 
 static int
@@ -110,6 +120,7 @@ parse_macho_file(void *const magic_in,
          * macho_file_parse_from_file().
          */
 
+        worker_pool_lock_output();
         handle_macho_file_parse_result(retained_info_in,
                                        global,
                                        tbd,
@@ -117,38 +128,104 @@ parse_macho_file(void *const magic_in,
                                        E_MACHO_FILE_PARSE_READ_FAIL,
                                        print_paths);
 
+        worker_pool_unlock_output();
         return true;
     }
 
     const uint32_t magic = *(uint32_t *)magic_in;
 
     const uint64_t parse_options = tbd->parse_options;
-    const uint64_t macho_options =
+    uint64_t macho_options =
         O_MACHO_FILE_PARSE_IGNORE_INVALID_FIELDS | tbd->macho_options;
 
+    /*
+     * With more than one job, the slices of a fat mach-o are parsed by up to
+     * that many workers.
+     */
+
+    if (tbd->jobs > 1) {
+        macho_options |= O_MACHO_FILE_PARSE_SLICES_IN_PARALLEL;
+    }
+
     struct tbd_create_info *const create_info = &tbd->info;
     struct tbd_create_info original_info = *create_info;
 
-    const enum macho_file_parse_result parse_result =
-        macho_file_parse_from_file(create_info,
-                                   fd,
-                                   magic,
-                                   parse_options,
-                                   macho_options);
+    /*
+     * When caching, the key has to be created before parsing, as it includes
+     * the fields preset in create_info.
+     */
+
+    const char *const cache_path = tbd->cache_path;
+    struct tbd_cache_key cache_key = {};
+
+    bool use_cache = false;
+    if (cache_path != NULL) {
+        use_cache = tbd_cache_key_for_macho(&cache_key, tbd, fd);
+    }
+
+    bool found_in_cache = false;
+    if (use_cache) {
+        found_in_cache =
+            tbd_cache_load_info(cache_path, &cache_key, create_info);
+
+        if (!found_in_cache) {
+            clear_create_info(create_info, &original_info);
+        }
+    }
+
+    enum macho_file_parse_result parse_result = E_MACHO_FILE_PARSE_OK;
+    if (!found_in_cache) {
+        parse_result =
+            macho_file_parse_from_file(create_info,
+                                       fd,
+                                       magic,
+                                       tbd->only_archs,
+                                       tbd->jobs,
+                                       parse_options,
+                                       macho_options);
+
+        if (use_cache && parse_result == E_MACHO_FILE_PARSE_OK) {
+            tbd_cache_store_info(cache_path, &cache_key, create_info);
+        }
+    }
 
     if (parse_result == E_MACHO_FILE_PARSE_NOT_A_MACHO) {
         if (!ignore_non_macho_error) {
+            worker_pool_lock_output();
             handle_macho_file_parse_result(retained_info_in,
                                            global,
                                            tbd,
                                            path,
                                            parse_result,
                                            print_paths);
+
+            worker_pool_unlock_output();
         }
 
         return false;
     }
 
+    /*
+     * When recursing, mach-o files with none of the selected architectures are
+     * skipped quietly.
+     */
+
+    if (parse_result == E_MACHO_FILE_PARSE_NO_VALID_ARCHITECTURES) {
+        if (tbd->only_archs != 0) {
+            if (tbd->flags & F_TBD_FOR_MAIN_RECURSE_DIRECTORIES) {
+                clear_create_info(create_info, &original_info);
+                return true;
+            }
+        }
+    }
+
+    /*
+     * Requests to the user, and changes made to global, are serialized in case
+     * we're being run from several workers at once.
+     */
+
+    worker_pool_lock_output();
+
     const bool should_continue =
         handle_macho_file_parse_result(retained_info_in,
                                        global,
@@ -157,6 +234,8 @@ parse_macho_file(void *const magic_in,
                                        parse_result,
                                        print_paths);
 
+    worker_pool_unlock_output();
+
     if (!should_continue) {
         clear_create_info(create_info, &original_info);
         return true;
@@ -186,13 +265,23 @@ parse_macho_file(void *const magic_in,
             }
 
             ret = tbd_for_main_write_to_path(tbd, write_path, len, true);
-            free(write_path);
         } else {
             ret = tbd_for_main_write_to_path(tbd, write_path, len, print_paths);
         }
 
         if (ret != E_TBD_FOR_MAIN_WRITE_TO_PATH_OK) {
+            worker_pool_lock_output();
             handle_write_result(tbd, path, write_path, ret, print_paths);
+            worker_pool_unlock_output();
+        }
+
+        /*
+         * Only free the created write-path after handle_write_result(), which
+         * may still print it out.
+         */
+
+        if (write_path != tbd->write_path) {
+            free(write_path);
         }
     } else {
         tbd_for_main_write_to_stdout(tbd, path, true);
@@ -565,9 +565,18 @@ path_has_dir_component(const char *const path,
             }
         }
 
+        /*
+         * Stop at the end of path, as path_get_end_of_row_of_slashes() would
+         * otherwise read past path's null-terminator.
+         */
+
+        if (*iter_end == '\0') {
+            return false;
+        }
+
         iter_begin = path_get_end_of_row_of_slashes(iter_end);
         if (iter_begin == NULL) {
-            return NULL;
+            return false;
         }
 
         iter_end = get_next_slash_or_end(iter_begin);
@@ -136,13 +136,16 @@ reverse_mkdir_ignoring_last(char *const path,
      * If that succeeds, break out of the loop to then iterate forwards and
      * create the directories afterwards.
      *
-     * If the directory already exists, we can simply return as it cannot happen
-     * unless the second-to-last path-component already exists.
+     * If the directory already exists, another thread may have created it
+     * after our previous mkdir() failed, so we still have to iterate forwards
+     * and create the path-components after it.
      *
      * If a directory-component doesn't exist (ENOENT), continue with the
      * iteration.
      */
 
+    bool found_existing = false;
+
     last_slash = (char *)path_get_front_of_row_of_slashes(path, last_slash);
     while (last_slash != path) {
         last_slash = find_last_slash_before_end(path, last_slash);
@@ -169,12 +172,14 @@ reverse_mkdir_ignoring_last(char *const path,
 
         if (ret < 0) {
             /*
-             * If the directory already exists, we are done, as all the previous
-             * mkdir calls should have gone through.
+             * If the directory already exists, it was created by another
+             * worker after our previous mkdir call failed, so we still have to
+             * create the path-components after it.
              */
 
             if (errno == EEXIST) {
-                return 0;
+                found_existing = true;
+                break;
             }
 
             /*
@@ -191,7 +196,12 @@ reverse_mkdir_ignoring_last(char *const path,
         }
     }
 
-    if (first_terminator_out != NULL) {
+    /*
+     * Only hand back the directory we created ourselves, so that a failed
+     * write doesn't remove directories other workers may be writing into.
+     */
+
+    if (first_terminator_out != NULL && !found_existing) {
         *first_terminator_out = last_slash;
     }
 
@@ -225,8 +235,21 @@ reverse_mkdir_ignoring_last(char *const path,
         const int ret = mkdir(path, mode);
         restore_slash_c_str(slash);
 
+        /*
+         * Another worker may have created the same directory in the meantime,
+         * which is as good as having created it ourselves.
+         */
+
         if (ret < 0) {
-            return 1;
+            if (errno != EEXIST) {
+                return 1;
+            }
+        } else if (found_existing) {
+            if (first_terminator_out != NULL) {
+                *first_terminator_out = slash;
+            }
+
+            found_existing = false;
         }
 
         /*
@@ -244,6 +267,13 @@ reverse_mkdir_ignoring_last(char *const path,
     return 0;
 }
 
+/*
+ * The number of times open_r creates the directory hierarchy of a path before
+ * giving up.
+ */
+
+static const uint32_t open_r_max_attempts = 4;
+
 int
 open_r(char *const path,
        const uint64_t length,
@@ -269,16 +299,31 @@ open_r(char *const path,
         return -1;
     }
 
-    if (reverse_mkdir_ignoring_last(path, length, dir_mode, terminator_out)) {
-        return -1;
-    }
+    /*
+     * When writing with several workers, a worker whose write failed removes
+     * the empty directories it created, which may be the directories we just
+     * found to already exist. Create the hierarchy again if that happens.
+     */
 
-    fd = open(path, O_CREAT | flags, mode);
-    if (fd < 0) {
-        return -1;
+    for (uint32_t i = 0; i != open_r_max_attempts; i++) {
+        const int mkdir_ret =
+            reverse_mkdir_ignoring_last(path, length, dir_mode, terminator_out);
+
+        if (mkdir_ret != 0) {
+            return -1;
+        }
+
+        fd = open(path, O_CREAT | flags, mode);
+        if (fd >= 0) {
+            return fd;
+        }
+
+        if (errno != ENOENT) {
+            return -1;
+        }
     }
 
-    return fd;
+    return -1;
 }
 
 int
@@ -318,7 +363,12 @@ mkdir_r(char *const path,
         return 1;
     }
 
-    if (mkdir(path, mode) < 0) {
+    /*
+     * Another worker may have created the full directory after we created its
+     * hierarchy.
+     */
+
+    if (mkdir(path, mode) < 0 && errno != EEXIST) {
         return 1;
     }
 
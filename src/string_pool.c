@@ -0,0 +1,170 @@
+//
+//  src/string_pool.c
+//  tbd
+//
+//  Created by inoahdev on 03/09/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "string_pool.h"
+
+/*
+ * Most strings are symbol-names, so chunks are large enough to hold thousands
+ * of strings. Strings larger than a chunk are given a chunk of their own.
+ */
+
+#define STRING_POOL_CHUNK_SIZE (64 * 1024)
+
+struct string_pool_chunk {
+    struct string_pool_chunk *next;
+    uint64_t size;
+
+    char data[];
+};
+
+static void
+use_chunk(struct string_pool *const pool, struct string_pool_chunk *const chunk)
+{
+    pool->current = chunk;
+    pool->iter = chunk->data;
+    pool->end = chunk->data + chunk->size;
+}
+
+/*
+ * Move the pool to a chunk with at least size bytes available, either reusing
+ * the chunk after the current chunk, or allocating a new chunk to be placed
+ * after the current chunk.
+ */
+
+static struct string_pool_chunk *
+move_to_chunk_with_size(struct string_pool *const pool, const uint64_t size) {
+    struct string_pool_chunk *const current = pool->current;
+    struct string_pool_chunk *next = NULL;
+
+    if (current != NULL) {
+        next = current->next;
+        if (next != NULL && next->size >= size) {
+            use_chunk(pool, next);
+            return next;
+        }
+    }
+
+    uint64_t chunk_size = STRING_POOL_CHUNK_SIZE;
+    if (chunk_size < size) {
+        chunk_size = size;
+    }
+
+    struct string_pool_chunk *const chunk =
+        malloc(sizeof(struct string_pool_chunk) + chunk_size);
+
+    if (chunk == NULL) {
+        return NULL;
+    }
+
+    chunk->next = next;
+    chunk->size = chunk_size;
+
+    if (current != NULL) {
+        current->next = chunk;
+    } else {
+        pool->front = chunk;
+    }
+
+    use_chunk(pool, chunk);
+    return chunk;
+}
+
+char *
+string_pool_copy_string(struct string_pool *const pool,
+                        const char *const string,
+                        const uint64_t length)
+{
+    const uint64_t size = length + 1;
+    if ((uint64_t)(pool->end - pool->iter) < size) {
+        if (move_to_chunk_with_size(pool, size) == NULL) {
+            return NULL;
+        }
+    }
+
+    char *const copy = pool->iter;
+
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    pool->iter = copy + size;
+    return copy;
+}
+
+void
+string_pool_reset(struct string_pool *const pool, const uint64_t max_kept_size)
+{
+    /*
+     * Free every chunk given to a single large string, as well as every chunk
+     * once the kept chunks would total more than max_kept_size, so that a
+     * single pathological parse doesn't have its memory held onto.
+     */
+
+    struct string_pool_chunk *kept_front = NULL;
+    struct string_pool_chunk *kept_back = NULL;
+
+    uint64_t kept_size = 0;
+    struct string_pool_chunk *chunk = pool->front;
+
+    while (chunk != NULL) {
+        struct string_pool_chunk *const next = chunk->next;
+        const uint64_t size = chunk->size;
+
+        if (size > STRING_POOL_CHUNK_SIZE || kept_size + size > max_kept_size) {
+            free(chunk);
+            chunk = next;
+
+            continue;
+        }
+
+        if (kept_back != NULL) {
+            kept_back->next = chunk;
+        } else {
+            kept_front = chunk;
+        }
+
+        kept_back = chunk;
+        kept_size += size;
+
+        chunk = next;
+    }
+
+    if (kept_back != NULL) {
+        kept_back->next = NULL;
+    }
+
+    pool->front = kept_front;
+    if (kept_front == NULL) {
+        pool->current = NULL;
+
+        pool->iter = NULL;
+        pool->end = NULL;
+
+        return;
+    }
+
+    use_chunk(pool, kept_front);
+}
+
+void string_pool_destroy(struct string_pool *const pool) {
+    struct string_pool_chunk *chunk = pool->front;
+    while (chunk != NULL) {
+        struct string_pool_chunk *const next = chunk->next;
+
+        free(chunk);
+        chunk = next;
+    }
+
+    pool->front = NULL;
+    pool->current = NULL;
+
+    pool->iter = NULL;
+    pool->end = NULL;
+}
@@ -161,102 +161,983 @@ tbd_uuid_info_comparator(const void *const array_item, const void *const item) {
     return 0;
 }
 
+static uint64_t
+hash_export(const enum tbd_export_type type,
+            const char *const string,
+            const uint32_t length)
+{
+    /*
+     * Use a simple FNV-1a hash over the string, seeded with the export-type.
+     */
+
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)type;
+
+    const uint8_t *iter = (const uint8_t *)string;
+    const uint8_t *const end = iter + length;
+
+    for (; iter != end; iter++) {
+        hash ^= *iter;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static inline bool
+export_matches(const struct tbd_export_info *const existing,
+               const struct tbd_export_info *const export_info)
+{
+    if (existing->type != export_info->type) {
+        return false;
+    }
+
+    const uint32_t length = export_info->length;
+    if (existing->length != length) {
+        return false;
+    }
+
+    return memcmp(existing->string, export_info->string, length) == 0;
+}
+
+static void
+set_insert_index(struct tbd_export_set *const set,
+                 const uint64_t hash,
+                 const uint64_t index)
+{
+    const uint64_t mask = set->capacity - 1;
+    uint64_t *const slots = set->slots;
+
+    uint64_t i = hash & mask;
+    while (slots[i] != 0) {
+        i = (i + 1) & mask;
+    }
+
+    slots[i] = index + 1;
+    set->count += 1;
+}
+
+/*
+ * Recreate the export-set with the provided capacity (a power of two) from all
+ * the export-infos currently in the exports array.
+ */
+
+static enum array_result
+rebuild_export_set(struct tbd_create_info *const info, const uint64_t capacity)
+{
+    uint64_t *const slots = calloc(capacity, sizeof(uint64_t));
+    if (slots == NULL) {
+        return E_ARRAY_ALLOC_FAIL;
+    }
+
+    struct tbd_export_set *const set = &info->exports_set;
+    free(set->slots);
+
+    set->slots = slots;
+    set->capacity = capacity;
+    set->count = 0;
+
+    const struct tbd_export_info *const exports = info->exports.data;
+    const uint64_t count =
+        array_get_item_count(&info->exports, sizeof(struct tbd_export_info));
+
+    for (uint64_t index = 0; index != count; index++) {
+        const struct tbd_export_info *const export_info = exports + index;
+        const uint64_t hash =
+            hash_export(export_info->type,
+                        export_info->string,
+                        export_info->length);
+
+        set_insert_index(set, hash, index);
+    }
+
+    return E_ARRAY_OK;
+}
+
+/*
+ * Ensure the export-set can hold item_count items, while staying at most half
+ * full.
+ */
+
+static enum array_result
+ensure_export_set_capacity(struct tbd_create_info *const info,
+                           const uint64_t item_count)
+{
+    const uint64_t wanted_capacity = item_count * 2;
+    const uint64_t capacity = info->exports_set.capacity;
+
+    if (wanted_capacity <= capacity) {
+        return E_ARRAY_OK;
+    }
+
+    uint64_t new_capacity = (capacity != 0) ? capacity * 2 : 64;
+    while (new_capacity < wanted_capacity) {
+        new_capacity *= 2;
+    }
+
+    return rebuild_export_set(info, new_capacity);
+}
+
+struct tbd_export_info *
+tbd_create_info_find_export(const struct tbd_create_info *const info,
+                            const struct tbd_export_info *const export_info,
+                            uint64_t *const hash_out)
+{
+    const uint64_t hash =
+        hash_export(export_info->type, export_info->string, export_info->length);
+
+    *hash_out = hash;
+
+    const struct tbd_export_set *const set = &info->exports_set;
+    if (set->count == 0) {
+        return NULL;
+    }
+
+    const uint64_t mask = set->capacity - 1;
+    const uint64_t *const slots = set->slots;
+
+    struct tbd_export_info *const exports = info->exports.data;
+    for (uint64_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask) {
+        struct tbd_export_info *const existing = exports + (slots[i] - 1);
+        if (export_matches(existing, export_info)) {
+            return existing;
+        }
+    }
+
+    return NULL;
+}
+
+enum array_result
+tbd_create_info_add_export(struct tbd_create_info *const info,
+                           const struct tbd_export_info *const export_info,
+                           const uint64_t hash)
+{
+    struct array *const exports = &info->exports;
+    const uint64_t index =
+        array_get_item_count(exports, sizeof(struct tbd_export_info));
+
+    const enum array_result ensure_capacity_result =
+        ensure_export_set_capacity(info, index + 1);
+
+    if (ensure_capacity_result != E_ARRAY_OK) {
+        return ensure_capacity_result;
+    }
+
+    const enum array_result add_export_info_result =
+        array_add_item(exports, sizeof(*export_info), export_info, NULL);
+
+    if (add_export_info_result != E_ARRAY_OK) {
+        return add_export_info_result;
+    }
+
+    set_insert_index(&info->exports_set, hash, index);
+    info->flags &= ~(uint64_t)F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED;
+
+    return E_ARRAY_OK;
+}
+
+enum array_result
+tbd_create_info_reserve_exports(struct tbd_create_info *const info,
+                                const uint64_t count)
+{
+    struct array *const exports = &info->exports;
+    const uint64_t exports_count =
+        array_get_item_count(exports, sizeof(struct tbd_export_info));
+
+    if (count <= exports_count) {
+        return E_ARRAY_OK;
+    }
+
+    const enum array_result ensure_array_capacity_result =
+        array_ensure_item_capacity(exports,
+                                   sizeof(struct tbd_export_info),
+                                   count - exports_count);
+
+    if (ensure_array_capacity_result != E_ARRAY_OK) {
+        return ensure_array_capacity_result;
+    }
+
+    return ensure_export_set_capacity(info, count);
+}
+
+enum array_result
+tbd_create_info_remove_symbols_since(struct tbd_create_info *const info,
+                                     const uint64_t exports_count,
+                                     const uint64_t arch_bit)
+{
+    struct tbd_export_info *const exports = info->exports.data;
+    for (uint64_t i = 0; i != exports_count; i++) {
+        struct tbd_export_info *const export_info = exports + i;
+
+        const enum tbd_export_type type = export_info->type;
+        if (type == TBD_EXPORT_TYPE_CLIENT ||
+            type == TBD_EXPORT_TYPE_REEXPORT)
+        {
+            continue;
+        }
+
+        if (!(export_info->archs & arch_bit)) {
+            continue;
+        }
+
+        export_info->archs &= ~arch_bit;
+        export_info->archs_count -= 1;
+    }
+
+    info->exports.data_end = exports + exports_count;
+
+    /*
+     * The export-set may still hold the indices of the removed export-infos,
+     * so recreate it from the export-infos left.
+     */
+
+    const uint64_t capacity = info->exports_set.capacity;
+    if (capacity == 0) {
+        return E_ARRAY_OK;
+    }
+
+    return rebuild_export_set(info, capacity);
+}
+
+static void destroy_export_set(struct tbd_export_set *const set) {
+    free(set->slots);
+
+    set->slots = NULL;
+    set->capacity = 0;
+    set->count = 0;
+}
+
+/*
+ * Storage of a create-info larger than this (in bytes) isn't kept around when
+ * the create-info is cleared, so a single large file or image doesn't have
+ * its memory held for every file or image after it.
+ */
+
+#define TBD_CREATE_INFO_MAX_KEPT_CAPACITY (8 * 1024 * 1024)
+
+/*
+ * Empty the export-set, keeping its slots to be reused, as long as they're not
+ * too large.
+ */
+
+static void clear_export_set(struct tbd_export_set *const set) {
+    const uint64_t capacity = set->capacity;
+    if (capacity * sizeof(uint64_t) > TBD_CREATE_INFO_MAX_KEPT_CAPACITY) {
+        destroy_export_set(set);
+        return;
+    }
+
+    if (set->count != 0) {
+        memset(set->slots, 0, capacity * sizeof(uint64_t));
+        set->count = 0;
+    }
+}
+
+/*
+ * Exports are sorted with a multikey quicksort, treating each export as a
+ * string of 64-bit "characters": its archs-count, archs, and type, followed by
+ * its string, eight bytes at a time.
+ *
+ * Each sort-item caches the character of its export at the level currently
+ * being sorted, so most comparisons are of a single integer, and the strings
+ * of a partition are only read again once the partition's prefix matches.
+ */
+
+struct export_sort_item {
+    uint64_t ch;
+    const struct tbd_export_info *info;
+};
+
+enum export_sort_level {
+    EXPORT_SORT_LEVEL_ARCHS_COUNT,
+    EXPORT_SORT_LEVEL_ARCHS,
+    EXPORT_SORT_LEVEL_TYPE,
+    EXPORT_SORT_LEVEL_STRING
+};
+
+/*
+ * Load the eight bytes of string at offset, as a big-endian integer so that
+ * integer order matches memcmp() order.
+ *
+ * Bytes past the end of the string are zero, which, as strings never contain
+ * a null-byte, sorts shorter strings before any strings they prefix.
+ */
+
+static inline uint64_t
+load_string_chunk(const char *const string,
+                  const uint64_t length,
+                  const uint64_t offset)
+{
+    uint64_t chunk = 0;
+    if (offset >= length) {
+        return 0;
+    }
+
+    const uint64_t left = length - offset;
+    if (left >= sizeof(chunk)) {
+        memcpy(&chunk, string + offset, sizeof(chunk));
+    } else {
+        memcpy(&chunk, string + offset, left);
+    }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    chunk = __builtin_bswap64(chunk);
+#endif
+
+    return chunk;
+}
+
+static inline uint64_t
+export_sort_ch(const struct tbd_export_info *const info, const uint64_t level) {
+    switch (level) {
+        case EXPORT_SORT_LEVEL_ARCHS_COUNT:
+            return info->archs_count;
+
+        case EXPORT_SORT_LEVEL_ARCHS:
+            return info->archs;
+
+        case EXPORT_SORT_LEVEL_TYPE:
+            return info->type;
+
+        default: {
+            const uint64_t offset = (level - EXPORT_SORT_LEVEL_STRING) * 8;
+            return load_string_chunk(info->string, info->length, offset);
+        }
+    }
+}
+
+/*
+ * Whether the string of an export ends within its character at level, which
+ * then has a trailing zero byte. Any exports with an equal character must end
+ * at the same point, and so there's nothing left to compare.
+ */
+
+static inline bool
+export_sort_is_done(const struct tbd_export_info *const info,
+                    const uint64_t level)
+{
+    if (level < EXPORT_SORT_LEVEL_STRING) {
+        return false;
+    }
+
+    const uint64_t offset = (level - EXPORT_SORT_LEVEL_STRING) * 8;
+    return info->length < offset + 8;
+}
+
+static inline void
+swap_sort_items(struct export_sort_item *const left,
+                struct export_sort_item *const right)
+{
+    const struct export_sort_item tmp = *left;
+
+    *left = *right;
+    *right = tmp;
+}
+
+static void
+insertion_sort_items(struct export_sort_item *const items,
+                     const uint64_t count)
+{
+    for (uint64_t i = 1; i < count; i++) {
+        const struct export_sort_item item = items[i];
+
+        uint64_t j = i;
+        for (; j != 0; j--) {
+            const struct tbd_export_info *const prev = items[j - 1].info;
+            if (tbd_export_info_comparator(prev, item.info) <= 0) {
+                break;
+            }
+
+            items[j] = items[j - 1];
+        }
+
+        items[j] = item;
+    }
+}
+
+static inline uint64_t
+median_of_three(const uint64_t a, const uint64_t b, const uint64_t c) {
+    if (a < b) {
+        if (b < c) {
+            return b;
+        }
+
+        return (a < c) ? c : a;
+    }
+
+    if (a < c) {
+        return a;
+    }
+
+    return (b < c) ? c : b;
+}
+
+static void
+multikey_sort_items(struct export_sort_item *items,
+                    uint64_t count,
+                    uint64_t level)
+{
+    while (count > 16) {
+        const uint64_t pivot =
+            median_of_three(items[0].ch,
+                            items[count / 2].ch,
+                            items[count - 1].ch);
+
+        /*
+         * Partition into [less | equal | greater] with a three-way partition.
+         */
+
+        uint64_t less_end = 0;
+        uint64_t iter = 0;
+        uint64_t greater_begin = count;
+
+        while (iter < greater_begin) {
+            const uint64_t ch = items[iter].ch;
+            if (ch < pivot) {
+                swap_sort_items(items + less_end, items + iter);
+
+                less_end++;
+                iter++;
+            } else if (ch > pivot) {
+                greater_begin--;
+                swap_sort_items(items + iter, items + greater_begin);
+            } else {
+                iter++;
+            }
+        }
+
+        struct export_sort_item *const equal = items + less_end;
+        struct export_sort_item *const greater = items + greater_begin;
+
+        const uint64_t less_count = less_end;
+        const uint64_t greater_count = count - greater_begin;
+
+        /*
+         * The items equal to the pivot continue to be sorted on the next
+         * level, unless their strings have ended.
+         */
+
+        uint64_t equal_count = 0;
+        if (!export_sort_is_done(equal->info, level)) {
+            equal_count = greater_begin - less_end;
+            for (uint64_t i = 0; i != equal_count; i++) {
+                equal[i].ch = export_sort_ch(equal[i].info, level + 1);
+            }
+        }
+
+        /*
+         * Only recurse into the two smaller partitions, each at most half of
+         * the items, and continue with the largest partition, so the depth of
+         * recursion stays logarithmic.
+         */
+
+        if (less_count >= greater_count && less_count >= equal_count) {
+            multikey_sort_items(greater, greater_count, level);
+            multikey_sort_items(equal, equal_count, level + 1);
+
+            count = less_count;
+        } else if (greater_count >= equal_count) {
+            multikey_sort_items(items, less_count, level);
+            multikey_sort_items(equal, equal_count, level + 1);
+
+            items = greater;
+            count = greater_count;
+        } else {
+            multikey_sort_items(items, less_count, level);
+            multikey_sort_items(greater, greater_count, level);
+
+            items = equal;
+            count = equal_count;
+            level++;
+        }
+    }
+
+    insertion_sort_items(items, count);
+}
+
+enum array_result
+tbd_create_info_sort_exports(struct tbd_create_info *const info) {
+    clear_export_set(&info->exports_set);
+
+    if (info->flags & F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED) {
+        return E_ARRAY_OK;
+    }
+
+    struct array *const exports = &info->exports;
+    const uint64_t count =
+        array_get_item_count(exports, sizeof(struct tbd_export_info));
+
+    if (count < 2) {
+        info->flags |= F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED;
+        return E_ARRAY_OK;
+    }
+
+    struct export_sort_item *const items =
+        malloc(sizeof(struct export_sort_item) * count);
+
+    if (items == NULL) {
+        return E_ARRAY_ALLOC_FAIL;
+    }
+
+    struct tbd_export_info *const sorted =
+        malloc(sizeof(struct tbd_export_info) * count);
+
+    if (sorted == NULL) {
+        free(items);
+        return E_ARRAY_ALLOC_FAIL;
+    }
+
+    const struct tbd_export_info *const infos = exports->data;
+    for (uint64_t i = 0; i != count; i++) {
+        const struct tbd_export_info *const export_info = infos + i;
+
+        items[i].ch = export_info->archs_count;
+        items[i].info = export_info;
+    }
+
+    multikey_sort_items(items, count, EXPORT_SORT_LEVEL_ARCHS_COUNT);
+
+    for (uint64_t i = 0; i != count; i++) {
+        sorted[i] = *items[i].info;
+    }
+
+    memcpy(exports->data, sorted, sizeof(struct tbd_export_info) * count);
+
+    free(items);
+    free(sorted);
+
+    info->flags |= F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED;
+    return E_ARRAY_OK;
+}
+
+struct export_merge_head {
+    const struct tbd_export_info *iter;
+    const struct tbd_export_info *end;
+};
+
+/*
+ * Merge the front export-infos of heads into export_info, advancing every head
+ * whose front export-info has the least type and string.
+ *
+ * Returns false if every head has no export-infos left.
+ */
+
+static bool
+merge_least_heads(struct export_merge_head *const heads,
+                  const uint64_t count,
+                  struct tbd_export_info *const export_info)
+{
+    const struct tbd_export_info *least = NULL;
+    for (uint64_t i = 0; i != count; i++) {
+        const struct export_merge_head *const head = heads + i;
+        if (head->iter == head->end) {
+            continue;
+        }
+
+        if (least == NULL) {
+            least = head->iter;
+            continue;
+        }
+
+        if (tbd_export_info_no_archs_comparator(head->iter, least) < 0) {
+            least = head->iter;
+        }
+    }
+
+    if (least == NULL) {
+        return false;
+    }
+
+    *export_info = *least;
+
+    uint64_t archs = 0;
+    uint8_t archs_count = 0;
+
+    for (uint64_t i = 0; i != count; i++) {
+        struct export_merge_head *const head = heads + i;
+        if (head->iter == head->end) {
+            continue;
+        }
+
+        const struct tbd_export_info *const info = head->iter;
+        if (info != least) {
+            if (tbd_export_info_no_archs_comparator(info, least) != 0) {
+                continue;
+            }
+        }
+
+        if (!(archs & info->archs)) {
+            archs |= info->archs;
+            archs_count += info->archs_count;
+        }
+
+        head->iter++;
+    }
+
+    export_info->archs = archs;
+    export_info->archs_count = archs_count;
+
+    return true;
+}
+
+/*
+ * The merged export-infos are already sorted by type and string, and so only
+ * have to be stably grouped by their archs to be fully sorted.
+ *
+ * Groups are found with a linear search, so grouping is given up on past
+ * MAX_EXPORT_ARCHS_GROUPS different archs, leaving the export-infos to be
+ * sorted by tbd_create_info_sort_exports().
+ */
+
+struct export_archs_group {
+    uint64_t archs;
+    uint64_t archs_count;
+
+    uint64_t count;
+    uint64_t offset;
+};
+
+enum {
+    MAX_EXPORT_ARCHS_GROUPS = 64
+};
+
+static int
+export_archs_group_comparator(const void *const left, const void *const right)
+{
+    const struct export_archs_group *const left_group =
+        (const struct export_archs_group *)left;
+
+    const struct export_archs_group *const right_group =
+        (const struct export_archs_group *)right;
+
+    if (left_group->archs_count != right_group->archs_count) {
+        return left_group->archs_count > right_group->archs_count ? 1 : -1;
+    }
+
+    if (left_group->archs != right_group->archs) {
+        return left_group->archs > right_group->archs ? 1 : -1;
+    }
+
+    return 0;
+}
+
+static struct export_archs_group *
+find_archs_group(struct export_archs_group *const groups,
+                 const uint64_t groups_count,
+                 const uint64_t archs)
+{
+    for (uint64_t i = 0; i != groups_count; i++) {
+        if (groups[i].archs == archs) {
+            return groups + i;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Stably group the count export-infos of merged by their archs into sorted_out,
+ * returning false if there are too many groups.
+ */
+
+static bool
+group_merged_exports(const struct tbd_export_info *const merged,
+                     const uint64_t count,
+                     struct tbd_export_info *const sorted_out)
+{
+    struct export_archs_group groups[MAX_EXPORT_ARCHS_GROUPS];
+    uint64_t groups_count = 0;
+
+    for (uint64_t i = 0; i != count; i++) {
+        const uint64_t archs = merged[i].archs;
+        struct export_archs_group *group =
+            find_archs_group(groups, groups_count, archs);
+
+        if (group == NULL) {
+            if (groups_count == MAX_EXPORT_ARCHS_GROUPS) {
+                return false;
+            }
+
+            group = groups + groups_count;
+            *group = (struct export_archs_group){
+                .archs = archs,
+                .archs_count = merged[i].archs_count
+            };
+
+            groups_count++;
+        }
+
+        group->count++;
+    }
+
+    qsort(groups,
+          groups_count,
+          sizeof(struct export_archs_group),
+          export_archs_group_comparator);
+
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i != groups_count; i++) {
+        groups[i].offset = offset;
+        offset += groups[i].count;
+    }
+
+    for (uint64_t i = 0; i != count; i++) {
+        struct export_archs_group *const group =
+            find_archs_group(groups, groups_count, merged[i].archs);
+
+        sorted_out[group->offset] = merged[i];
+        group->offset++;
+    }
+
+    return true;
+}
+
+/*
+ * Merge the sorted export-infos of left and right into exports_out.
+ */
+
+static void
+merge_sorted_exports(const struct tbd_export_info *left,
+                     const struct tbd_export_info *const left_end,
+                     const struct tbd_export_info *right,
+                     const struct tbd_export_info *const right_end,
+                     struct tbd_export_info *exports_out)
+{
+    while (left != left_end && right != right_end) {
+        if (tbd_export_info_comparator(right, left) < 0) {
+            *exports_out = *right;
+            right++;
+        } else {
+            *exports_out = *left;
+            left++;
+        }
+
+        exports_out++;
+    }
+
+    for (; left != left_end; left++, exports_out++) {
+        *exports_out = *left;
+    }
+
+    for (; right != right_end; right++, exports_out++) {
+        *exports_out = *right;
+    }
+}
+
+enum array_result
+tbd_create_info_merge_exports(struct tbd_create_info *const info,
+                              const struct array *const *const exports_list,
+                              const uint64_t count)
+{
+    struct export_merge_head *const heads =
+        calloc(count != 0 ? count : 1, sizeof(struct export_merge_head));
+
+    if (heads == NULL) {
+        return E_ARRAY_ALLOC_FAIL;
+    }
+
+    uint64_t total_count = 0;
+    for (uint64_t i = 0; i != count; i++) {
+        const struct array *const exports = exports_list[i];
+
+        heads[i].iter = exports->data;
+        heads[i].end = exports->data_end;
+
+        total_count += (uint64_t)(heads[i].end - heads[i].iter);
+    }
+
+    /*
+     * Sort the exports already in info first (such as any clients and
+     * re-exports), which are then merged with the grouped export-infos.
+     */
+
+    const enum array_result sort_exports_result =
+        tbd_create_info_sort_exports(info);
+
+    if (sort_exports_result != E_ARRAY_OK) {
+        free(heads);
+        return sort_exports_result;
+    }
+
+    struct tbd_export_info *const merged =
+        malloc(sizeof(struct tbd_export_info) * (total_count * 2 + 1));
+
+    if (merged == NULL) {
+        free(heads);
+        return E_ARRAY_ALLOC_FAIL;
+    }
+
+    const uint8_t anti_borrowed_flag =
+        (uint8_t)~F_TBD_EXPORT_INFO_STRING_IS_BORROWED;
+
+    uint64_t merged_count = 0;
+    struct tbd_export_info export_info = {};
+
+    while (merge_least_heads(heads, count, &export_info)) {
+        export_info.string =
+            string_pool_copy_string(&info->export_strings,
+                                    export_info.string,
+                                    export_info.length);
+
+        if (export_info.string == NULL) {
+            free(heads);
+            free(merged);
+
+            return E_ARRAY_ALLOC_FAIL;
+        }
+
+        export_info.flags &= anti_borrowed_flag;
+
+        merged[merged_count] = export_info;
+        merged_count++;
+    }
+
+    free(heads);
+
+    struct array *const exports = &info->exports;
+    const uint64_t exports_count =
+        array_get_item_count(exports, sizeof(struct tbd_export_info));
+
+    const enum array_result ensure_capacity_result =
+        array_ensure_item_capacity(exports,
+                                   sizeof(struct tbd_export_info),
+                                   merged_count);
+
+    if (ensure_capacity_result != E_ARRAY_OK) {
+        free(merged);
+        return ensure_capacity_result;
+    }
+
+    /*
+     * The second half of merged is used to store the grouped export-infos.
+     */
+
+    struct tbd_export_info *const grouped = merged + total_count;
+    struct tbd_export_info *const infos = exports->data;
+
+    if (!group_merged_exports(merged, merged_count, grouped)) {
+        memcpy(infos + exports_count,
+               merged,
+               sizeof(struct tbd_export_info) * merged_count);
+
+        info->flags &= ~(uint64_t)F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED;
+    } else if (exports_count == 0) {
+        memcpy(infos, grouped, sizeof(struct tbd_export_info) * merged_count);
+    } else {
+        /*
+         * Copy out the exports already in info, to be merged back into info's
+         * exports along with the grouped export-infos.
+         */
+
+        const uint64_t exports_size =
+            sizeof(struct tbd_export_info) * exports_count;
+
+        struct tbd_export_info *const existing = malloc(exports_size);
+        if (existing == NULL) {
+            free(merged);
+            return E_ARRAY_ALLOC_FAIL;
+        }
+
+        memcpy(existing, infos, exports_size);
+        merge_sorted_exports(existing,
+                             existing + exports_count,
+                             grouped,
+                             grouped + merged_count,
+                             infos);
+
+        free(existing);
+    }
+
+    exports->data_end = infos + exports_count + merged_count;
+    free(merged);
+
+    return E_ARRAY_OK;
+}
+
 enum tbd_create_result
 tbd_create_with_info(const struct tbd_create_info *const info,
-                     FILE *const file,
+                     struct write_buffer *const buffer,
                      const uint64_t options)
 {
     const enum tbd_version version = info->version;
-    if (tbd_write_magic(file, version)) {
+    if (tbd_write_magic(buffer, version)) {
         return E_TBD_CREATE_WRITE_FAIL;
     }
 
-    if (tbd_write_archs_for_header(file, info->archs)) {
+    if (tbd_write_archs_for_header(buffer, info->archs)) {
         return E_TBD_CREATE_WRITE_FAIL;
     }
 
     if (!(options & O_TBD_CREATE_IGNORE_UUIDS)) {
         if (version != TBD_VERSION_V1) {
-            if (tbd_write_uuids(file, &info->uuids)) {
+            if (tbd_write_uuids(buffer, &info->uuids)) {
                 return E_TBD_CREATE_WRITE_FAIL;
             }
         }
     }
 
-    if (tbd_write_platform(file, info->platform)) {
+    if (tbd_write_platform(buffer, info->platform)) {
         return E_TBD_CREATE_WRITE_FAIL;
     }
 
     if (version != TBD_VERSION_V1) {
         if (!(options & O_TBD_CREATE_IGNORE_FLAGS)) {
-            if (tbd_write_flags(file, info->flags_field)) {
+            if (tbd_write_flags(buffer, info->flags_field)) {
                 return E_TBD_CREATE_WRITE_FAIL;
             }
         }
     }
 
-    if (tbd_write_install_name(file, info)) {
+    if (tbd_write_install_name(buffer, info)) {
         return E_TBD_CREATE_WRITE_FAIL;
     }
 
     if (!(options & O_TBD_CREATE_IGNORE_CURRENT_VERSION)) {
-        if (tbd_write_current_version(file, info->current_version)) {
+        if (tbd_write_current_version(buffer, info->current_version)) {
             return E_TBD_CREATE_WRITE_FAIL;
         }
     }
 
     if (!(options & O_TBD_CREATE_IGNORE_COMPATIBILITY_VERSION)) {
         const uint32_t compatibility_version = info->compatibility_version;
-        if (tbd_write_compatibility_version(file, compatibility_version)) {
+        if (tbd_write_compatibility_version(buffer, compatibility_version)) {
             return E_TBD_CREATE_WRITE_FAIL;
         }
     }
 
     if (version != TBD_VERSION_V1) {
         if (!(options & O_TBD_CREATE_IGNORE_SWIFT_VERSION)) {
-            if (tbd_write_swift_version(file, version, info->swift_version)) {
+            if (tbd_write_swift_version(buffer, version, info->swift_version)) {
                 return E_TBD_CREATE_WRITE_FAIL;
             }
         }
 
         if (!(options & O_TBD_CREATE_IGNORE_OBJC_CONSTRAINT)) {
-            if (tbd_write_objc_constraint(file, info->objc_constraint)) {
+            if (tbd_write_objc_constraint(buffer, info->objc_constraint)) {
                 return E_TBD_CREATE_WRITE_FAIL;
             }
         }
 
         if (!(options & O_TBD_CREATE_IGNORE_PARENT_UMBRELLA)) {
-            if (tbd_write_parent_umbrella(file, info)) {
+            if (tbd_write_parent_umbrella(buffer, info)) {
                 return E_TBD_CREATE_WRITE_FAIL;
             }
         }
     }
 
     if (!(options & O_TBD_CREATE_IGNORE_EXPORTS)) {
-        if (tbd_write_exports(file, &info->exports, version)) {
+        if (tbd_write_exports(buffer, &info->exports, version)) {
             return E_TBD_CREATE_WRITE_FAIL;
         }
     }
 
-    if (tbd_write_footer(file)) {
+    if (tbd_write_footer(buffer)) {
         return E_TBD_CREATE_WRITE_FAIL;
     }
 
     return E_TBD_CREATE_OK;
 }
 
-static void destroy_exports_array(struct array *const list) {
-    struct tbd_export_info *info = list->data;
-    const struct tbd_export_info *const end = list->data_end;
-
-    for (; info != end; info++) {
-        free(info->string);
-    }
-
-    array_destroy(list);
-}
-
-void tbd_create_info_destroy(struct tbd_create_info *const info) {
+static void clear_fields(struct tbd_create_info *const info) {
     if (info->flags & F_TBD_CREATE_INFO_STRINGS_WERE_COPIED) {
         free((char *)info->install_name);
         free((char *)info->parent_umbrella);
@@ -277,6 +1158,44 @@ void tbd_create_info_destroy(struct tbd_create_info *const info) {
     info->compatibility_version = 0;
     info->swift_version = 0;
 
-    destroy_exports_array(&info->exports);
+}
+
+void tbd_create_info_destroy(struct tbd_create_info *const info) {
+    clear_fields(info);
+    tbd_create_info_destroy_storage(info);
+}
+
+void tbd_create_info_destroy_storage(struct tbd_create_info *const info) {
+    /*
+     * The export-info strings are either borrowed, or stored in
+     * export_strings, and so don't have to be freed separately.
+     */
+
+    array_destroy(&info->exports);
+    destroy_export_set(&info->exports_set);
+
     array_destroy(&info->uuids);
+    string_pool_destroy(&info->export_strings);
+}
+
+void tbd_create_info_clear(struct tbd_create_info *const info) {
+    clear_fields(info);
+
+    array_clear(&info->exports, TBD_CREATE_INFO_MAX_KEPT_CAPACITY);
+    clear_export_set(&info->exports_set);
+
+    array_clear(&info->uuids, TBD_CREATE_INFO_MAX_KEPT_CAPACITY);
+    string_pool_reset(&info->export_strings,
+                      TBD_CREATE_INFO_MAX_KEPT_CAPACITY);
+}
+
+void
+tbd_create_info_keep_storage(struct tbd_create_info *const info,
+                             const struct tbd_create_info *const cleared)
+{
+    info->exports = cleared->exports;
+    info->uuids = cleared->uuids;
+
+    info->exports_set = cleared->exports_set;
+    info->export_strings = cleared->export_strings;
 }
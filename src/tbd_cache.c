@@ -0,0 +1,1244 @@
+//
+//  src/tbd_cache.c
+//  tbd
+//
+//  Created by inoahdev on 03/11/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "arch_info.h"
+#include "dyld_shared_cache_format.h"
+
+#include "mach-o/fat.h"
+#include "mach-o/loader.h"
+
+#include "path.h"
+#include "swap.h"
+#include "tbd_cache.h"
+#include "write_buffer.h"
+
+static const char tbd_cache_magic[8] = {
+    't', 'b', 'd', 'c', 'a', 'c', 'h', 'e'
+};
+
+/*
+ * Bump the format-version whenever the layout of an entry, or of the key,
+ * changes, so that older entries are simply treated as missing.
+ */
+
+static const uint32_t tbd_cache_format_version = 4;
+
+struct tbd_cache_entry_header {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t reserved;
+
+    struct tbd_cache_key key;
+};
+
+static uint64_t
+hash_bytes(uint64_t hash, const void *const data, const uint64_t size) {
+    const uint8_t *iter = (const uint8_t *)data;
+    const uint8_t *const end = iter + size;
+
+    for (; iter != end; iter++) {
+        hash ^= *iter;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static const uint64_t hash_seed = 14695981039346656037ull;
+
+static void
+fill_key(struct tbd_cache_key *const key_in,
+         const struct tbd_for_main *const tbd,
+         const struct stat *const sbuf)
+{
+    key_in->dev = (uint64_t)sbuf->st_dev;
+    key_in->ino = (uint64_t)sbuf->st_ino;
+    key_in->size = (uint64_t)sbuf->st_size;
+
+#ifdef __APPLE__
+    key_in->mtime_sec = (uint64_t)sbuf->st_mtimespec.tv_sec;
+    key_in->mtime_nsec = (uint64_t)sbuf->st_mtimespec.tv_nsec;
+#else
+    key_in->mtime_sec = (uint64_t)sbuf->st_mtim.tv_sec;
+    key_in->mtime_nsec = (uint64_t)sbuf->st_mtim.tv_nsec;
+#endif
+
+    key_in->macho_options = tbd->macho_options;
+    key_in->parse_options = tbd->parse_options;
+    key_in->only_archs = tbd->only_archs;
+
+    /*
+     * The fields provided by the user are preset in tbd's create-info before
+     * parsing, and may change the parse's result.
+     */
+
+    const struct tbd_create_info *const info = &tbd->info;
+
+    key_in->version = info->version;
+    key_in->archs = info->archs;
+    key_in->flags_field = info->flags_field;
+    key_in->platform = info->platform;
+    key_in->objc_constraint = info->objc_constraint;
+    key_in->current_version = info->current_version;
+    key_in->compatibility_version = info->compatibility_version;
+    key_in->swift_version = info->swift_version;
+}
+
+static bool
+pread_all(const int fd, void *const buffer, uint64_t size, uint64_t offset) {
+    uint8_t *iter = (uint8_t *)buffer;
+    while (size != 0) {
+        const ssize_t read_size = pread(fd, iter, size, (off_t)offset);
+        if (read_size <= 0) {
+            if (read_size < 0 && errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        iter += read_size;
+        size -= (uint64_t)read_size;
+        offset += (uint64_t)read_size;
+    }
+
+    return true;
+}
+
+/*
+ * Hash the uuid of the thin mach-o at offset into hash, along with its cputype
+ * and cpusubtype. Mach-o files without a (valid) uuid leave hash unchanged.
+ */
+
+static uint64_t
+hash_macho_uuid(uint64_t hash,
+                const int fd,
+                const uint64_t offset,
+                const uint64_t size)
+{
+    struct mach_header header = {};
+    if (size < sizeof(header)) {
+        return hash;
+    }
+
+    if (!pread_all(fd, &header, sizeof(header), offset)) {
+        return hash;
+    }
+
+    const uint32_t magic = header.magic;
+    const bool is_big_endian = magic == MH_CIGAM || magic == MH_CIGAM_64;
+
+    uint64_t header_size = sizeof(header);
+    if (magic == MH_MAGIC_64 || magic == MH_CIGAM_64) {
+        header_size += sizeof(uint32_t);
+    } else if (magic != MH_MAGIC && magic != MH_CIGAM) {
+        return hash;
+    }
+
+    uint32_t ncmds = header.ncmds;
+    uint32_t sizeofcmds = header.sizeofcmds;
+
+    if (is_big_endian) {
+        ncmds = swap_uint32(ncmds);
+        sizeofcmds = swap_uint32(sizeofcmds);
+    }
+
+    if (size < header_size || sizeofcmds > size - header_size) {
+        return hash;
+    }
+
+    uint8_t *const load_cmds = malloc(sizeofcmds);
+    if (load_cmds == NULL) {
+        return hash;
+    }
+
+    if (!pread_all(fd, load_cmds, sizeofcmds, offset + header_size)) {
+        free(load_cmds);
+        return hash;
+    }
+
+    const uint8_t *iter = load_cmds;
+    uint32_t size_left = sizeofcmds;
+
+    for (uint32_t i = 0; i != ncmds; i++) {
+        if (size_left < sizeof(struct load_command)) {
+            break;
+        }
+
+        struct load_command load_cmd = *(const struct load_command *)iter;
+        if (is_big_endian) {
+            load_cmd.cmd = swap_uint32(load_cmd.cmd);
+            load_cmd.cmdsize = swap_uint32(load_cmd.cmdsize);
+        }
+
+        if (load_cmd.cmdsize < sizeof(struct load_command)) {
+            break;
+        }
+
+        if (load_cmd.cmdsize > size_left) {
+            break;
+        }
+
+        if (load_cmd.cmd == LC_UUID) {
+            if (load_cmd.cmdsize == sizeof(struct uuid_command)) {
+                const struct uuid_command *const uuid_cmd =
+                    (const struct uuid_command *)iter;
+
+                hash = hash_bytes(hash, &header.cputype, sizeof(cpu_type_t));
+                hash =
+                    hash_bytes(hash,
+                               &header.cpusubtype,
+                               sizeof(cpu_subtype_t));
+
+                hash = hash_bytes(hash, uuid_cmd->uuid, sizeof(uuid_cmd->uuid));
+            }
+
+            break;
+        }
+
+        iter += load_cmd.cmdsize;
+        size_left -= load_cmd.cmdsize;
+    }
+
+    free(load_cmds);
+    return hash;
+}
+
+/*
+ * Hash the uuids of every architecture of the mach-o file at fd, which has
+ * already been verified to be either a fat or a thin mach-o file.
+ */
+
+static uint64_t hash_macho_uuids(const int fd, const uint64_t file_size) {
+    struct fat_header header = {};
+    if (!pread_all(fd, &header, sizeof(header), 0)) {
+        return hash_seed;
+    }
+
+    const uint32_t magic = header.magic;
+    const bool is_fat_64 = magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
+
+    if (!is_fat_64 && magic != FAT_MAGIC && magic != FAT_CIGAM) {
+        return hash_macho_uuid(hash_seed, fd, 0, file_size);
+    }
+
+    const bool is_big_endian = magic == FAT_CIGAM || magic == FAT_CIGAM_64;
+
+    uint32_t nfat_arch = header.nfat_arch;
+    if (is_big_endian) {
+        nfat_arch = swap_uint32(nfat_arch);
+    }
+
+    uint64_t arch_size = sizeof(struct fat_arch);
+    if (is_fat_64) {
+        arch_size = sizeof(struct fat_arch_64);
+    }
+
+    const uint64_t archs_size = arch_size * nfat_arch;
+    if (archs_size > file_size - sizeof(header)) {
+        return hash_seed;
+    }
+
+    uint8_t *const archs = malloc(archs_size);
+    if (archs == NULL) {
+        return hash_seed;
+    }
+
+    if (!pread_all(fd, archs, archs_size, sizeof(header))) {
+        free(archs);
+        return hash_seed;
+    }
+
+    uint64_t hash = hash_seed;
+    for (uint32_t i = 0; i != nfat_arch; i++) {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+
+        if (is_fat_64) {
+            const struct fat_arch_64 *const arch =
+                (const struct fat_arch_64 *)archs + i;
+
+            offset = arch->offset;
+            size = arch->size;
+
+            if (is_big_endian) {
+                offset = swap_uint64(offset);
+                size = swap_uint64(size);
+            }
+        } else {
+            const struct fat_arch *const arch =
+                (const struct fat_arch *)archs + i;
+
+            offset = arch->offset;
+            size = arch->size;
+
+            if (is_big_endian) {
+                offset = swap_uint32((uint32_t)offset);
+                size = swap_uint32((uint32_t)size);
+            }
+        }
+
+        if (offset > file_size || size > file_size - offset) {
+            continue;
+        }
+
+        hash = hash_macho_uuid(hash, fd, offset, size);
+    }
+
+    free(archs);
+    return hash;
+}
+
+bool
+tbd_cache_key_for_macho(struct tbd_cache_key *const key_out,
+                        const struct tbd_for_main *const tbd,
+                        const int fd)
+{
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        return false;
+    }
+
+    if (!S_ISREG(sbuf.st_mode)) {
+        return false;
+    }
+
+    struct tbd_cache_key key = {
+        .kind = TBD_CACHE_KEY_KIND_MACHO
+    };
+
+    fill_key(&key, tbd, &sbuf);
+
+    /*
+     * The uuids of the mach-o are its strongest identity, as the file's
+     * metadata may be the same after it's rebuilt.
+     */
+
+    key.uuids_hash = hash_macho_uuids(fd, (uint64_t)sbuf.st_size);
+
+    *key_out = key;
+    return true;
+}
+
+static uint64_t
+hash_dsc_outputs(const struct tbd_for_main *const tbd,
+                 const char *const write_path,
+                 const uint64_t write_path_length)
+{
+    uint64_t hash = hash_bytes(hash_seed, write_path, write_path_length);
+
+    const struct tbd_for_main_dsc_image_filter *filter =
+        tbd->dsc_image_filters.data;
+
+    const struct tbd_for_main_dsc_image_filter *const filters_end =
+        tbd->dsc_image_filters.data_end;
+
+    for (; filter != filters_end; filter++) {
+        hash = hash_bytes(hash, &filter->type, sizeof(filter->type));
+        hash = hash_bytes(hash, filter->string, filter->length + 1);
+    }
+
+    const struct array *const numbers = &tbd->dsc_image_numbers;
+    hash = hash_bytes(hash, numbers->data, array_get_used_size(numbers));
+
+    const struct tbd_for_main_dsc_image_path *path = tbd->dsc_image_paths.data;
+    const struct tbd_for_main_dsc_image_path *const paths_end =
+        tbd->dsc_image_paths.data_end;
+
+    for (; path != paths_end; path++) {
+        hash = hash_bytes(hash, path->string, path->length + 1);
+    }
+
+    return hash;
+}
+
+bool
+tbd_cache_key_for_dsc(struct tbd_cache_key *const key_out,
+                      const struct tbd_for_main *const tbd,
+                      const int fd,
+                      const struct dyld_shared_cache_info *const dsc_info,
+                      const char *const write_path,
+                      const uint64_t write_path_length)
+{
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        return false;
+    }
+
+    if (!S_ISREG(sbuf.st_mode)) {
+        return false;
+    }
+
+    struct tbd_cache_key key = {
+        .kind = TBD_CACHE_KEY_KIND_DYLD_SHARED_CACHE
+    };
+
+    fill_key(&key, tbd, &sbuf);
+
+    /*
+     * Only newer shared-caches have a uuid in their header, which is present
+     * when the mapping-infos start after it.
+     */
+
+    const uint8_t *const map = dsc_info->map;
+    const uint64_t mapping_offset =
+        (uint64_t)((const uint8_t *)dsc_info->mappings - map);
+
+    const uint64_t uuid_offset = offsetof(struct dyld_cache_header, uuid);
+    if (mapping_offset >= uuid_offset + sizeof(key.uuid)) {
+        memcpy(key.uuid, map + uuid_offset, sizeof(key.uuid));
+    }
+
+    /*
+     * Options on how the shared-cache is mapped don't change what's parsed, and
+     * so are left out of the key.
+     */
+
+    const uint64_t map_policy_options =
+        O_DYLD_SHARED_CACHE_PARSE_ACCESS_RANDOM |
+        O_DYLD_SHARED_CACHE_PARSE_ACCESS_SEQUENTIAL |
+        O_DYLD_SHARED_CACHE_PARSE_POPULATE |
+        O_DYLD_SHARED_CACHE_PARSE_HUGE_PAGES |
+        O_DYLD_SHARED_CACHE_PARSE_PREFETCH;
+
+    key.dsc_options = tbd->dsc_options & ~map_policy_options;
+    key.write_options = tbd->write_options;
+    key.flags = tbd->flags;
+    key.outputs_hash = hash_dsc_outputs(tbd, write_path, write_path_length);
+
+    *key_out = key;
+    return true;
+}
+
+/*
+ * Counts the temporary entries created by this instance of tbd, so that
+ * workers storing the same key never write to the same temporary entry.
+ */
+
+static uint64_t temporary_entries_count = 0;
+
+static char *
+create_entry_path(const char *const cache_path,
+                  const struct tbd_cache_key *const key,
+                  const bool is_temporary)
+{
+    const uint64_t hash = hash_bytes(hash_seed, key, sizeof(*key));
+
+    /*
+     * Temporary entries are named with our pid, so that several instances of
+     * tbd can share a cache-directory, and with a counter, as several workers
+     * may store the same key (such as for hardlinked files).
+     */
+
+    char name[96];
+    int name_length = 0;
+
+    if (is_temporary) {
+        const uint64_t number =
+            __atomic_fetch_add(&temporary_entries_count, 1, __ATOMIC_RELAXED);
+
+        name_length =
+            snprintf(name,
+                     sizeof(name),
+                     "%016" PRIx64 ".%ld.%" PRIu64 ".tmp",
+                     hash,
+                     (long)getpid(),
+                     number);
+    } else {
+        name_length = snprintf(name, sizeof(name), "%016" PRIx64, hash);
+    }
+
+    return path_append_component_with_len(cache_path,
+                                          strlen(cache_path),
+                                          name,
+                                          (uint64_t)name_length,
+                                          NULL);
+}
+
+/*
+ * Returns whether name is that of a temporary entry created by an instance of
+ * tbd that is no longer running.
+ */
+
+static bool is_stale_temporary_entry(const char *const name) {
+    uint64_t hash = 0;
+    long pid = 0;
+    uint64_t number = 0;
+    int name_length = 0;
+
+    const int count =
+        sscanf(name,
+               "%16" SCNx64 ".%ld.%" SCNu64 ".tmp%n",
+               &hash,
+               &pid,
+               &number,
+               &name_length);
+
+    if (count != 3 || name[name_length] != '\0') {
+        return false;
+    }
+
+    if (pid <= 0 || pid == (long)getpid()) {
+        return false;
+    }
+
+    return kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
+
+void tbd_cache_remove_stale_entries(const char *const cache_path) {
+    DIR *const dir = opendir(cache_path);
+    if (dir == NULL) {
+        return;
+    }
+
+    const uint64_t cache_path_length = strlen(cache_path);
+    for (struct dirent *entry = readdir(dir);
+         entry != NULL;
+         entry = readdir(dir))
+    {
+        const char *const name = entry->d_name;
+        if (!is_stale_temporary_entry(name)) {
+            continue;
+        }
+
+        char *const path =
+            path_append_component_with_len(cache_path,
+                                           cache_path_length,
+                                           name,
+                                           strlen(name),
+                                           NULL);
+
+        if (path == NULL) {
+            break;
+        }
+
+        unlink(path);
+        free(path);
+    }
+
+    closedir(dir);
+}
+
+/*
+ * Read in the full entry for key, returning NULL if the entry doesn't exist,
+ * or if its header doesn't match.
+ */
+
+static uint8_t *
+read_entry(const char *const cache_path,
+           const struct tbd_cache_key *const key,
+           uint64_t *const size_out)
+{
+    char *const entry_path = create_entry_path(cache_path, key, false);
+    if (entry_path == NULL) {
+        return NULL;
+    }
+
+    const int fd = open(entry_path, O_RDONLY);
+    free(entry_path);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat sbuf = {};
+    if (fstat(fd, &sbuf) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    const uint64_t size = (uint64_t)sbuf.st_size;
+    if (size < sizeof(struct tbd_cache_entry_header)) {
+        close(fd);
+        return NULL;
+    }
+
+    uint8_t *const entry = malloc(size);
+    if (entry == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    uint64_t read_size = 0;
+    while (read_size != size) {
+        const ssize_t result = read(fd, entry + read_size, size - read_size);
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+
+            free(entry);
+            close(fd);
+
+            return NULL;
+        }
+
+        read_size += (uint64_t)result;
+    }
+
+    close(fd);
+
+    const struct tbd_cache_entry_header *const header =
+        (const struct tbd_cache_entry_header *)entry;
+
+    if (memcmp(header->magic, tbd_cache_magic, sizeof(tbd_cache_magic)) != 0) {
+        free(entry);
+        return NULL;
+    }
+
+    if (header->format_version != tbd_cache_format_version) {
+        free(entry);
+        return NULL;
+    }
+
+    /*
+     * Entries are named after the hash of their key, so ensure the full key
+     * matches.
+     */
+
+    if (memcmp(&header->key, key, sizeof(*key)) != 0) {
+        free(entry);
+        return NULL;
+    }
+
+    *size_out = size;
+    return entry;
+}
+
+static void
+write_entry(const char *const cache_path,
+            const struct tbd_cache_key *const key,
+            const struct write_buffer *const buffer)
+{
+    char *const tmp_path = create_entry_path(cache_path, key, true);
+    if (tmp_path == NULL) {
+        return;
+    }
+
+    char *const entry_path = create_entry_path(cache_path, key, false);
+    if (entry_path == NULL) {
+        free(tmp_path);
+        return;
+    }
+
+    /*
+     * Never write into a temporary entry that already exists, which can only
+     * be left over from an earlier instance of tbd with the same pid.
+     */
+
+    const int flags = O_WRONLY | O_CREAT | O_EXCL;
+
+    int fd = open(tmp_path, flags, 0644);
+    if (fd < 0 && errno == ENOENT) {
+        mkdir(cache_path, 0755);
+        fd = open(tmp_path, flags, 0644);
+    }
+
+    if (fd < 0) {
+        free(tmp_path);
+        free(entry_path);
+
+        return;
+    }
+
+    const int write_result = write_buffer_write_to_fd(buffer, fd);
+    close(fd);
+
+    /*
+     * Write the entry out to a temporary file first, and only rename it into
+     * place once fully written, so a partial entry is never read.
+     */
+
+    if (write_result != 0 || rename(tmp_path, entry_path) != 0) {
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+    free(entry_path);
+}
+
+static int
+append_entry_header(struct write_buffer *const buffer,
+                    const struct tbd_cache_key *const key)
+{
+    struct tbd_cache_entry_header header = {
+        .format_version = tbd_cache_format_version,
+        .key = *key
+    };
+
+    memcpy(header.magic, tbd_cache_magic, sizeof(tbd_cache_magic));
+    return write_buffer_append(buffer, (const char *)&header, sizeof(header));
+}
+
+static inline int
+append_uint32(struct write_buffer *const buffer, const uint32_t value) {
+    return write_buffer_append(buffer, (const char *)&value, sizeof(value));
+}
+
+static inline int
+append_uint64(struct write_buffer *const buffer, const uint64_t value) {
+    return write_buffer_append(buffer, (const char *)&value, sizeof(value));
+}
+
+static int
+append_string(struct write_buffer *const buffer,
+              const char *const string,
+              const uint32_t length)
+{
+    /*
+     * Strings are stored with a leading byte to mark whether they're present,
+     * followed by their length and contents.
+     */
+
+    if (string == NULL) {
+        return write_buffer_append_char(buffer, 0);
+    }
+
+    if (write_buffer_append_char(buffer, 1)) {
+        return 1;
+    }
+
+    if (append_uint32(buffer, length)) {
+        return 1;
+    }
+
+    return write_buffer_append(buffer, string, length);
+}
+
+static int
+append_info(struct write_buffer *const buffer,
+            const struct tbd_create_info *const info)
+{
+    const uint64_t info_flags =
+        info->flags &
+        ~(uint64_t)(F_TBD_CREATE_INFO_STRINGS_WERE_COPIED |
+                    F_TBD_CREATE_INFO_EXPORTS_ARE_SORTED);
+
+    if (append_uint64(buffer, info->version) ||
+        append_uint64(buffer, info->archs) ||
+        append_uint64(buffer, info->flags_field) ||
+        append_uint64(buffer, info->platform) ||
+        append_uint64(buffer, info->objc_constraint) ||
+        append_uint64(buffer, info->current_version) ||
+        append_uint64(buffer, info->compatibility_version) ||
+        append_uint64(buffer, info->swift_version) ||
+        append_uint64(buffer, info_flags))
+    {
+        return 1;
+    }
+
+    const char *const install_name = info->install_name;
+    const uint32_t install_name_length = info->install_name_length;
+
+    if (append_string(buffer, install_name, install_name_length)) {
+        return 1;
+    }
+
+    const char *const parent_umbrella = info->parent_umbrella;
+    const uint32_t parent_umbrella_length = info->parent_umbrella_length;
+
+    if (append_string(buffer, parent_umbrella, parent_umbrella_length)) {
+        return 1;
+    }
+
+    const struct array *const exports = &info->exports;
+    const uint64_t exports_count =
+        array_get_item_count(exports, sizeof(struct tbd_export_info));
+
+    if (append_uint64(buffer, exports_count)) {
+        return 1;
+    }
+
+    const struct tbd_export_info *export = exports->data;
+    const struct tbd_export_info *const exports_end = exports->data_end;
+
+    for (; export != exports_end; export++) {
+        /*
+         * Export strings are always copied when loaded, so never store them as
+         * borrowed.
+         */
+
+        const uint64_t export_flags =
+            export->flags & ~(uint64_t)F_TBD_EXPORT_INFO_STRING_IS_BORROWED;
+
+        if (append_uint64(buffer, export->archs) ||
+            append_uint64(buffer, export->archs_count) ||
+            append_uint32(buffer, export->type) ||
+            append_uint64(buffer, export_flags) ||
+            append_string(buffer, export->string, export->length))
+        {
+            return 1;
+        }
+    }
+
+    const struct array *const uuids = &info->uuids;
+    const uint64_t uuids_count =
+        array_get_item_count(uuids, sizeof(struct tbd_uuid_info));
+
+    if (append_uint64(buffer, uuids_count)) {
+        return 1;
+    }
+
+    const struct arch_info *const arch_info_list = arch_info_get_list();
+
+    const struct tbd_uuid_info *uuid = uuids->data;
+    const struct tbd_uuid_info *const uuids_end = uuids->data_end;
+
+    for (; uuid != uuids_end; uuid++) {
+        uint32_t arch_index = UINT32_MAX;
+        if (uuid->arch != NULL) {
+            arch_index = (uint32_t)(uuid->arch - arch_info_list);
+        }
+
+        if (append_uint32(buffer, arch_index)) {
+            return 1;
+        }
+
+        const char *const uuid_data = (const char *)uuid->uuid;
+        if (write_buffer_append(buffer, uuid_data, sizeof(uuid->uuid))) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void
+tbd_cache_store_info(const char *const cache_path,
+                     const struct tbd_cache_key *const key,
+                     const struct tbd_create_info *const info)
+{
+    struct write_buffer buffer = {};
+    if (append_entry_header(&buffer, key) == 0) {
+        if (append_info(&buffer, info) == 0) {
+            write_entry(cache_path, key, &buffer);
+        }
+    }
+
+    write_buffer_destroy(&buffer);
+}
+
+struct entry_reader {
+    const uint8_t *iter;
+    const uint8_t *end;
+};
+
+static bool
+read_bytes(struct entry_reader *const reader,
+           void *const data_out,
+           const uint64_t size)
+{
+    if ((uint64_t)(reader->end - reader->iter) < size) {
+        return false;
+    }
+
+    memcpy(data_out, reader->iter, size);
+    reader->iter += size;
+
+    return true;
+}
+
+static inline
+bool read_uint32(struct entry_reader *const reader, uint32_t *const value_out) {
+    return read_bytes(reader, value_out, sizeof(*value_out));
+}
+
+static inline
+bool read_uint64(struct entry_reader *const reader, uint64_t *const value_out) {
+    return read_bytes(reader, value_out, sizeof(*value_out));
+}
+
+/*
+ * Read a string, returning a pointer into the entry, which isn't
+ * null-terminated.
+ */
+
+static bool
+read_string(struct entry_reader *const reader,
+            const char **const string_out,
+            uint32_t *const length_out)
+{
+    uint8_t is_present = 0;
+    if (!read_bytes(reader, &is_present, sizeof(is_present))) {
+        return false;
+    }
+
+    if (!is_present) {
+        *string_out = NULL;
+        *length_out = 0;
+
+        return true;
+    }
+
+    uint32_t length = 0;
+    if (!read_uint32(reader, &length)) {
+        return false;
+    }
+
+    if ((uint64_t)(reader->end - reader->iter) < length) {
+        return false;
+    }
+
+    *string_out = (const char *)reader->iter;
+    *length_out = length;
+
+    reader->iter += length;
+    return true;
+}
+
+static char *copy_string(const char *const string, const uint32_t length) {
+    if (string == NULL) {
+        return NULL;
+    }
+
+    char *const copy = malloc(length + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+}
+
+static bool
+read_info(struct entry_reader *const reader,
+          struct tbd_create_info *const info_in)
+{
+    uint64_t version = 0;
+    uint64_t archs = 0;
+    uint64_t flags_field = 0;
+    uint64_t platform = 0;
+    uint64_t objc_constraint = 0;
+    uint64_t current_version = 0;
+    uint64_t compatibility_version = 0;
+    uint64_t swift_version = 0;
+    uint64_t info_flags = 0;
+
+    if (!read_uint64(reader, &version) ||
+        !read_uint64(reader, &archs) ||
+        !read_uint64(reader, &flags_field) ||
+        !read_uint64(reader, &platform) ||
+        !read_uint64(reader, &objc_constraint) ||
+        !read_uint64(reader, &current_version) ||
+        !read_uint64(reader, &compatibility_version) ||
+        !read_uint64(reader, &swift_version) ||
+        !read_uint64(reader, &info_flags))
+    {
+        return false;
+    }
+
+    const char *install_name = NULL;
+    uint32_t install_name_length = 0;
+
+    if (!read_string(reader, &install_name, &install_name_length)) {
+        return false;
+    }
+
+    const char *parent_umbrella = NULL;
+    uint32_t parent_umbrella_length = 0;
+
+    if (!read_string(reader, &parent_umbrella, &parent_umbrella_length)) {
+        return false;
+    }
+
+    /*
+     * Copy both strings before setting either, as info's strings are either
+     * both allocated, or both not.
+     */
+
+    char *const install_name_copy =
+        copy_string(install_name, install_name_length);
+
+    if (install_name != NULL && install_name_copy == NULL) {
+        return false;
+    }
+
+    char *const parent_umbrella_copy =
+        copy_string(parent_umbrella, parent_umbrella_length);
+
+    if (parent_umbrella != NULL && parent_umbrella_copy == NULL) {
+        free(install_name_copy);
+        return false;
+    }
+
+    if (info_in->flags & F_TBD_CREATE_INFO_STRINGS_WERE_COPIED) {
+        free((char *)info_in->install_name);
+        free((char *)info_in->parent_umbrella);
+    }
+
+    info_in->version = (enum tbd_version)version;
+    info_in->archs = archs;
+    info_in->flags_field = (uint32_t)flags_field;
+    info_in->platform = (enum tbd_platform)platform;
+    info_in->objc_constraint = (enum tbd_objc_constraint)objc_constraint;
+    info_in->current_version = (uint32_t)current_version;
+    info_in->compatibility_version = (uint32_t)compatibility_version;
+    info_in->swift_version = (uint32_t)swift_version;
+
+    info_in->install_name = install_name_copy;
+    info_in->install_name_length = install_name_length;
+
+    info_in->parent_umbrella = parent_umbrella_copy;
+    info_in->parent_umbrella_length = parent_umbrella_length;
+
+    info_in->flags = info_flags | F_TBD_CREATE_INFO_STRINGS_WERE_COPIED;
+
+    uint64_t exports_count = 0;
+    if (!read_uint64(reader, &exports_count)) {
+        return false;
+    }
+
+    /*
+     * Every export takes up more than 32 bytes, so don't trust a count larger
+     * than what's left of the entry.
+     */
+
+    if (exports_count > (uint64_t)(reader->end - reader->iter) / 32) {
+        return false;
+    }
+
+    const enum array_result ensure_exports_capacity_result =
+        array_ensure_item_capacity(&info_in->exports,
+                                   sizeof(struct tbd_export_info),
+                                   exports_count);
+
+    if (ensure_exports_capacity_result != E_ARRAY_OK) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i != exports_count; i++) {
+        struct tbd_export_info export_info = {};
+
+        uint64_t archs_count = 0;
+        uint64_t export_flags = 0;
+        uint32_t type = 0;
+
+        if (!read_uint64(reader, &export_info.archs) ||
+            !read_uint64(reader, &archs_count) ||
+            !read_uint32(reader, &type) ||
+            !read_uint64(reader, &export_flags))
+        {
+            return false;
+        }
+
+        if (archs_count > 64 || export_flags > UINT8_MAX) {
+            return false;
+        }
+
+        if (type < TBD_EXPORT_TYPE_CLIENT ||
+            type > TBD_EXPORT_TYPE_WEAK_DEF_SYMBOL)
+        {
+            return false;
+        }
+
+        const char *string = NULL;
+        if (!read_string(reader, &string, &export_info.length)) {
+            return false;
+        }
+
+        if (string == NULL) {
+            return false;
+        }
+
+        export_info.archs_count = (uint8_t)archs_count;
+        export_info.type = (uint8_t)type;
+        export_info.flags = (uint8_t)export_flags;
+        export_info.string =
+            string_pool_copy_string(&info_in->export_strings,
+                                    string,
+                                    export_info.length);
+
+        if (export_info.string == NULL) {
+            return false;
+        }
+
+        const enum array_result add_export_result =
+            array_add_item(&info_in->exports,
+                           sizeof(export_info),
+                           &export_info,
+                           NULL);
+
+        if (add_export_result != E_ARRAY_OK) {
+            return false;
+        }
+    }
+
+    uint64_t uuids_count = 0;
+    if (!read_uint64(reader, &uuids_count)) {
+        return false;
+    }
+
+    const struct arch_info *const arch_info_list = arch_info_get_list();
+    const uint64_t arch_info_list_size = arch_info_list_get_size();
+
+    for (uint64_t i = 0; i != uuids_count; i++) {
+        struct tbd_uuid_info uuid_info = {};
+        uint32_t arch_index = 0;
+
+        if (!read_uint32(reader, &arch_index)) {
+            return false;
+        }
+
+        if (!read_bytes(reader, uuid_info.uuid, sizeof(uuid_info.uuid))) {
+            return false;
+        }
+
+        if (arch_index != UINT32_MAX) {
+            if (arch_index >= arch_info_list_size) {
+                return false;
+            }
+
+            uuid_info.arch = arch_info_list + arch_index;
+        }
+
+        const enum array_result add_uuid_result =
+            array_add_item(&info_in->uuids,
+                           sizeof(uuid_info),
+                           &uuid_info,
+                           NULL);
+
+        if (add_uuid_result != E_ARRAY_OK) {
+            return false;
+        }
+    }
+
+    return reader->iter == reader->end;
+}
+
+bool
+tbd_cache_load_info(const char *const cache_path,
+                    const struct tbd_cache_key *const key,
+                    struct tbd_create_info *const info)
+{
+    uint64_t size = 0;
+    uint8_t *const entry = read_entry(cache_path, key, &size);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    struct entry_reader reader = {
+        .iter = entry + sizeof(struct tbd_cache_entry_header),
+        .end = entry + size
+    };
+
+    const bool result = read_info(&reader, info);
+    free(entry);
+
+    return result;
+}
+
+bool
+tbd_cache_has_entry(const char *const cache_path,
+                    const struct tbd_cache_key *const key)
+{
+    uint64_t size = 0;
+    uint8_t *const entry = read_entry(cache_path, key, &size);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    struct entry_reader reader = {
+        .iter = entry + sizeof(struct tbd_cache_entry_header),
+        .end = entry + size
+    };
+
+    uint64_t paths_count = 0;
+    if (!read_uint64(&reader, &paths_count)) {
+        free(entry);
+        return false;
+    }
+
+    /*
+     * The shared-cache has to be extracted again if any of the files written
+     * out have since been removed.
+     */
+
+    for (uint64_t i = 0; i != paths_count; i++) {
+        const char *path = NULL;
+        uint32_t length = 0;
+
+        if (!read_string(&reader, &path, &length)) {
+            free(entry);
+            return false;
+        }
+
+        char *const path_copy = copy_string(path, length);
+        if (path_copy == NULL) {
+            free(entry);
+            return false;
+        }
+
+        const int access_result = access(path_copy, F_OK);
+        free(path_copy);
+
+        if (access_result != 0) {
+            free(entry);
+            return false;
+        }
+    }
+
+    const bool result = reader.iter == reader.end;
+    free(entry);
+
+    return result;
+}
+
+void
+tbd_cache_store_entry(const char *const cache_path,
+                      const struct tbd_cache_key *const key,
+                      const struct array *const written_paths)
+{
+    struct write_buffer buffer = {};
+    if (append_entry_header(&buffer, key) != 0) {
+        write_buffer_destroy(&buffer);
+        return;
+    }
+
+    const uint64_t paths_count =
+        array_get_item_count(written_paths, sizeof(char *));
+
+    if (append_uint64(&buffer, paths_count) != 0) {
+        write_buffer_destroy(&buffer);
+        return;
+    }
+
+    char *const *path = written_paths->data;
+    char *const *const paths_end = written_paths->data_end;
+
+    for (; path != paths_end; path++) {
+        const uint32_t length = (uint32_t)strlen(*path);
+        if (append_string(&buffer, *path, length) != 0) {
+            write_buffer_destroy(&buffer);
+            return;
+        }
+    }
+
+    write_entry(cache_path, key, &buffer);
+    write_buffer_destroy(&buffer);
+}
@@ -13,8 +13,10 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "copy.h"
+#include "dyld_shared_cache.h"
 #include "macho_file.h"
 #include "parse_or_list_fields.h"
 
@@ -202,6 +204,49 @@ tbd_for_main_parse_option(struct tbd_for_main *const tbd,
         tbd->parse_options |= O_TBD_PARSE_ALLOW_PRIVATE_OBJC_CLASS_SYMBOLS;
     } else if (strcmp(option, "allow-private-objc-ivar-symbols") == 0) {
         tbd->parse_options |= O_TBD_PARSE_ALLOW_PRIVATE_OBJC_IVAR_SYMBOLS;
+    } else if (strcmp(option, "cache-dir") == 0) {
+        index += 1;
+        if (index == argc) {
+            fputs("Please provide a path to a directory to cache in\n", stderr);
+            exit(1);
+        }
+
+        tbd->cache_path = argv[index];
+    } else if (strcmp(option, "dsc-access") == 0) {
+        index += 1;
+        if (index == argc) {
+            fputs("Please provide an access-pattern for dyld_shared_cache "
+                  "files\n",
+                  stderr);
+
+            exit(1);
+        }
+
+        const uint64_t access_options =
+            O_DYLD_SHARED_CACHE_PARSE_ACCESS_RANDOM |
+            O_DYLD_SHARED_CACHE_PARSE_ACCESS_SEQUENTIAL;
+
+        const char *const argument = argv[index];
+        tbd->dsc_options &= ~access_options;
+
+        if (strcmp(argument, "random") == 0) {
+            tbd->dsc_options |= O_DYLD_SHARED_CACHE_PARSE_ACCESS_RANDOM;
+        } else if (strcmp(argument, "sequential") == 0) {
+            tbd->dsc_options |= O_DYLD_SHARED_CACHE_PARSE_ACCESS_SEQUENTIAL;
+        } else if (strcmp(argument, "normal") != 0) {
+            fprintf(stderr,
+                    "Unrecognized access-pattern: %s. Please provide either "
+                    "normal, random, or sequential\n",
+                    argument);
+
+            exit(1);
+        }
+    } else if (strcmp(option, "dsc-huge-pages") == 0) {
+        tbd->dsc_options |= O_DYLD_SHARED_CACHE_PARSE_HUGE_PAGES;
+    } else if (strcmp(option, "dsc-populate") == 0) {
+        tbd->dsc_options |= O_DYLD_SHARED_CACHE_PARSE_POPULATE;
+    } else if (strcmp(option, "dsc-prefetch") == 0) {
+        tbd->dsc_options |= O_DYLD_SHARED_CACHE_PARSE_PREFETCH;
     } else if (strcmp(option, "ignore-clients") == 0) {
         tbd->parse_options |= O_TBD_PARSE_IGNORE_CLIENTS;
     } else if (strcmp(option, "ignore-compatibility-version") == 0) {
@@ -234,6 +279,25 @@ tbd_for_main_parse_option(struct tbd_for_main *const tbd,
         add_image_number(&index, tbd, argc, argv);
     } else if (strcmp(option, "image-path") == 0) {
         add_image_path(tbd, argc, argv, &index);
+    } else if (strcmp(option, "j") == 0 || strcmp(option, "jobs") == 0) {
+        index += 1;
+        if (index == argc) {
+            fputs("Please provide a number of jobs to run\n", stderr);
+            exit(1);
+        }
+
+        const char *const argument = argv[index];
+        const unsigned long jobs = strtoul(argument, NULL, 10);
+
+        if (jobs == 0 || jobs > UINT32_MAX) {
+            fprintf(stderr, "Invalid number of jobs: %s\n", argument);
+            exit(1);
+        }
+
+        tbd->jobs = (uint32_t)jobs;
+    } else if (strcmp(option, "only-archs") == 0) {
+        index += 1;
+        tbd->only_archs |= parse_architectures_list(argc, argv, &index);
     } else if (strcmp(option, "remove-archs") == 0) {
         if (!(tbd->flags & F_TBD_FOR_MAIN_ADD_OR_REMOVE_ARCHS)) {
             if (tbd->archs_re != 0) {
@@ -452,7 +516,7 @@ tbd_for_main_create_write_path(const struct tbd_for_main *const tbd,
 }
 
 enum tbd_for_main_write_to_path_result
-tbd_for_main_write_to_path(const struct tbd_for_main *const tbd,
+tbd_for_main_write_to_path(struct tbd_for_main *const tbd,
                            char *const write_path,
                            const uint64_t write_path_length,
                            const bool print_paths)
@@ -517,31 +581,24 @@ tbd_for_main_write_to_path(const struct tbd_for_main *const tbd,
         return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
     }
 
-    FILE *const write_file = fdopen(write_fd, "w");
-    if (write_file == NULL) {
-        if (!(options & F_TBD_FOR_MAIN_IGNORE_WARNINGS)) {
-            if (print_paths) {
-                fprintf(stderr,
-                        "Failed to open output-file (for path: %s) as FILE, "
-                        "error: %s\n",
-                        write_path,
-                        strerror(errno));
-            } else {
-                fprintf(stderr,
-                        "Failed to open the provided output-file as FILE, "
-                        "error: %s\n",
-                        strerror(errno));
-            }
-        }
+    /*
+     * Format the entire tbd into a buffer, and write it out with a single
+     * write() call.
+     */
 
-        return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
-    }
+    struct write_buffer *const buffer = &tbd->write_buffer;
+    write_buffer_clear(buffer);
 
     const struct tbd_create_info *const create_info = &tbd->info;
     const enum tbd_create_result create_tbd_result =
-        tbd_create_with_info(create_info, write_file, tbd->write_options);
+        tbd_create_with_info(create_info, buffer, tbd->write_options);
 
-    if (create_tbd_result != E_TBD_CREATE_OK) {
+    bool write_failed = create_tbd_result != E_TBD_CREATE_OK;
+    if (!write_failed) {
+        write_failed = write_buffer_write_to_fd(buffer, write_fd);
+    }
+
+    if (write_failed) {
         if (terminator != NULL) {
             /*
              * Ignore the return value as we cannot be sure if the remove failed
@@ -553,26 +610,40 @@ tbd_for_main_write_to_path(const struct tbd_for_main *const tbd,
         }
 
         if (!(options & F_TBD_FOR_MAIN_IGNORE_WARNINGS)) {
-            fclose(write_file);
+            close(write_fd);
             return E_TBD_FOR_MAIN_WRITE_TO_PATH_WRITE_FAIL;
         }
 
     }
 
-    fclose(write_file);
+    close(write_fd);
     return E_TBD_FOR_MAIN_WRITE_TO_PATH_OK;
 }
 
 void
-tbd_for_main_write_to_stdout(const struct tbd_for_main *const tbd,
+tbd_for_main_write_to_stdout(struct tbd_for_main *const tbd,
                              const char *const input_path,
                              const bool print_paths)
 {
+    struct write_buffer *const buffer = &tbd->write_buffer;
+    write_buffer_clear(buffer);
+
     const struct tbd_create_info *const create_info = &tbd->info;
     const enum tbd_create_result create_tbd_result =
-        tbd_create_with_info(create_info, stdout, tbd->write_options);
+        tbd_create_with_info(create_info, buffer, tbd->write_options);
+
+    /*
+     * Flush anything already written to stdout through stdio, so that our
+     * output isn't reordered before it.
+     */
+
+    bool write_failed = create_tbd_result != E_TBD_CREATE_OK;
+    if (!write_failed) {
+        fflush(stdout);
+        write_failed = write_buffer_write_to_fd(buffer, STDOUT_FILENO);
+    }
 
-    if (create_tbd_result != E_TBD_CREATE_OK) {
+    if (write_failed) {
         if (!(tbd->flags & F_TBD_FOR_MAIN_IGNORE_WARNINGS)) {
             if (print_paths) {
                 fprintf(stderr,
@@ -696,6 +767,18 @@ tbd_for_main_apply_from(struct tbd_for_main *const dst,
         dst->info.version = src->info.version;
     }
 
+    if (dst->jobs == 0) {
+        dst->jobs = src->jobs;
+    }
+
+    if (dst->only_archs == 0) {
+        dst->only_archs = src->only_archs;
+    }
+
+    if (dst->cache_path == NULL) {
+        dst->cache_path = src->cache_path;
+    }
+
     if (dst->filetype == TBD_FOR_MAIN_FILETYPE_DYLD_SHARED_CACHE) {
         const struct array *const src_filters = &src->dsc_image_filters;
         if (!array_is_empty(src_filters)) {
@@ -768,6 +851,9 @@ void tbd_for_main_destroy(struct tbd_for_main *const tbd) {
     array_destroy(&tbd->dsc_image_filters);
     array_destroy(&tbd->dsc_image_numbers);
     array_destroy(&tbd->dsc_image_paths);
+    array_destroy(&tbd->dsc_merge_paths);
+
+    write_buffer_destroy(&tbd->write_buffer);
 
     free(tbd->parse_path);
     free(tbd->write_path);
@@ -6,107 +6,33 @@
 //  Copyright © 2018 - 2019 inoahdev. All rights reserved.
 //
 
-#include <inttypes.h>
-#include <stdio.h>
-
 #include "tbd_write.h"
 #include "yaml.h"
 
-int tbd_write_archs_for_header(FILE *const file, const uint64_t archs) {
-    if (archs == 0) {
-        return 1;
-    }
-
-    /*
-     * We need to find the first arch-info to print the list, and then print
-     * subsequent archs with a preceding comma.
-     */
-
-    const struct arch_info *arch_info_list = arch_info_get_list();
-
-    uint64_t index = 0;
-    uint64_t archs_iter = archs;
-
-    do {
-        if (archs_iter & 1) {
-            const struct arch_info *const arch = arch_info_list + index;
-            if (fprintf(file, "archs:%-17s[ %s", "", arch->name) < 0) {
-                return 1;
-            }
-
-            archs_iter >>= 1;
-            break;
-        }
-
-        archs_iter >>= 1;
-        if (archs_iter == 0) {
-            /*
-             * If we're already at the end, simply write the end bracket for the
-             * arch-info list and return.
-             */
-
-            if (fputs(" ]\n", file) < 0) {
-                return 1;
-            }
-
-            return 0;
-        }
-
-        index += 1;
-    } while (true);
-
-    /*
-     * After writing the first arch, write the following archs with a
-     * preceding comma.
-     *
-     * Count the amount of archs on one line, starting off with one as we just
-     * wrote one before looping over the rest. When the counter reaches 7, print
-     * a newline and reset the counter.
-     */
-
-    uint64_t counter = 1;
-
-    do {
-        index += 1;
-
-        if (archs_iter & 1) {
-            const struct arch_info *const arch = arch_info_list + index;
-            if (fprintf(file, ", %s", arch->name) < 0) {
-                return 1;
-            }
-
-            /*
-             * Break lines for every seven archs written out.
-             */
-
-            counter++;
-            if (counter == 7) {
-                if (fprintf(file, "\n%-19s", "") < 0) {
-                    return 1;
-                }
-
-                counter = 0;
-            }
-        }
-
-        archs_iter >>= 1;
-        if (archs_iter == 0) {
-            break;
-        }
-    } while (true);
-
-    /*
-     * Write the end bracket for the arch-info list and return.
-     */
+/*
+ * Write out a key followed by enough spaces for its value to start at column,
+ * as was previously done with fprintf's "%-*s" padding.
+ */
 
-    if (fputs(" ]\n", file) < 0) {
+static inline int
+write_padded_key(struct write_buffer *const buffer,
+                 const char *const key,
+                 const uint64_t column)
+{
+    const uint64_t length = strlen(key);
+    if (write_buffer_append(buffer, key, length)) {
         return 1;
     }
 
-    return 0;
+    return write_buffer_append_spaces(buffer, column - length);
 }
 
-static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
+static int
+write_archs_list(struct write_buffer *const buffer,
+                 const char *const key,
+                 const uint64_t column,
+                 const uint64_t archs)
+{
     if (archs == 0) {
         return 1;
     }
@@ -124,7 +50,15 @@ static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
     do {
         if (archs_iter & 1) {
             const struct arch_info *const arch = arch_info_list + index;
-            if (fprintf(file, "  - archs:%-14s[ %s", "", arch->name) < 0) {
+            if (write_padded_key(buffer, key, column)) {
+                return 1;
+            }
+
+            if (write_buffer_append_c_str(buffer, "[ ")) {
+                return 1;
+            }
+
+            if (write_buffer_append_c_str(buffer, arch->name)) {
                 return 1;
             }
 
@@ -135,10 +69,11 @@ static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
         archs_iter >>= 1;
         if (archs_iter == 0) {
             /*
-             * Write the end bracket for the arch-info list and return.
+             * If we're already at the end, simply write the end bracket for the
+             * arch-info list and return.
              */
 
-            if (fputs(" ]\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, " ]\n")) {
                 return 1;
             }
 
@@ -164,7 +99,11 @@ static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
 
         if (archs_iter & 1) {
             const struct arch_info *const arch = arch_info_list + index;
-            if (fprintf(file, ", %s", arch->name) < 0) {
+            if (write_buffer_append_c_str(buffer, ", ")) {
+                return 1;
+            }
+
+            if (write_buffer_append_c_str(buffer, arch->name)) {
                 return 1;
             }
 
@@ -174,7 +113,11 @@ static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
 
             counter++;
             if (counter == 7) {
-                if (fprintf(file, "\n%-19s", "") < 0) {
+                if (write_buffer_append_char(buffer, '\n')) {
+                    return 1;
+                }
+
+                if (write_buffer_append_spaces(buffer, 19)) {
                     return 1;
                 }
 
@@ -192,14 +135,30 @@ static int write_archs_for_exports(FILE *const file, const uint64_t archs) {
      * Write the end bracket for the arch-info list and return.
      */
 
-    if (fputs(" ]\n", file) < 0) {
+    if (write_buffer_append_c_str(buffer, " ]\n")) {
         return 1;
     }
 
     return 0;
 }
 
-static int write_packed_version(FILE *const file, const uint32_t version) {
+int
+tbd_write_archs_for_header(struct write_buffer *const buffer,
+                           const uint64_t archs)
+{
+    return write_archs_list(buffer, "archs:", 23, archs);
+}
+
+static int
+write_archs_for_exports(struct write_buffer *const buffer,
+                        const uint64_t archs)
+{
+    return write_archs_list(buffer, "  - archs:", 24, archs);
+}
+
+static int
+write_packed_version(struct write_buffer *const buffer, const uint32_t version)
+{
     /*
      * The revision for a packed-version is stored in the LSB byte.
      */
@@ -217,12 +176,16 @@ static int write_packed_version(FILE *const file, const uint32_t version) {
      */
 
     const uint16_t major = (version & 0xffff0000) >> 16;
-    if (fprintf(file, "%" PRIu16, major) < 0) {
+    if (write_buffer_append_uint32(buffer, major)) {
         return 1;
     }
 
     if (minor != 0) {
-        if (fprintf(file, ".%" PRIu8, minor) < 0) {
+        if (write_buffer_append_char(buffer, '.')) {
+            return 1;
+        }
+
+        if (write_buffer_append_uint32(buffer, minor)) {
             return 1;
         }
     }
@@ -234,68 +197,88 @@ static int write_packed_version(FILE *const file, const uint32_t version) {
          */
 
         if (minor == 0) {
-            if (fputs(".0", file) < 0) {
+            if (write_buffer_append_c_str(buffer, ".0")) {
                 return 1;
             }
         }
 
-        if (fprintf(file, ".%" PRIu8, revision) < 0) {
+        if (write_buffer_append_char(buffer, '.')) {
+            return 1;
+        }
+
+        if (write_buffer_append_uint32(buffer, revision)) {
             return 1;
         }
     }
 
-    if (fputc('\n', file) < 0) {
+    if (write_buffer_append_char(buffer, '\n')) {
         return 1;
     }
 
     return 0;
 }
 
-int tbd_write_current_version(FILE *const file, const uint32_t version) {
-    if (fprintf(file, "current-version:%-7s", "") < 0) {
+int
+tbd_write_current_version(struct write_buffer *const buffer,
+                          const uint32_t version)
+{
+    if (write_padded_key(buffer, "current-version:", 23)) {
         return 1;
     }
 
-    return write_packed_version(file, version);
+    return write_packed_version(buffer, version);
 }
 
-int tbd_write_compatibility_version(FILE *const file, const uint32_t version) {
-    if (fputs("compatibility-version: ", file) < 0) {
+int
+tbd_write_compatibility_version(struct write_buffer *const buffer,
+                                const uint32_t version)
+{
+    if (write_padded_key(buffer, "compatibility-version:", 23)) {
         return 1;
     }
 
-    return write_packed_version(file, version);
+    return write_packed_version(buffer, version);
 }
 
-int tbd_write_footer(FILE *const file) {
-    if (fputs("...\n", file) < 0) {
+int tbd_write_footer(struct write_buffer *const buffer) {
+    if (write_buffer_append_c_str(buffer, "...\n")) {
         return 1;
     }
 
     return 0;
 }
 
-int tbd_write_flags(FILE *const file, const uint64_t flags) {
+int tbd_write_flags(struct write_buffer *const buffer, const uint64_t flags) {
     if (flags == 0) {
         return 0;
     }
 
     if (flags & TBD_FLAG_FLAT_NAMESPACE) {
-        if (fprintf(file, "flags:%-17s[ flat_namespace", "") < 0) {
+        if (write_padded_key(buffer, "flags:", 23)) {
+            return 1;
+        }
+
+        if (write_buffer_append_c_str(buffer, "[ flat_namespace")) {
             return 1;
         }
 
         if (flags & TBD_FLAG_NOT_APP_EXTENSION_SAFE) {
-            if (fputs(", not_app_extension_safe", file) < 0) {
+            const char *const str = ", not_app_extension_safe";
+            if (write_buffer_append_c_str(buffer, str)) {
                 return 1;
             }
         }
 
-        if (fputs(" ]\n", file) < 0) {
+        if (write_buffer_append_c_str(buffer, " ]\n")) {
             return 1;
         }
     } else if (flags & TBD_FLAG_NOT_APP_EXTENSION_SAFE) {
-        if (fprintf(file, "flags:%-17s[ not_app_extension_safe ]\n", "") < 0) {
+        if (write_padded_key(buffer, "flags:", 23)) {
+            return 1;
+        }
+
+        const char *const str = "[ not_app_extension_safe ]\n";
+        if (write_buffer_append_c_str(buffer, str)) {
             return 1;
         }
     }
@@ -304,20 +287,28 @@ int tbd_write_flags(FILE *const file, const uint64_t flags) {
 }
 
 static int
-write_yaml_string(FILE *const file,
+write_yaml_string(struct write_buffer *const buffer,
                   const char *const string,
                   const uint64_t length,
                   const bool needs_quotes)
 {
     if (needs_quotes) {
-        if (fprintf(file, "\"%s\"", string) < 0) {
+        if (write_buffer_append_char(buffer, '"')) {
+            return 1;
+        }
+
+        if (write_buffer_append(buffer, string, length)) {
+            return 1;
+        }
+
+        if (write_buffer_append_char(buffer, '"')) {
             return 1;
         }
 
         return 0;
     }
 
-    if (fwrite(string, length, 1, file) != 1) {
+    if (write_buffer_append(buffer, string, length)) {
         return 1;
     }
 
@@ -325,10 +316,10 @@ write_yaml_string(FILE *const file,
 }
 
 int
-tbd_write_install_name(FILE *const file,
+tbd_write_install_name(struct write_buffer *const buffer,
                        const struct tbd_create_info *const info)
 {
-    if (fprintf(file, "install-name:%-10s", "") < 0) {
+    if (write_padded_key(buffer, "install-name:", 23)) {
         return 1;
     }
 
@@ -338,11 +329,11 @@ tbd_write_install_name(FILE *const file,
     const bool needs_quotes =
         info->flags & F_TBD_CREATE_INFO_INSTALL_NAME_NEEDS_QUOTES;
 
-    if (write_yaml_string(file, install_name, length, needs_quotes)) {
+    if (write_yaml_string(buffer, install_name, length, needs_quotes)) {
         return 1;
     }
 
-    if (fputc('\n', file) < 0) {
+    if (write_buffer_append_char(buffer, '\n')) {
         return 1;
     }
 
@@ -350,71 +341,67 @@ tbd_write_install_name(FILE *const file,
 }
 
 int
-tbd_write_objc_constraint(FILE *const file,
+tbd_write_objc_constraint(struct write_buffer *const buffer,
                           const enum tbd_objc_constraint constraint)
 {
+    const char *str = NULL;
     switch (constraint) {
         case TBD_OBJC_CONSTRAINT_NONE:
-            if (fprintf(file, "objc-constraint:%-7snone\n", "") < 0) {
-                return 1;
-            }
-
+            str = "none\n";
             break;
 
         case TBD_OBJC_CONSTRAINT_GC:
-            if (fprintf(file, "objc-constraint:%-7sgc\n", "") < 0) {
-                return 1;
-            }
-
+            str = "gc\n";
             break;
 
         case TBD_OBJC_CONSTRAINT_RETAIN_RELEASE:
-            if (fprintf(file, "objc-constraint:%-7sretain_release\n", "") < 0) {
-                return 1;
-            }
-
+            str = "retain_release\n";
             break;
 
-        case TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_OR_GC: {
-            const char *const str = "retain_release_or_gc";
-            if (fprintf(file, "objc-constraint:%-7s%s\n", "", str) < 0) {
-                return 1;
-            }
+        case TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_OR_GC:
+            str = "retain_release_or_gc\n";
+            break;
 
+        case TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_FOR_SIMULATOR:
+            str = "retain_release_for_simulator\n";
             break;
-        }
 
-        case TBD_OBJC_CONSTRAINT_RETAIN_RELEASE_FOR_SIMULATOR: {
-            const char *const str = "retain_release_for_simulator";
-            if (fprintf(file, "objc-constraint:%-7s%s\n", "", str) < 0) {
-                return 1;
-            }
+        default:
+            return 0;
+    }
 
-            break;
-        }
+    if (write_padded_key(buffer, "objc-constraint:", 23)) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, str)) {
+        return 1;
     }
 
     return 0;
 }
 
-int tbd_write_magic(FILE *const file, const enum tbd_version version) {
+int
+tbd_write_magic(struct write_buffer *const buffer,
+                const enum tbd_version version)
+{
     switch (version) {
         case TBD_VERSION_V1:
-            if (fputs("---\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, "---\n")) {
                 return 1;
             }
 
             break;
 
         case TBD_VERSION_V2:
-            if (fputs("--- !tapi-tbd-v2\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, "--- !tapi-tbd-v2\n")) {
                 return 1;
             }
 
             break;
 
         case TBD_VERSION_V3:
-            if (fputs("--- !tapi-tbd-v3\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, "--- !tapi-tbd-v3\n")) {
                 return 1;
             }
 
@@ -425,7 +412,7 @@ int tbd_write_magic(FILE *const file, const enum tbd_version version) {
 }
 
 int
-tbd_write_parent_umbrella(FILE *const file,
+tbd_write_parent_umbrella(struct write_buffer *const buffer,
                           const struct tbd_create_info *const info)
 {
     const char *const umbrella = info->parent_umbrella;
@@ -433,7 +420,7 @@ tbd_write_parent_umbrella(FILE *const file,
         return 0;
     }
 
-    if (fprintf(file, "parent-umbrella:%-7s", "") < 0) {
+    if (write_padded_key(buffer, "parent-umbrella:", 23)) {
         return 1;
     }
 
@@ -441,56 +428,56 @@ tbd_write_parent_umbrella(FILE *const file,
     const bool needs_quotes =
         info->flags & F_TBD_CREATE_INFO_PARENT_UMBRELLA_NEEDS_QUOTES;
 
-    if (write_yaml_string(file, umbrella, length, needs_quotes)) {
+    if (write_yaml_string(buffer, umbrella, length, needs_quotes)) {
         return 1;
     }
 
-    if (fputc('\n', file) < 0) {
+    if (write_buffer_append_char(buffer, '\n')) {
         return 1;
     }
 
     return 0;
 }
 
-int tbd_write_platform(FILE *const file, const enum tbd_platform platform) {
+int
+tbd_write_platform(struct write_buffer *const buffer,
+                   const enum tbd_platform platform)
+{
+    const char *str = NULL;
     switch (platform) {
         case TBD_PLATFORM_MACOS:
-            if (fprintf(file, "platform:%-14smacosx\n", "") < 0) {
-                return 1;
-            }
-
+            str = "macosx\n";
             break;
 
         case TBD_PLATFORM_IOS:
-            if (fprintf(file, "platform:%-14sios\n", "") < 0) {
-                return 1;
-            }
-
+            str = "ios\n";
             break;
 
         case TBD_PLATFORM_WATCHOS:
-            if (fprintf(file, "platform:%-14swatchos\n", "") < 0) {
-                return 1;
-            }
-
+            str = "watchos\n";
             break;
 
         case TBD_PLATFORM_TVOS:
-            if (fprintf(file, "platform:%-14stvos\n", "") < 0) {
-                return 1;
-            }
-
+            str = "tvos\n";
             break;
 
         default:
             return E_TBD_CREATE_WRITE_FAIL;
     }
 
+    if (write_padded_key(buffer, "platform:", 23)) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, str)) {
+        return 1;
+    }
+
     return 0;
 }
 
 int
-tbd_write_swift_version(FILE *const file,
+tbd_write_swift_version(struct write_buffer *const buffer,
                         const enum tbd_version tbd_version,
                         const uint32_t swift_version)
 {
@@ -503,14 +490,14 @@ tbd_write_swift_version(FILE *const file,
             return 0;
 
         case TBD_VERSION_V2:
-            if (fprintf(file, "swift-version:%-9s", "") < 0) {
+            if (write_padded_key(buffer, "swift-version:", 23)) {
                 return 1;
             }
 
             break;
 
         case TBD_VERSION_V3:
-            if (fprintf(file, "swift-abi-version:%-5s", "") < 0) {
+            if (write_padded_key(buffer, "swift-abi-version:", 23)) {
                 return 1;
             }
 
@@ -519,21 +506,25 @@ tbd_write_swift_version(FILE *const file,
 
     switch (swift_version) {
         case 1:
-            if (fputs("1\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, "1\n")) {
                 return 1;
             }
 
             break;
 
         case 2:
-            if (fputs("1.2\n", file) < 0) {
+            if (write_buffer_append_c_str(buffer, "1.2\n")) {
                 return 1;
             }
 
             break;
 
         default:
-            if (fprintf(file, "%" PRIu32 "\n", swift_version - 1) < 0) {
+            if (write_buffer_append_uint32(buffer, swift_version - 1)) {
+                return 1;
+            }
+
+            if (write_buffer_append_char(buffer, '\n')) {
                 return 1;
             }
 
@@ -544,71 +535,66 @@ tbd_write_swift_version(FILE *const file,
 }
 
 static inline int
-write_uuid(FILE *const file,
+write_uuid(struct write_buffer *const buffer,
            const struct arch_info *const arch,
            const uint8_t *const uuid,
            const bool has_comma)
 {
-    int ret = 0;
     if (has_comma) {
-        ret =
-            fprintf(file,
-                    ", '%s: %.2X%.2X%.2X%.2X-%.2X%.2X-%.2X%.2X-%.2X%.2X-%.2X"
-                    "%.2X%.2X%.2X%.2X%.2X'",
-                    arch->name,
-                    uuid[0],
-                    uuid[1],
-                    uuid[2],
-                    uuid[3],
-                    uuid[4],
-                    uuid[5],
-                    uuid[6],
-                    uuid[7],
-                    uuid[8],
-                    uuid[9],
-                    uuid[10],
-                    uuid[11],
-                    uuid[12],
-                    uuid[13],
-                    uuid[14],
-                    uuid[15]);
-    } else {
-        ret =
-            fprintf(file,
-                    "'%s: %.2X%.2X%.2X%.2X-%.2X%.2X-%.2X%.2X-%.2X%.2X-%.2X%.2X"
-                    "%.2X%.2X%.2X%.2X'",
-                    arch->name,
-                    uuid[0],
-                    uuid[1],
-                    uuid[2],
-                    uuid[3],
-                    uuid[4],
-                    uuid[5],
-                    uuid[6],
-                    uuid[7],
-                    uuid[8],
-                    uuid[9],
-                    uuid[10],
-                    uuid[11],
-                    uuid[12],
-                    uuid[13],
-                    uuid[14],
-                    uuid[15]);
-    }
-
-    if (ret < 0) {
+        if (write_buffer_append_c_str(buffer, ", ")) {
+            return 1;
+        }
+    }
+
+    if (write_buffer_append_char(buffer, '\'')) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, arch->name)) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, ": ")) {
+        return 1;
+    }
+
+    /*
+     * Write out the uuid in the 8-4-4-4-12 format, placing a dash before the
+     * 4th, 6th, 8th, and 10th bytes.
+     */
+
+    for (uint8_t i = 0; i != 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            if (write_buffer_append_char(buffer, '-')) {
+                return 1;
+            }
+        }
+
+        if (write_buffer_append_hex_byte(buffer, uuid[i])) {
+            return 1;
+        }
+    }
+
+    if (write_buffer_append_char(buffer, '\'')) {
         return 1;
     }
 
     return 0;
 }
 
-int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
+int
+tbd_write_uuids(struct write_buffer *const buffer,
+                const struct array *const uuids)
+{
     if (array_is_empty(uuids)) {
         return 1;
     }
 
-    if (fprintf(file, "uuids:%-17s[ ", "") < 0) {
+    if (write_padded_key(buffer, "uuids:", 23)) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, "[ ")) {
         return 1;
     }
 
@@ -621,7 +607,7 @@ int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
     const struct tbd_uuid_info *uuid = uuids->data;
     const struct tbd_uuid_info *const end = uuids->data_end;
 
-    if (write_uuid(file, uuid->arch, uuid->uuid, false)) {
+    if (write_uuid(buffer, uuid->arch, uuid->uuid, false)) {
         return 1;
     }
 
@@ -640,7 +626,7 @@ int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
             break;
         }
 
-        if (write_uuid(file, uuid->arch, uuid->uuid, needs_comma)) {
+        if (write_uuid(buffer, uuid->arch, uuid->uuid, needs_comma)) {
             return 1;
         }
 
@@ -651,7 +637,11 @@ int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
 
         counter++;
         if (counter == 2) {
-            if (fprintf(file, ",%-26s", "\n") < 0) {
+            if (write_buffer_append_c_str(buffer, ",\n")) {
+                return 1;
+            }
+
+            if (write_buffer_append_spaces(buffer, 25)) {
                 return 1;
             }
 
@@ -662,7 +652,7 @@ int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
         }
     } while (true);
 
-    if (fputs(" ]\n", file) < 0) {
+    if (write_buffer_append_c_str(buffer, " ]\n")) {
         return 1;
     }
 
@@ -670,67 +660,58 @@ int tbd_write_uuids(FILE *const file, const struct array *const uuids) {
 }
 
 static int
-write_export_type_key(FILE *const file,
+write_export_type_key(struct write_buffer *const buffer,
                       const enum tbd_export_type type,
                       const enum tbd_version version)
 {
+    const char *key = NULL;
     switch (type) {
-        case TBD_EXPORT_TYPE_CLIENT: {
+        case TBD_EXPORT_TYPE_CLIENT:
             if (version == TBD_VERSION_V1) {
-                if (fprintf(file, "%-4sallowed-clients:%-4s[ ", "", "") < 0) {
-                    return 1;
-                }
+                key = "    allowed-clients:";
             } else {
-                if (fprintf(file, "%-4sallowable-clients:%-2s[ ", "", "") < 0) {
-                    return 1;
-                }
+                key = "    allowable-clients:";
             }
 
             break;
-        }
 
         case TBD_EXPORT_TYPE_REEXPORT:
-            if (fprintf(file, "%-4sre-exports:%9s[ ", "", "") < 0) {
-                return 1;
-            }
-
+            key = "    re-exports:";
             break;
 
         case TBD_EXPORT_TYPE_NORMAL_SYMBOL:
-            if (fprintf(file, "%-4ssymbols:%12s[ ", "", "") < 0) {
-                return 1;
-            }
-
+            key = "    symbols:";
             break;
 
         case TBD_EXPORT_TYPE_OBJC_CLASS_SYMBOL:
-            if (fprintf(file, "%-4sobjc-classes:%7s[ ", "", "") < 0) {
-                return 1;
-            }
-
+            key = "    objc-classes:";
             break;
 
         case TBD_EXPORT_TYPE_OBJC_IVAR_SYMBOL:
-            if (fprintf(file, "%-4sobjc-ivars:%9s[ ", "", "") < 0) {
-                return 1;
-            }
-
+            key = "    objc-ivars:";
             break;
 
         case TBD_EXPORT_TYPE_WEAK_DEF_SYMBOL:
-            if (fprintf(file, "%-4sweak-def-symbols:%3s[ ", "", "") < 0) {
-                return 1;
-            }
-
+            key = "    weak-def-symbols:";
             break;
+
+        default:
+            return 0;
+    }
+
+    if (write_padded_key(buffer, key, 24)) {
+        return 1;
+    }
+
+    if (write_buffer_append_c_str(buffer, "[ ")) {
+        return 1;
     }
 
     return 0;
 }
 
-static inline int end_written_export_array(FILE *const file) {
-    const char *const end = " ]\n";
-    if (fwrite(end, 3, 1, file) != 1) {
+static inline int end_written_export_array(struct write_buffer *const buffer) {
+    if (write_buffer_append_c_str(buffer, " ]\n")) {
         return 1;
     }
 
@@ -757,8 +738,20 @@ enum write_comma_result {
     E_WRITE_COMMA_RESET_LINE_LENGTH,
 };
 
+static int write_comma_and_newline(struct write_buffer *const buffer) {
+    if (write_buffer_append_c_str(buffer, ",\n")) {
+        return 1;
+    }
+
+    if (write_buffer_append_spaces(buffer, 26)) {
+        return 1;
+    }
+
+    return 0;
+}
+
 static enum write_comma_result
-write_comma_or_newline(FILE *const file,
+write_comma_or_newline(struct write_buffer *const buffer,
                        const uint32_t line_length,
                        const uint32_t string_length)
 {
@@ -769,7 +762,7 @@ write_comma_or_newline(FILE *const file,
 
     if (string_length >= line_length_max) {
         if (line_length != 0) {
-            if (fprintf(file, ",\n%-26s", "") < 0) {
+            if (write_comma_and_newline(buffer)) {
                 return E_WRITE_COMMA_WRITE_FAIL;
             }
         }
@@ -785,7 +778,7 @@ write_comma_or_newline(FILE *const file,
 
     const uint64_t new_line_length = line_length + string_length + 2;
     if (new_line_length > line_length_max) {
-        if (fprintf(file, ",\n%-26s", "") < 0) {
+        if (write_comma_and_newline(buffer)) {
             return E_WRITE_COMMA_WRITE_FAIL;
         }
 
@@ -797,8 +790,7 @@ write_comma_or_newline(FILE *const file,
      * before writing the next symbol.
      */
 
-    const char *const comma_space = ", ";
-    if (fwrite(comma_space, 2, 1, file) != 1) {
+    if (write_buffer_append_c_str(buffer, ", ")) {
         return E_WRITE_COMMA_WRITE_FAIL;
     }
 
@@ -806,17 +798,17 @@ write_comma_or_newline(FILE *const file,
 }
 
 static inline int
-write_export_info(FILE *const file,
+write_export_info(struct write_buffer *const buffer,
                   const struct tbd_export_info *const info)
 {
     const bool needs_quotes =
         info->flags & F_TBD_EXPORT_INFO_STRING_NEEDS_QUOTES;
 
-    return write_yaml_string(file, info->string, info->length, needs_quotes);
+    return write_yaml_string(buffer, info->string, info->length, needs_quotes);
 }
 
 int
-tbd_write_exports(FILE *const file,
+tbd_write_exports(struct write_buffer *const buffer,
                   const struct array *const exports,
                   const enum tbd_version version)
 {
@@ -827,7 +819,7 @@ tbd_write_exports(FILE *const file,
         return 0;
     }
 
-    if (fputs("exports:\n", file) < 0) {
+    if (write_buffer_append_c_str(buffer, "exports:\n")) {
         return 1;
     }
 
@@ -840,16 +832,16 @@ tbd_write_exports(FILE *const file,
 
     do {
         const uint64_t archs = info->archs;
-        if (write_archs_for_exports(file, archs)) {
+        if (write_archs_for_exports(buffer, archs)) {
             return 1;
         }
 
         enum tbd_export_type type = info->type;
-        if (write_export_type_key(file, type, version)) {
+        if (write_export_type_key(buffer, type, version)) {
             return 1;
         }
 
-        if (write_export_info(file, info)) {
+        if (write_export_info(buffer, info)) {
             return 1;
         }
 
@@ -869,7 +861,7 @@ tbd_write_exports(FILE *const file,
              */
 
             if (info == end) {
-                if (end_written_export_array(file)) {
+                if (end_written_export_array(buffer)) {
                     return 1;
                 }
 
@@ -883,7 +875,7 @@ tbd_write_exports(FILE *const file,
 
             const uint64_t inner_archs = info->archs;
             if (inner_archs != archs) {
-                if (end_written_export_array(file)) {
+                if (end_written_export_array(buffer)) {
                     return 1;
                 }
 
@@ -898,15 +890,15 @@ tbd_write_exports(FILE *const file,
 
             const enum tbd_export_type inner_type = info->type;
             if (inner_type != type) {
-                if (end_written_export_array(file)) {
+                if (end_written_export_array(buffer)) {
                     return 1;
                 }
 
-                if (write_export_type_key(file, inner_type, version)) {
+                if (write_export_type_key(buffer, inner_type, version)) {
                     return 1;
                 }
 
-                if (write_export_info(file, info)) {
+                if (write_export_info(buffer, info)) {
                     return 1;
                 }
 
@@ -928,7 +920,7 @@ tbd_write_exports(FILE *const file,
 
             const uint32_t length = info->length;
             const enum write_comma_result write_comma_result =
-                write_comma_or_newline(file, line_length, length);
+                write_comma_or_newline(buffer, line_length, length);
 
             switch (write_comma_result) {
                 case E_WRITE_COMMA_OK:
@@ -942,7 +934,7 @@ tbd_write_exports(FILE *const file,
                     break;
             }
 
-            if (write_export_info(file, info)) {
+            if (write_export_info(buffer, info)) {
                 return 1;
             }
 
@@ -30,6 +30,9 @@ void print_usage(void) {
     fputs("                       dyld_shared_cache files should be parsed, and not any mach-o files\n", stdout);
     fputs("        --include-dsc, Specify that while recursing, dyld_shared_cache files should be parsed\n", stdout);
     fputs("                       in addition, to mach-o files\n", stdout);
+    fputs("        --dsc-merge,   Specify a dyld_shared_cache file (of another architecture) whose images\n", stdout);
+    fputs("                       are merged into the images of the same path in the provided\n", stdout);
+    fputs("                       dyld_shared_cache file, creating tbds with every architecture\n", stdout);
 
     fputc('\n', stdout);
     fputs("Outputting options:\n", stdout);
@@ -49,6 +52,17 @@ void print_usage(void) {
     fputs("                                      To get the numbers of all available images, Use the option --list-images\n", stdout);
     fputs("            --image-path,             Specify the path of an image to parse out.\n", stdout);
     fputs("                                      To get the paths of all available images, Use the option --list-images\n", stdout);
+    fputs("            --cache-dir,              Specify a directory to cache parsed files in, to skip re-parsing\n", stdout);
+    fputs("                                      unchanged files (and dyld_shared_caches) on later runs\n", stdout);
+    fputs("            --dsc-access,             Specify how dyld_shared_cache files are read (normal, random, or sequential)\n", stdout);
+    fputs("            --dsc-huge-pages,         Request huge pages when mapping dyld_shared_cache files, where supported\n", stdout);
+    fputs("            --dsc-populate,           Read in dyld_shared_cache files entirely when mapping them, where supported\n", stdout);
+    fputs("            --dsc-prefetch,           Read in the __LINKEDIT of dyld_shared_cache files ahead of time, and every\n", stdout);
+    fputs("                                      image's load-commands ahead of it being parsed\n", stdout);
+    fputs("            --only-archs,             Specify the architecture(s) to parse out of mach-o files and dyld_shared_caches.\n", stdout);
+    fputs("                                      All other architectures are skipped without being read\n", stdout);
+    fputs("        -j, --jobs,                   Specify the number of files (or dyld_shared_cache images) to parse at once\n", stdout);
+    fputs("                                      The slices of a fat mach-o are also parsed at once, unless recursing\n", stdout);
     fputs("        -v, --version,                Specify version of tbd to convert to (default is v2).\n", stdout);
     fputs("                                      This applies to all files where tbd-version was not explicitly set\n", stdout);
 
@@ -98,7 +112,9 @@ void print_usage(void) {
     fputs("List options:\n", stdout);
     fputs("        --list-architectures,    List all valid architectures for tbd files.\n", stdout);
     fputs("                                 Also able to list architectures of the mach-o file from a provided path\n", stdout);
-    fputs("        --list-dsc-images,       List all images of a dyld_shared_cache from a provided path\n", stdout);
+    fputs("        --list-dsc-images,       List all images of a dyld_shared_cache from a provided path.\n", stdout);
+    fputs("                                 With --machine-readable, a tab-separated line is printed for every image,\n", stdout);
+    fputs("                                 with its number, address, modification-time, inode and path\n", stdout);
     fputs("        --list-objc-constraints, List all valid objc-constraint options for tbd files\n", stdout);
     fputs("        --list-platform,         List all valid platforms\n", stdout);
     fputs("        --list-recurse,          List all valid recurse options for parsing directories\n", stdout);
@@ -0,0 +1,123 @@
+//
+//  src/worker_pool.c
+//  tbd
+//
+//  Created by inoahdev on 03/02/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "worker_pool.h"
+
+static pthread_mutex_t output_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+struct worker_pool_info {
+    void *info;
+    worker_pool_callback callback;
+
+    uint64_t items_count;
+    uint64_t next_index;
+};
+
+struct worker_info {
+    struct worker_pool_info *pool;
+    uint32_t worker;
+};
+
+static void *worker_main(void *const item) {
+    const struct worker_info *const worker_info =
+        (const struct worker_info *)item;
+
+    struct worker_pool_info *const pool = worker_info->pool;
+
+    const uint32_t worker = worker_info->worker;
+    const uint64_t items_count = pool->items_count;
+
+    do {
+        const uint64_t index =
+            __atomic_fetch_add(&pool->next_index, 1, __ATOMIC_RELAXED);
+
+        if (index >= items_count) {
+            break;
+        }
+
+        pool->callback(index, worker, pool->info);
+    } while (true);
+
+    return NULL;
+}
+
+void
+worker_pool_run(const uint32_t workers_count,
+                const uint64_t items_count,
+                void *const info,
+                const worker_pool_callback callback)
+{
+    struct worker_pool_info pool = {
+        .info = info,
+        .callback = callback,
+        .items_count = items_count
+    };
+
+    /*
+     * Don't create more threads than there are items to hand out.
+     */
+
+    uint64_t count = workers_count;
+    if (count > items_count) {
+        count = items_count;
+    }
+
+    struct worker_info main_worker = {
+        .pool = &pool,
+        .worker = 0
+    };
+
+    if (count < 2) {
+        worker_main(&main_worker);
+        return;
+    }
+
+    pthread_t *const threads = calloc(count, sizeof(pthread_t));
+    struct worker_info *const workers = calloc(count, sizeof(*workers));
+
+    if (threads == NULL || workers == NULL) {
+        free(threads);
+        free(workers);
+
+        worker_main(&main_worker);
+        return;
+    }
+
+    uint32_t created = 1;
+    for (; created != count; created++) {
+        struct worker_info *const worker_info = workers + created;
+
+        worker_info->pool = &pool;
+        worker_info->worker = created;
+
+        if (pthread_create(threads + created, NULL, worker_main, worker_info)) {
+            break;
+        }
+    }
+
+    worker_main(&main_worker);
+
+    for (uint32_t i = 1; i != created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(workers);
+}
+
+void worker_pool_lock_output(void) {
+    pthread_mutex_lock(&output_mutex);
+}
+
+void worker_pool_unlock_output(void) {
+    pthread_mutex_unlock(&output_mutex);
+}
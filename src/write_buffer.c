@@ -0,0 +1,166 @@
+//
+//  src/write_buffer.c
+//  tbd
+//
+//  Created by inoahdev on 03/10/19.
+//  Copyright © 2019 inoahdev. All rights reserved.
+//
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "write_buffer.h"
+
+static int
+expand_if_necessary(struct write_buffer *const buffer, const uint64_t add_size) {
+    char *const old_data = buffer->data;
+
+    const uint64_t used_size = (uint64_t)(buffer->data_end - old_data);
+    const uint64_t old_capacity = (uint64_t)(buffer->alloc_end - old_data);
+    const uint64_t wanted_capacity = used_size + add_size;
+
+    if (wanted_capacity <= old_capacity) {
+        return 0;
+    }
+
+    /*
+     * Most tbds are at least a few kilobytes, so start off with a page-sized
+     * buffer to avoid several small reallocations.
+     */
+
+    uint64_t new_capacity = (old_capacity != 0) ? old_capacity * 2 : 4096;
+    while (new_capacity < wanted_capacity) {
+        new_capacity *= 2;
+    }
+
+    char *const new_data = realloc(old_data, new_capacity);
+    if (new_data == NULL) {
+        return 1;
+    }
+
+    buffer->data = new_data;
+    buffer->data_end = new_data + used_size;
+    buffer->alloc_end = new_data + new_capacity;
+
+    return 0;
+}
+
+int
+write_buffer_append(struct write_buffer *const buffer,
+                    const char *const data,
+                    const uint64_t length)
+{
+    if (length == 0) {
+        return 0;
+    }
+
+    if (expand_if_necessary(buffer, length)) {
+        return 1;
+    }
+
+    memcpy(buffer->data_end, data, length);
+    buffer->data_end += length;
+
+    return 0;
+}
+
+int write_buffer_append_char(struct write_buffer *const buffer, const char ch) {
+    if (expand_if_necessary(buffer, 1)) {
+        return 1;
+    }
+
+    *buffer->data_end = ch;
+    buffer->data_end += 1;
+
+    return 0;
+}
+
+int
+write_buffer_append_spaces(struct write_buffer *const buffer,
+                           const uint64_t count)
+{
+    if (expand_if_necessary(buffer, count)) {
+        return 1;
+    }
+
+    memset(buffer->data_end, ' ', count);
+    buffer->data_end += count;
+
+    return 0;
+}
+
+int
+write_buffer_append_uint32(struct write_buffer *const buffer,
+                           const uint32_t number)
+{
+    /*
+     * Write the digits backwards into a local buffer large enough for
+     * UINT32_MAX.
+     */
+
+    char digits[10];
+    char *iter = digits + sizeof(digits);
+
+    uint32_t value = number;
+    do {
+        iter--;
+        *iter = (char)('0' + (value % 10));
+
+        value /= 10;
+    } while (value != 0);
+
+    const uint64_t length = (uint64_t)(digits + sizeof(digits) - iter);
+    return write_buffer_append(buffer, iter, length);
+}
+
+int
+write_buffer_append_hex_byte(struct write_buffer *const buffer,
+                             const uint8_t byte)
+{
+    if (expand_if_necessary(buffer, 2)) {
+        return 1;
+    }
+
+    const char *const hex = "0123456789ABCDEF";
+    char *const data_end = buffer->data_end;
+
+    data_end[0] = hex[byte >> 4];
+    data_end[1] = hex[byte & 0xf];
+
+    buffer->data_end = data_end + 2;
+    return 0;
+}
+
+int
+write_buffer_write_to_fd(const struct write_buffer *const buffer, const int fd) {
+    const char *iter = buffer->data;
+    const char *const end = buffer->data_end;
+
+    while (iter != end) {
+        const ssize_t written = write(fd, iter, (size_t)(end - iter));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return 1;
+        }
+
+        iter += written;
+    }
+
+    return 0;
+}
+
+void write_buffer_clear(struct write_buffer *const buffer) {
+    buffer->data_end = buffer->data;
+}
+
+void write_buffer_destroy(struct write_buffer *const buffer) {
+    free(buffer->data);
+
+    buffer->data = NULL;
+    buffer->data_end = NULL;
+    buffer->alloc_end = NULL;
+}
@@ -9,6 +9,10 @@
 #include <ctype.h>
 #include <stdbool.h>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include "yaml.h"
 
 static inline bool char_needs_quotes(const char ch) {
@@ -52,3 +56,199 @@ bool yaml_check_c_str(const char *const string, const uint64_t length) {
 
     return false;
 }
+
+static uint64_t
+scan_c_str_scalar(const char *const string,
+                  uint64_t index,
+                  const uint64_t max_length,
+                  bool *const needs_quotes_in)
+{
+    bool needs_quotes = *needs_quotes_in;
+    for (; index != max_length; index++) {
+        const char ch = string[index];
+        if (ch == '\0') {
+            break;
+        }
+
+        if (char_needs_quotes(ch)) {
+            needs_quotes = true;
+        }
+    }
+
+    *needs_quotes_in = needs_quotes;
+    return index;
+}
+
+#if defined(__x86_64__)
+
+/*
+ * Return a mask with the bytes of chunk that are one of the characters in
+ * char_needs_quotes() set to 0xff.
+ */
+
+static inline __m128i sse2_needs_quotes_mask(const __m128i chunk) {
+    __m128i mask = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(':'));
+
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('{')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('}')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('[')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(']')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('*')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('#')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('?')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('|')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('-')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('=')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('!')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('%')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('@')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('`')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+
+    return mask;
+}
+
+static uint64_t
+scan_c_str_sse2(const char *const string,
+                const uint64_t max_length,
+                bool *const needs_quotes_out)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    bool needs_quotes = false;
+    uint64_t index = 0;
+
+    for (; max_length - index >= 16; index += 16) {
+        const __m128i chunk =
+            _mm_loadu_si128((const __m128i *)(string + index));
+
+        const uint32_t zero_bits =
+            (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+
+        uint32_t quote_bits =
+            (uint32_t)_mm_movemask_epi8(sse2_needs_quotes_mask(chunk));
+
+        if (zero_bits != 0) {
+            /*
+             * Only count the characters before the null-terminator.
+             */
+
+            const uint32_t zero_index = (uint32_t)__builtin_ctz(zero_bits);
+            quote_bits &= (1u << zero_index) - 1;
+
+            *needs_quotes_out = needs_quotes || quote_bits != 0;
+            return index + zero_index;
+        }
+
+        if (quote_bits != 0) {
+            needs_quotes = true;
+        }
+    }
+
+    index = scan_c_str_scalar(string, index, max_length, &needs_quotes);
+    *needs_quotes_out = needs_quotes;
+
+    return index;
+}
+
+/*
+ * For AVX2, the characters in char_needs_quotes() are found by looking up each
+ * byte's high and low nibbles in two tables, where a character needs quotes if
+ * the bits from both tables intersect.
+ *
+ * Each bit represents a group of characters with the same high-nibble(s):
+ *     0x01 -> 0x2_: ' ', '!', '#', '%', '&', '*', ',', '-'
+ *     0x02 -> 0x3_: ':', '<', '=', '>', '?'
+ *     0x04 -> 0x4_, 0x6_: '@', '`'
+ *     0x08 -> 0x5_: '[', ']'
+ *     0x10 -> 0x7_: '{', '|', '}'
+ */
+
+__attribute__((target("avx2")))
+static uint64_t
+scan_c_str_avx2(const char *const string,
+                const uint64_t max_length,
+                bool *const needs_quotes_out)
+{
+    const __m256i high_nibble_table =
+        _mm256_setr_epi8(0, 0, 0x01, 0x02, 0x04, 0x08, 0x04, 0x10,
+                         0, 0, 0, 0, 0, 0, 0, 0,
+                         0, 0, 0x01, 0x02, 0x04, 0x08, 0x04, 0x10,
+                         0, 0, 0, 0, 0, 0, 0, 0);
+
+    const __m256i low_nibble_table =
+        _mm256_setr_epi8(0x05, 0x01, 0, 0x01, 0, 0x01, 0x01, 0,
+                         0, 0, 0x03, 0x18, 0x13, 0x1b, 0x02, 0x02,
+                         0x05, 0x01, 0, 0x01, 0, 0x01, 0x01, 0,
+                         0, 0, 0x03, 0x18, 0x13, 0x1b, 0x02, 0x02);
+
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+
+    bool needs_quotes = false;
+    uint64_t index = 0;
+
+    for (; max_length - index >= 32; index += 32) {
+        const __m256i chunk =
+            _mm256_loadu_si256((const __m256i *)(string + index));
+
+        const __m256i high_nibbles =
+            _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble_mask);
+
+        const __m256i low_nibbles = _mm256_and_si256(chunk, nibble_mask);
+        const __m256i groups =
+            _mm256_and_si256(
+                _mm256_shuffle_epi8(high_nibble_table, high_nibbles),
+                _mm256_shuffle_epi8(low_nibble_table, low_nibbles));
+
+        const uint32_t zero_bits =
+            (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero));
+
+        uint32_t quote_bits =
+            ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(groups, zero));
+
+        if (zero_bits != 0) {
+            const uint32_t zero_index = (uint32_t)__builtin_ctz(zero_bits);
+            quote_bits &= (uint32_t)((1ull << zero_index) - 1);
+
+            *needs_quotes_out = needs_quotes || quote_bits != 0;
+            return index + zero_index;
+        }
+
+        if (quote_bits != 0) {
+            needs_quotes = true;
+        }
+    }
+
+    index = scan_c_str_scalar(string, index, max_length, &needs_quotes);
+    *needs_quotes_out = needs_quotes;
+
+    return index;
+}
+
+#endif
+
+uint64_t
+yaml_scan_c_str(const char *const string,
+                const uint64_t max_length,
+                bool *const needs_quotes_out)
+{
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        return scan_c_str_avx2(string, max_length, needs_quotes_out);
+    }
+
+    return scan_c_str_sse2(string, max_length, needs_quotes_out);
+#else
+    bool needs_quotes = false;
+    const uint64_t length =
+        scan_c_str_scalar(string, 0, max_length, &needs_quotes);
+
+    *needs_quotes_out = needs_quotes;
+    return length;
+#endif
+}